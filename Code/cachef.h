@@ -0,0 +1,242 @@
+/*	Content-addressed cache of results on disk. The same networks are analysed again and
+	again, so the partition computed for a network is kept in a cache folder, under a key
+	made from the loaded graph (its size, number of edges and the fingerprint of its CSR
+	arrays, with the edge types) and from the options that change the order of the block
+	lists ('-reorder', '-dag', '-reduce'). A later run on the same network reads the lists
+	back instead of refining, so its outputs are identical to the ones of the first run.
+
+	Each entry is one binary file 'DIR/KEY.fcache' (KEY in 16 hexadecimal digits):
+
+		"FCCH", version, N, edges, key,
+		number of blocks of 'partition' and of 'null_partition',
+		each block as in the checkpoint files ('checkpointf.h'): index, size, nodes,
+		number of classified fibers, then for each one: fiber (numbering of
+		'BUILD_QUOTIENT'), fundamental number n (double), number of external regulators l
+		and the l regulators.
+
+	The fibers classified by a run are added to its entry, so the classification of a
+	fiber is also computed once. The entries are written to 'KEY.fcache.tmp' and renamed,
+	so a reader never sees half of one. The folder is bounded in size: after each write
+	the least recently used entries (by modification time, which is renewed on each hit)
+	are removed until the folder fits the budget.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef CACHEF_H
+#define CACHEF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <utime.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "checkpointf.h"
+#include "classifyf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+#define CACHE_MAGIC "FCCH"
+#define CACHE_VERSION 1
+#define CACHE_SUFFIX ".fcache"
+
+/*	Key of the results of 'graph' refined with the given options. */
+unsigned long long CACHE_KEY(Graph* graph, int reorder_mode, int dag_bool, int reduce_bool)
+{
+	unsigned long long key = GRAPH_FINGERPRINT(graph);
+	long long values[5] = {graph->size, graph->num_edges, reorder_mode, dag_bool, reduce_bool};
+	return FNV_BYTES(key, values, sizeof(values));
+}
+
+void CACHE_FILENAME(char* filename, char* dir, unsigned long long key)
+{
+	snprintf(filename, 512, "%s/%016llx%s", dir, key, CACHE_SUFFIX);
+}
+
+/*	Reads the entry of 'key' into 'partition' and 'null_partition'. The fibers classified
+	in the entry get their n and l in the lists and are marked in 'classified' (allocated
+	with one char per fiber). Returns zero on a miss, leaving the lists empty.	*/
+extern int CACHE_LOAD(char* dir, unsigned long long key, Graph* graph, PART** partition, PART** null_partition, char** classified)
+{
+	char filename[512];
+	char magic[4];
+	int header[3];
+	unsigned long long saved_key;
+	int nblocks, nnull, nclassified, k, f, j;
+	CACHE_FILENAME(filename, dir, key);
+	*classified = NULL;
+	FILE* IN = fopen(filename, "rb");
+	if(IN==NULL) return 0;
+	int status = (fread(magic, 1, 4, IN)==4 && memcmp(magic, CACHE_MAGIC, 4)==0);
+	status = status && fread(header, sizeof(int), 3, IN)==3 && fread(&saved_key, sizeof(unsigned long long), 1, IN)==1;
+	status = status && header[0]==CACHE_VERSION && header[1]==graph->size && header[2]==graph->num_edges && saved_key==key;
+	status = status && fread(&nblocks, sizeof(int), 1, IN)==1 && fread(&nnull, sizeof(int), 1, IN)==1;
+	status = status && READ_PARTITION(IN, graph->size, nblocks, partition) && READ_PARTITION(IN, graph->size, nnull, null_partition);
+	status = status && fread(&nclassified, sizeof(int), 1, IN)==1 && nclassified>=0 && nclassified<=nblocks+nnull;
+	if(status==1)
+	{
+		// Fiber 'f' of the numbering of 'BUILD_QUOTIENT'.
+		PART** fibers = (PART**)malloc((nblocks+nnull>0 ? nblocks+nnull : 1)*sizeof(PART*));
+		PART* current_part;
+		f = 0;
+		for(current_part=*partition; current_part!=NULL; current_part=current_part->next) fibers[f++] = current_part;
+		for(current_part=*null_partition; current_part!=NULL; current_part=current_part->next) fibers[f++] = current_part;
+		*classified = (char*)calloc((nblocks+nnull>0 ? nblocks+nnull : 1), sizeof(char));
+		for(k=0; status && k<nclassified; k++)
+		{
+			double n;
+			int l;
+			status = fread(&f, sizeof(int), 1, IN)==1 && f>=0 && f<nblocks+nnull && fread(&n, sizeof(double), 1, IN)==1;
+			status = status && fread(&l, sizeof(int), 1, IN)==1 && l>=0 && l<=graph->size;
+			if(status==0) break;
+			int* regulators = (int*)malloc((l>0 ? l : 1)*sizeof(int));
+			status = ((int)fread(regulators, sizeof(int), l, IN)==l);
+			if(status==1)
+			{
+				deleteList(&(fibers[f]->regulators));
+				// 'push_doublylist' puts each node at the head of the list.
+				for(j=l-1; j>=0; j--) push_doublylist(&(fibers[f]->regulators), regulators[j]);
+				fibers[f]->number_regulators = l;
+				fibers[f]->fundamental_number = n;
+				(*classified)[f] = 1;
+			}
+			free(regulators);
+		}
+		free(fibers);
+	}
+	fclose(IN);
+	if(status==0)
+	{
+		FreePartition(partition);
+		FreePartition(null_partition);
+		free(*classified);
+		*classified = NULL;
+		return 0;
+	}
+	// The entry was used: it becomes the most recently used one.
+	utime(filename, NULL);
+	return 1;
+}
+
+/*	Marks as done in 'classifier' the fibers read from the cache. */
+extern void CACHE_MARK_CLASSIFIED(CLASSIFIER* classifier, char* classified)
+{
+	int f;
+	if(classified==NULL) return;
+	for(f=0; f<classifier->size; f++) if(classified[f]) classifier->done[f] = 1;
+}
+
+/*	Number of fibers classified so far by 'classifier'. */
+extern int CACHE_CLASSIFIED(CLASSIFIER* classifier)
+{
+	int f, n = 0;
+	for(f=0; f<classifier->size; f++) n += classifier->done[f];
+	return n;
+}
+
+/*	Removes the least recently used entries of 'dir' until their total size is at most
+	'budget' bytes. The entry 'keep' is never removed.	*/
+extern void CACHE_EVICT(char* dir, long long budget, char* keep)
+{
+	struct dirent* entry;
+	struct stat info;
+	char filename[512];
+	int k, n = 0, capacity = 64;
+	long long total = 0;
+	DIR* folder = opendir(dir);
+	if(folder==NULL) return;
+	char** names = (char**)malloc(capacity*sizeof(char*));
+	long long* sizes = (long long*)malloc(capacity*sizeof(long long));
+	time_t* times = (time_t*)malloc(capacity*sizeof(time_t));
+	while((entry = readdir(folder))!=NULL)
+	{
+		int length = strlen(entry->d_name);
+		int suffix = strlen(CACHE_SUFFIX);
+		if(length<=suffix || strcmp(entry->d_name + length - suffix, CACHE_SUFFIX)!=0) continue;
+		snprintf(filename, 512, "%s/%s", dir, entry->d_name);
+		if(stat(filename, &info)!=0) continue;
+		if(n==capacity)
+		{
+			capacity *= 2;
+			names = (char**)realloc(names, capacity*sizeof(char*));
+			sizes = (long long*)realloc(sizes, capacity*sizeof(long long));
+			times = (time_t*)realloc(times, capacity*sizeof(time_t));
+		}
+		names[n] = (char*)malloc(strlen(filename)+1);
+		strcpy(names[n], filename);
+		sizes[n] = info.st_size;
+		times[n] = info.st_mtime;
+		total += info.st_size;
+		n++;
+	}
+	closedir(folder);
+	// Oldest first: one pass of selection for each removed entry.
+	while(total>budget)
+	{
+		int oldest = -1;
+		for(k=0; k<n; k++)
+			if(names[k]!=NULL && strcmp(names[k], keep)!=0 && (oldest<0 || times[k]<times[oldest])) oldest = k;
+		if(oldest<0) break;
+		if(unlink(names[oldest])==0) total -= sizes[oldest];
+		free(names[oldest]);
+		names[oldest] = NULL;
+	}
+	for(k=0; k<n; k++) free(names[k]);
+	free(names);
+	free(sizes);
+	free(times);
+}
+
+/*	Writes the entry of 'key': the lists of 'partition' and 'null_partition' and the fibers
+	already classified by 'classifier' (which may be NULL), then bounds the folder to
+	'budget' bytes. Returns zero on failure.	*/
+extern int CACHE_STORE(char* dir, unsigned long long key, Graph* graph, PART* partition, PART* null_partition, CLASSIFIER* classifier, long long budget)
+{
+	char filename[512];
+	char temp[600];
+	int f;
+	PART* current_part;
+	NODELIST* nodelist;
+	mkdir(dir, 0755);
+	CACHE_FILENAME(filename, dir, key);
+	snprintf(temp, sizeof(temp), "%s.tmpXXXXXX", filename);
+	int descriptor = mkstemp(temp);
+	if(descriptor<0) return 0;
+	fchmod(descriptor, 0644);
+	FILE* OUT = fdopen(descriptor, "wb");
+	if(OUT==NULL) { close(descriptor); unlink(temp); return 0; }
+	int nblocks = GetPartitionSize(partition);
+	int nnull = GetPartitionSize(null_partition);
+	fwrite(CACHE_MAGIC, 1, 4, OUT);
+	int header[3] = {CACHE_VERSION, graph->size, graph->num_edges};
+	fwrite(header, sizeof(int), 3, OUT);
+	fwrite(&key, sizeof(unsigned long long), 1, OUT);
+	fwrite(&nblocks, sizeof(int), 1, OUT);
+	fwrite(&nnull, sizeof(int), 1, OUT);
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next) WRITE_BLOCK(OUT, current_part->block);
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next) WRITE_BLOCK(OUT, current_part->block);
+	int nclassified = 0;
+	if(classifier!=NULL) nclassified = CACHE_CLASSIFIED(classifier);
+	fwrite(&nclassified, sizeof(int), 1, OUT);
+	for(f=0; classifier!=NULL && f<classifier->size; f++)
+	{
+		if(classifier->done[f]==0) continue;
+		PART* fiber = classifier->fibers[f];
+		fwrite(&f, sizeof(int), 1, OUT);
+		fwrite(&(fiber->fundamental_number), sizeof(double), 1, OUT);
+		fwrite(&(fiber->number_regulators), sizeof(int), 1, OUT);
+		for(nodelist=fiber->regulators; nodelist!=NULL; nodelist=nodelist->next) fwrite(&(nodelist->data), sizeof(int), 1, OUT);
+	}
+	int status = (fflush(OUT)==0);
+	if(fclose(OUT)!=0) status = 0;
+	if(status==1 && rename(temp, filename)!=0) status = 0;
+	if(status==0) { unlink(temp); return 0; }
+	CACHE_EVICT(dir, budget, filename);
+	return 1;
+}
+
+#endif
@@ -0,0 +1,252 @@
+#!/bin/sh
+# Checks run by 'make check'. Each network of ../Data is refined by a plain run of 'fiber',
+# whose fibers ('-quotient', ARG1nodefiber.dat) are the reference, and then with each of the
+# options listed in the loop below. The runs on the network in memory must find an input-tree
+# stable partition equal to the reference ('-reference', see 'verifyf.h'); the engines that
+# only write ARG1nodefiber.dat must give the same sets of nodes, whatever their numbering.
+# Last, the orbits of small random networks are compared with a brute force ('orbitcheck.c').
+# The outputs written to ../Data are removed at the end.
+
+cd "$(dirname "$0")" || exit 1
+NETWORKS="3FF ECOLI FF IMPORTANT_EXAMPLE RESULT1 RESULT2 RESULT3 scc_test_"
+TMP=$(mktemp -d) || exit 1
+failed=0
+
+# Fibers of a "%d\t%d\n" (Node ID/ Fiber) file, renumbered by their first node.
+canonical()
+{
+	sort -n "$1" | awk '{ if(!($2 in id)) id[$2] = n++; print $1, id[$2] }'
+}
+
+fail()
+{
+	echo "FAILED: $*"
+	failed=$((failed+1))
+}
+
+# check_reference NETWORK OPTIONS...: the run must be stable and equal to the reference.
+check_reference()
+{
+	net=$1
+	shift
+	output=$(./fiber "$net" -n "$@" -reference "$TMP/$net.reference")
+	echo "$output" | grep -q "is input-tree stable" && echo "$output" | grep -q "equal to the reference" || fail "$net $*"
+}
+
+# check_fibers NETWORK OPTIONS...: the fibers written to ARG1nodefiber.dat must be the reference ones.
+check_fibers()
+{
+	net=$1
+	shift
+	./fiber "$net" -n "$@" > /dev/null && canonical "../Data/${net}nodefiber.dat" | cmp -s - "$TMP/$net.canonical" || fail "$net $*"
+}
+
+# check_dynamics NETWORK: from a state constant inside each fiber (zero), the dynamics run on
+# the base graph and lifted to the nodes must follow the one of the full network.
+check_dynamics()
+{
+	./fiber "$1" -n -ode 100 -boolean 20 -compare | awk '/^ODE:/ { ode = ($NF < 1e-9) } /^Boolean:/ { boolean = ($2 == 0) }
+		END { exit !(ode && boolean) }' || fail "$1 -ode -boolean -compare"
+	rm -f "../Data/$1ode.dat" "../Data/$1boolean.dat"
+}
+
+# check_labels NETWORK: the same network given by labels ("n" and the node ID, '-labels') must
+# have the same fibers once the nodes are mapped back to their IDs by ARG1labels.dat. Node IDs
+# without edges are not in the labeled network, so they are left out of the comparison.
+check_labels()
+{
+	awk 'NF >= 3 { print "n" $1, "n" $2, $3 }' "../Data/$1edgelist.dat" > ../Data/CHECKLABELSedgelist.dat
+	if ./fiber CHECKLABELS -n -labels -quotient > /dev/null
+	then
+		awk 'FNR==NR { id[$1] = substr($2, 2); next } { print id[$1] "\t" $2 }' ../Data/CHECKLABELSlabels.dat \
+			../Data/CHECKLABELSnodefiber.dat > "$TMP/labels"
+		awk 'FNR==NR { seen[$1] = 1; next } ($1 in seen)' "$TMP/labels" "$TMP/$1.reference" > "$TMP/labels.reference"
+		canonical "$TMP/labels" > "$TMP/labels.canonical"
+		canonical "$TMP/labels.reference" | cmp -s - "$TMP/labels.canonical" || fail "$1 -labels"
+	else
+		fail "$1 -labels"
+	fi
+	rm -f ../Data/CHECKLABELS*
+}
+
+# check_python NETWORK: the Python module ('pyfiber.c', built here when python3 and setuptools
+# are available) must give the fibers of the reference, each solitaire node in its own fiber.
+check_python()
+{
+	if [ ! -d "$TMP/python" ]
+	then
+		mkdir "$TMP/python"
+		python3 setup.py -q build_ext --build-lib "$TMP/python" --build-temp "$TMP/python/build" > /dev/null 2>&1 ||
+			{ echo "Python module not built, not checked"; return; }
+	fi
+	[ -f "$TMP/python/fiberc"*.so ] || return
+	PYTHONPATH="$TMP/python" python3 - "../Data/$1edgelist.dat" > "$TMP/python.fibers" <<'PYTHON' || { fail "$1 python"; return; }
+import sys, array, fiberc
+TYPES = {'positive': 0, 'negative': 1, 'dual': 2}
+edges = array.array('i')
+types = array.array('i')
+for line in open(sys.argv[1]):
+	fields = line.split()
+	if len(fields) < 3: continue
+	edges.extend([int(fields[0]), int(fields[1])])
+	types.append(TYPES.get(fields[2], -1))
+result = fiberc.analyse(memoryview(edges).cast('B').cast('i', [len(edges)//2, 2]), types)
+solitaire = memoryview(result['solitaire'])
+for v, f in enumerate(memoryview(result['membership'])):
+	print('%d\t%s' % (v, 's%d' % v if solitaire[f] else f))
+PYTHON
+	canonical "$TMP/python.fibers" | cmp -s - "$TMP/$1.canonical" || fail "$1 python"
+}
+
+# check_fingerprint NETWORK: the fingerprints do not depend on the numbering of the fibers, so
+# a run with another ordering of the nodes must find every fiber of the plain run unchanged.
+check_fingerprint()
+{
+	./fiber "$1" -n -fingerprint > /dev/null && mv "../Data/$1fingerprint.dat" "$TMP/$1.fingerprint" &&
+		./fiber "$1" -n -reorder rcm -diff "$TMP/$1.fingerprint" |
+		grep -q "changed: 0, split: 0, merged: 0, regrouped: 0, removed: 0, added: 0" || fail "$1 -fingerprint -diff"
+	rm -f "../Data/$1fingerprint.dat" "../Data/$1diff.dat"
+}
+
+# check_verifier NETWORK: with all the nodes in one fiber as the reference, the verifier must
+# report the partition as finer than the reference.
+check_verifier()
+{
+	awk '{ print $1 "\t0" }' "$TMP/$1.reference" > "$TMP/$1.single"
+	./fiber "$1" -n -reference "$TMP/$1.single" | grep -q "finer than the reference" || fail "$1 -reference (one fiber)"
+}
+
+# check_classify NETWORK: classifying only the fibers with two nodes or more ('-min-size 2') must
+# give the same classes as classifying all of them, for those fibers.
+check_classify()
+{
+	./fiber "$1" -n -classify > /dev/null && awk '$2 >= 2' "../Data/$1classification.dat" > "$TMP/$1.classes" &&
+		./fiber "$1" -n -min-size 2 > /dev/null && cmp -s "../Data/$1classification.dat" "$TMP/$1.classes" || fail "$1 -min-size 2"
+	rm -f "../Data/$1classification.dat"
+}
+
+# check_server NETWORK: the server must refuse a SOCKET path that is not a socket, leaving the
+# file as it is, and unknown options. With python3, the server is also queried twice, the
+# second server replacing the socket left by the first one, and must count the reference fibers.
+check_server()
+{
+	cp "../Data/$1edgelist.dat" "$TMP/server.file"
+	./fiberserver "$TMP/server.file" "$1" -n > /dev/null && fail "fiberserver $1 on a regular file"
+	cmp -s "$TMP/server.file" "../Data/$1edgelist.dat" || fail "fiberserver $1 removed a regular file"
+	./fiberserver "$TMP/server.socket" "$1" -n -T 2 > /dev/null && fail "fiberserver $1 -T 2"
+	command -v python3 > /dev/null || return
+	fibers=$(cut -f2 "$TMP/$1.reference" | sort -u | wc -l)
+	for run in 1 2
+	do
+		./fiberserver "$TMP/server.socket" "$1" -n > "$TMP/server.log" &
+		server=$!
+		for wait in 1 2 3 4 5 6 7 8 9 10
+		do
+			grep -q Serving "$TMP/server.log" && break
+			sleep 0.2
+		done
+		reply=$(python3 -c "import socket, sys
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+s.sendall(b'STATS\n')
+print(s.makefile().readline().strip())" "$TMP/server.socket" 2> /dev/null)
+		[ "$(echo "$reply" | awk '{ print $1, $4 }')" = "OK $fibers" ] || fail "fiberserver $1 STATS (run $run)"
+		kill $server
+		wait $server 2> /dev/null
+	done
+}
+
+# check_batch NETWORKS...: one batch of the networks, a missing file and an empty one. The
+# networks must have the fibers of the reference, the two files must fail to load, and so
+# must the batch as a whole.
+check_batch()
+{
+	: > "$TMP/batch.empty"
+	for net in "$@"
+	do
+		echo "file ../Data/${net}edgelist.dat"
+	done > "$TMP/batch.manifest"
+	echo "file $TMP/batch.missing" >> "$TMP/batch.manifest"
+	echo "file $TMP/batch.empty" >> "$TMP/batch.manifest"
+	./fiberbatch "$TMP/batch.manifest" "$TMP/batch.tsv" -t 2 > /dev/null && fail "fiberbatch (exit status)"
+	for net in "$@"
+	do
+		fibers=$(cut -f2 "$TMP/$net.reference" | sort -u | wc -l)
+		awk -F '\t' -v source="../Data/${net}edgelist.dat" -v fibers="$fibers" '$2 == source && $6 == fibers && $12 == "ok" { found = 1 }
+			END { exit !found }' "$TMP/batch.tsv" || fail "fiberbatch $net"
+	done
+	[ "$(awk -F '\t' '$12 == "load: file can not be read"' "$TMP/batch.tsv" | wc -l)" -eq 2 ] || fail "fiberbatch (files not loaded)"
+}
+
+# check_ensemble NETWORK: a small ensemble must observe the nontrivial fibers of the reference,
+# and fail on a network that does not exist or on an unknown option.
+check_ensemble()
+{
+	nontrivial=$(cut -f2 "$TMP/$1.reference" | sort | uniq -c | awk '$1 > 1' | wc -l)
+	./fiberensemble "$1" -n 3 "$TMP/ensemble.tsv" -t 2 > /dev/null &&
+		awk -F '\t' -v n="$nontrivial" '$1 == "nontrivial" && $4 == n { found = 1 } END { exit !found }' "$TMP/ensemble.tsv" ||
+		fail "fiberensemble $1"
+	./fiberensemble "CHECK$1" -n 3 "$TMP/ensemble.tsv" > /dev/null && fail "fiberensemble CHECK$1 (no such network)"
+	./fiberensemble "$1" -n 3 "$TMP/ensemble.tsv" -seeds 5 > /dev/null && fail "fiberensemble $1 -seeds 5"
+}
+
+# check_rejected NETWORK OPTIONS...: the engine of OPTIONS must refuse '-labels' and an edgelist
+# without edges, and write no fibers for them.
+check_rejected()
+{
+	net=$1
+	shift
+	./fiber "$net" -n "$@" -labels > /dev/null && fail "$net $* -labels"
+	: > ../Data/CHECKEMPTYedgelist.dat
+	./fiber CHECKEMPTY -n "$@" > /dev/null && fail "$* (no edges)"
+	[ -f ../Data/CHECKEMPTYnodefiber.dat ] && fail "$* (fibers written without edges)"
+	rm -f ../Data/CHECKEMPTY*
+}
+
+for net in $NETWORKS
+do
+	if ! ./fiber "$net" -n -quotient > /dev/null
+	then
+		fail "$net (plain run)"
+		continue
+	fi
+	cp "../Data/${net}nodefiber.dat" "$TMP/$net.reference"
+	canonical "$TMP/$net.reference" > "$TMP/$net.canonical"
+
+	check_reference "$net"
+	check_reference "$net" -t 2
+	check_reference "$net" -dag
+	check_reference "$net" -reduce
+	check_reference "$net" -dag -reduce -t 2
+	check_dynamics "$net"
+	check_labels "$net"
+	check_reference "$net" -reorder degree
+	check_reference "$net" -reorder rcm
+	check_reference "$net" -reorder component
+	check_python "$net"
+	check_fibers "$net" -external 1
+	check_fibers "$net" -distributed 3
+	check_fibers "$net" -distributed 3 -transport socket
+	check_reference "$net" -checkpoint "$TMP/$net.checkpoint" 0.001
+	check_fingerprint "$net"
+	check_verifier "$net"
+	check_classify "$net"
+	check_reference "$net" -history
+	rm -f "../Data/${net}history.dat"
+	check_reference "$net" -cache "$TMP/cache"
+	check_reference "$net" -cache "$TMP/cache"
+	./fiber "$net" -n -cache "$TMP/cache" | grep -q "read from the cache" || fail "$net -cache (not read back)"
+	check_server "$net"
+	rm -f "../Data/${net}nodefiber.dat" "../Data/${net}quotient.dat" "../Data/${net}quotient.bin"
+done
+check_rejected ECOLI -external 1
+check_rejected ECOLI -distributed 3
+check_rejected ECOLI -distributed 3 -transport socket
+check_batch $NETWORKS
+check_ensemble ECOLI
+echo "Engines on the networks of ../Data: $failed checks failed"
+
+./orbitcheck 200 || failed=$((failed+1))
+
+rm -rf "$TMP"
+[ $failed -eq 0 ]
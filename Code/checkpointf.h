@@ -0,0 +1,229 @@
+/*	Checkpoint and resume for the refinement loop of 'REFINEMENT'. Every 'interval'
+	seconds the state of the loop is written to a binary checkpoint file:
+
+		"FCKP", version, N, edges, fingerprint of the graph, splitters processed,
+		number of blocks of 'partition', of 'null_partition' and of the queue,
+		then each block of 'partition', of 'null_partition' and of the queue, in their
+		order, as: index, size, nodes (in the order of the block list).
+
+	The file is written by a child process ('fork'), which sees a copy-on-write image of
+	the partition and the queue at that moment, so the refinement only stops for the
+	fork itself. The child writes to 'FILE.tmp' and renames it to 'FILE' when complete,
+	so an interrupted write never replaces a valid checkpoint. A new checkpoint is only
+	started after the previous one is finished.
+
+	When the checkpoint file exists and was written for the same graph (same number of
+	nodes and edges and the same fingerprint of the CSR arrays), the refinement resumes
+	from it, rebuilding the lists in the same order, so the result is identical to the
+	one of an uninterrupted run. The file is removed when the refinement ends.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef CHECKPOINTF_H
+#define CHECKPOINTF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "fibrationf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "clockf.h"
+
+#define CHECKPOINT_MAGIC "FCKP"
+#define CHECKPOINT_VERSION 1
+
+/*	Fingerprint of the graph (FNV-1a over its size and CSR arrays). */
+unsigned long long GRAPH_FINGERPRINT(Graph* graph)
+{
+	int v, j;
+	unsigned long long hash = FNV_OFFSET;
+	int N = graph->size;
+	int values[3];
+	for(v=0; v<N; v++)
+	{
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+		{
+			values[0] = v;
+			values[1] = graph->in_adj[j];
+			values[2] = graph->in_type[j];
+			hash = FNV_BYTES(hash, values, sizeof(values));
+		}
+	}
+	return hash;
+}
+
+void WRITE_BLOCK(FILE* OUT, BLOCK* block)
+{
+	NODELIST* nodelist;
+	fwrite(&(block->index), sizeof(int), 1, OUT);
+	fwrite(&(block->size), sizeof(int), 1, OUT);
+	for(nodelist=block->head; nodelist!=NULL; nodelist=nodelist->next)
+		fwrite(&(nodelist->data), sizeof(int), 1, OUT);
+}
+
+/*	Reads one block, keeping the order of its nodes. Returns NULL on a truncated file. */
+BLOCK* READ_BLOCK(FILE* IN, int N)
+{
+	int k, index, size;
+	if(fread(&index, sizeof(int), 1, IN)!=1 || fread(&size, sizeof(int), 1, IN)!=1 || size<0 || size>N) return NULL;
+	int* nodes = (int*)malloc((size>0 ? size : 1)*sizeof(int));
+	if((int)fread(nodes, sizeof(int), size, IN)!=size) { free(nodes); return NULL; }
+	BLOCK* block = (BLOCK*)malloc(sizeof(BLOCK));
+	block->index = index;
+	block->size = size;
+	block->pos = 0;
+	block->neg = 0;
+	block->dual = 0;
+	block->head = NULL;
+	for(k=size-1; k>=0; k--) push_doublylist(&(block->head), nodes[k]);
+	free(nodes);
+	return block;
+}
+
+/*	Writes the state of the loop to 'filename' (through 'filename.tmp'). Returns zero
+	on failure.	*/
+int SAVE_CHECKPOINT(char* filename, Graph* graph, unsigned long long fingerprint, long long steps, PART* partition, PART* null_partition, QBLOCK* qhead)
+{
+	char temp[512];
+	snprintf(temp, 512, "%s.tmp", filename);
+	FILE* OUT = fopen(temp, "wb");
+	if(OUT==NULL) return 0;
+	PART* current_part;
+	QBLOCK* queued;
+	int nblocks = GetPartitionSize(partition);
+	int nnull = GetPartitionSize(null_partition);
+	long long nqueue = 0;
+	for(queued=qhead; queued!=NULL; queued=queued->next) nqueue++;
+
+	fwrite(CHECKPOINT_MAGIC, 1, 4, OUT);
+	int header[3] = {CHECKPOINT_VERSION, graph->size, graph->num_edges};
+	fwrite(header, sizeof(int), 3, OUT);
+	fwrite(&fingerprint, sizeof(unsigned long long), 1, OUT);
+	fwrite(&steps, sizeof(long long), 1, OUT);
+	fwrite(&nblocks, sizeof(int), 1, OUT);
+	fwrite(&nnull, sizeof(int), 1, OUT);
+	fwrite(&nqueue, sizeof(long long), 1, OUT);
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next) WRITE_BLOCK(OUT, current_part->block);
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next) WRITE_BLOCK(OUT, current_part->block);
+	for(queued=qhead; queued!=NULL; queued=queued->next) WRITE_BLOCK(OUT, queued->block);
+	int status = (fflush(OUT)==0 && fsync(fileno(OUT))==0);
+	if(fclose(OUT)!=0) status = 0;
+	if(status==1 && rename(temp, filename)!=0) status = 0;
+	if(status==0) unlink(temp);
+	return status;
+}
+
+/*	Reads a list of 'n' blocks into 'part', in the written order. */
+int READ_PARTITION(FILE* IN, int N, int n, PART** part)
+{
+	int k;
+	BLOCK** blocks = (BLOCK**)malloc((n>0 ? n : 1)*sizeof(BLOCK*));
+	for(k=0; k<n; k++)
+	{
+		blocks[k] = READ_BLOCK(IN, N);
+		if(blocks[k]==NULL) break;
+	}
+	int status = (k==n);
+	if(status==0) n = k;
+	// 'push_block' puts each block at the head of the list.
+	for(k=n-1; k>=0; k--) push_block(part, blocks[k]);
+	free(blocks);
+	return status;
+}
+
+/*	Loads the checkpoint written for 'graph'. Returns zero when the file does not exist,
+	belongs to another graph or is damaged, leaving the lists empty.	*/
+int LOAD_CHECKPOINT(char* filename, Graph* graph, unsigned long long fingerprint, long long* steps, PART** partition, PART** null_partition, QBLOCK** qhead, QBLOCK** qtail)
+{
+	char magic[4];
+	int header[3];
+	unsigned long long saved_fingerprint;
+	int nblocks, nnull;
+	long long k, nqueue;
+	FILE* IN = fopen(filename, "rb");
+	if(IN==NULL) return 0;
+	int status = (fread(magic, 1, 4, IN)==4 && memcmp(magic, CHECKPOINT_MAGIC, 4)==0);
+	status = status && fread(header, sizeof(int), 3, IN)==3 && fread(&saved_fingerprint, sizeof(unsigned long long), 1, IN)==1;
+	status = status && header[0]==CHECKPOINT_VERSION && header[1]==graph->size && header[2]==graph->num_edges && saved_fingerprint==fingerprint;
+	status = status && fread(steps, sizeof(long long), 1, IN)==1 && fread(&nblocks, sizeof(int), 1, IN)==1;
+	status = status && fread(&nnull, sizeof(int), 1, IN)==1 && fread(&nqueue, sizeof(long long), 1, IN)==1;
+	status = status && READ_PARTITION(IN, graph->size, nblocks, partition) && READ_PARTITION(IN, graph->size, nnull, null_partition);
+	for(k=0; status && k<nqueue; k++)
+	{
+		BLOCK* block = READ_BLOCK(IN, graph->size);
+		if(block==NULL) { status = 0; break; }
+		QBLOCK* element = (QBLOCK*)malloc(sizeof(QBLOCK));
+		element->block = block;
+		element->next = NULL;
+		if(*qhead==NULL) *qhead = element;
+		else (*qtail)->next = element;
+		*qtail = element;
+	}
+	fclose(IN);
+	if(status==0)
+	{
+		FreePartition(partition);
+		FreePartition(null_partition);
+		while(*qhead)
+		{
+			BLOCK* block = dequeue_block(qhead, qtail);
+			deleteList(&(block->head));
+			free(block);
+		}
+	}
+	return status;
+}
+
+/*	'REFINEMENT' with a checkpoint written to 'filename' every 'interval' seconds, resumed
+	from that file when it is valid for 'graph'.	*/
+extern void CHECKPOINTED_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, char* filename, double interval)
+{
+	QBLOCK* qhead = NULL;
+	QBLOCK* qtail = NULL;
+	long long steps = 0;
+	unsigned long long fingerprint = GRAPH_FINGERPRINT(graph);
+	if(LOAD_CHECKPOINT(filename, graph, fingerprint, &steps, partition, null_partition, &qhead, &qtail))
+		printf("Resuming the refinement from '%s' after %lld splitters\n", filename, steps);
+	else
+	{
+		PART* null_partition1 = NULL;
+		PREPROCESSING(partition, null_partition, &null_partition1, components, graph);
+		ENQUEUE_BLOCKS(partition, &qhead, &qtail);
+		ENQUEUE_BLOCKS(null_partition, &qhead, &qtail);
+		ENQUEUE_BLOCKS(&null_partition1, &qhead, &qtail);
+		FreePartition(&null_partition1);
+	}
+
+	pid_t writer = -1;
+	double last = WALL_TIME();
+	BLOCK* CurrentSet;
+	while(qhead)
+	{
+		CurrentSet = dequeue_block(&qhead, &qtail);
+		S_SPLIT(partition, CurrentSet, graph, &qhead, &qtail, NULL);
+		deleteList(&(CurrentSet->head));
+		free(CurrentSet);
+		steps++;
+
+		if(WALL_TIME() - last<interval) continue;
+		// The previous checkpoint must be finished before the next one starts.
+		if(writer>0 && waitpid(writer, NULL, WNOHANG)==0) continue;
+		fflush(stdout);
+		writer = fork();
+		if(writer==0) _exit(SAVE_CHECKPOINT(filename, graph, fingerprint, steps, *partition, *null_partition, qhead) ? 0 : 1);
+		// Without a child process, the checkpoint is written by this one.
+		if(writer<0) SAVE_CHECKPOINT(filename, graph, fingerprint, steps, *partition, *null_partition, qhead);
+		last = WALL_TIME();
+	}
+	if(writer>0) waitpid(writer, NULL, 0);
+	unlink(filename);
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*	Lazy classification of the fibers. The classification |n,l> of a fiber (branch ratio n
+	by 'BRANCH_RATIO' and external regulators l by 'CALCULATE_BLOCK_REGULATORS') is only
+	computed when that fiber is requested, and is kept for the next requests, so the jobs
+	that only need the number of fibers, or the class of a few of them, do not pay for the
+	classification of the whole partition.
+
+	The fibers are numbered as in 'BUILD_QUOTIENT': the blocks of 'partition' and then the
+	blocks of 'null_partition'. The fibers to classify can be selected by a filter:
+
+		min_size	only the fibers with at least 'min_size' nodes;
+		nodes		only the fibers containing one of the 'nnodes' given nodes (if nnodes>0);
+		scc_node	only the fibers with a node in the strongly connected component of
+					'scc_node' (if scc_node>=0).
+
+	The selection is done in O(N) (plus the search of the strongly connected component).
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef CLASSIFYF_H
+#define CLASSIFYF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fibrationf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+struct ClassFilter
+{
+	int min_size;
+	int* nodes;
+	int nnodes;
+	int scc_node;
+};
+typedef struct ClassFilter CLASSFILTER;
+
+struct Classifier
+{
+	int size;			// Number of fibers.
+	PART** fibers;		// Fiber of each index, in the numbering of 'BUILD_QUOTIENT'.
+	char* done;			// Whether the fiber was already classified.
+	int* node_fiber;
+	Graph* graph;
+};
+typedef struct Classifier CLASSIFIER;
+
+CLASSFILTER DEFAULT_CLASSFILTER()
+{
+	CLASSFILTER filter;
+	filter.min_size = 0;
+	filter.nodes = NULL;
+	filter.nnodes = 0;
+	filter.scc_node = -1;
+	return filter;
+}
+
+/*	Prepares the classification of the fibers of 'partition' and 'null_partition', which
+	must not be changed while the classifier is in use.	*/
+extern CLASSIFIER* CreateClassifier(PART* partition, PART* null_partition, Graph* graph)
+{
+	int f = 0;
+	PART* current_part;
+	NODELIST* nodelist;
+	CLASSIFIER* classifier = (CLASSIFIER*)malloc(sizeof(CLASSIFIER));
+	classifier->size = GetPartitionSize(partition) + GetPartitionSize(null_partition);
+	classifier->fibers = (PART**)malloc((classifier->size>0 ? classifier->size : 1)*sizeof(PART*));
+	classifier->done = (char*)calloc((classifier->size>0 ? classifier->size : 1), sizeof(char));
+	classifier->node_fiber = (int*)malloc((graph->size>0 ? graph->size : 1)*sizeof(int));
+	classifier->graph = graph;
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next, f++)
+	{
+		classifier->fibers[f] = current_part;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) classifier->node_fiber[nodelist->data] = f;
+	}
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next, f++)
+	{
+		classifier->fibers[f] = current_part;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) classifier->node_fiber[nodelist->data] = f;
+	}
+	return classifier;
+}
+
+extern void FreeClassifier(CLASSIFIER* classifier)
+{
+	free(classifier->fibers);
+	free(classifier->done);
+	free(classifier->node_fiber);
+	free(classifier);
+}
+
+/*	Classifies the fiber 'f', if not done yet, and returns its block. */
+extern PART* CLASSIFY_FIBER(CLASSIFIER* classifier, int f)
+{
+	PART* fiber = classifier->fibers[f];
+	if(classifier->done[f]) return fiber;
+	fiber->regulators = NULL;
+	fiber->number_regulators = 0;
+	fiber->fundamental_number = 0.0;
+	CALCULATE_BLOCK_REGULATORS(fiber, classifier->graph);
+	if(fiber->block->size>1) fiber->fundamental_number = BRANCH_RATIO(fiber, classifier->graph);
+	classifier->done[f] = 1;
+	return fiber;
+}
+
+/*	Writes in 'selected' the fibers that pass 'filter', in increasing order, and returns
+	their number. 'selected' must hold 'classifier->size' fibers.	*/
+extern int SELECT_FIBERS(CLASSIFIER* classifier, CLASSFILTER* filter, int* selected)
+{
+	int f, k, n = 0;
+	NODELIST* nodelist;
+	// 'mark[f]' counts the conditions on the nodes satisfied by fiber 'f'.
+	int required = (filter->nnodes>0) + (filter->scc_node>=0);
+	char* mark = (char*)calloc((classifier->size>0 ? classifier->size : 1), sizeof(char));
+	char* seen = (char*)calloc((classifier->size>0 ? classifier->size : 1), sizeof(char));
+	for(k=0; k<filter->nnodes; k++)
+	{
+		if(filter->nodes[k]<0 || filter->nodes[k]>=classifier->graph->size) continue;
+		f = classifier->node_fiber[filter->nodes[k]];
+		if(seen[f]==0) { seen[f] = 1; mark[f]++; }
+	}
+	if(filter->scc_node>=0 && filter->scc_node<classifier->graph->size)
+	{
+		NODELIST* scc = NULL;
+		memset(seen, 0, classifier->size*sizeof(char));
+		KOSAJARU(&scc, filter->scc_node, classifier->graph);
+		for(nodelist=scc; nodelist!=NULL; nodelist=nodelist->next)
+		{
+			f = classifier->node_fiber[nodelist->data];
+			if(seen[f]==0) { seen[f] = 1; mark[f]++; }
+		}
+		deleteList(&scc);
+	}
+	for(f=0; f<classifier->size; f++)
+		if(mark[f]==required && classifier->fibers[f]->block->size>=filter->min_size) selected[n++] = f;
+	free(mark);
+	free(seen);
+	return n;
+}
+
+/*	Selects the fibers that pass 'filter' and classifies them. */
+extern int CLASSIFY_FIBERS(CLASSIFIER* classifier, CLASSFILTER* filter, int* selected)
+{
+	int k;
+	int n = SELECT_FIBERS(classifier, filter, selected);
+	for(k=0; k<n; k++) CLASSIFY_FIBER(classifier, selected[k]);
+	return n;
+}
+
+/*	Writes the classification of the 'n' fibers of 'selected' ("%d\t%d\t%lf\t%d\n" -> Fiber/
+	Size/ Fundamental number n/ Number of external regulators l).	*/
+extern void WRITE_CLASSIFICATION(CLASSIFIER* classifier, int* selected, int n, char* filename)
+{
+	int k;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	for(k=0; k<n; k++)
+	{
+		PART* fiber = CLASSIFY_FIBER(classifier, selected[k]);
+		fprintf(OUT, "%d\t%d\t%lf\t%d\n", selected[k], fiber->block->size, fiber->fundamental_number, fiber->number_regulators);
+	}
+	fclose(OUT);
+}
+
+#endif
@@ -0,0 +1,22 @@
+/*	Wall-clock time for the timings of the engines and of the tools. 'WALL_TIME' reads the
+	monotonic clock, so the differences are not affected by changes of the system time.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef CLOCKF_H
+#define CLOCKF_H
+
+#include <time.h>
+
+/*	Seconds elapsed since an arbitrary fixed point.	*/
+double WALL_TIME()
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + 1e-9*t.tv_nsec;
+}
+
+#endif
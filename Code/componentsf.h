@@ -0,0 +1,184 @@
+/*	In this module I define the disjoint-set (union-find) operations used to identify
+	the weakly connected components of the network while its edges are loaded. The
+	components are the first partition used by 'PREPROCESSING', so every run depends
+	on them.
+
+	Two modes are given. The serial mode keeps the classical representation where
+	'psite[root]' stores minus the size of the component and any other node stores its
+	parent. Roots are found with iterative path halving (no auxiliary buffer, so it is
+	safe for any tree depth) and sets are joined by size. The concurrent mode works on
+	a plain parent array ('parent[root] = root') with lock-free compare-and-swap links,
+	so several threads can consume disjoint slices of the edgelist at the same time.
+	At the end, the concurrent forest is converted to the serial representation.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef COMPONENTSF_H
+#define COMPONENTSF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/////////////////////////////////////////////////////////////////
+/////////////////////// SERIAL UNION-FIND ///////////////////////
+/////////////////////////////////////////////////////////////////
+
+/*	Returns the root of 'node'. Each visited node is linked to its grandparent
+	(path halving), which keeps the trees shallow without recursion or stacks.	*/
+int findroot(int node, int* psite)
+{
+	int parent;
+	while(psite[node]>=0)
+	{
+		parent = psite[node];
+		if(psite[parent]>=0) psite[node] = psite[parent];
+		node = psite[node];
+	}
+	return node;
+}
+
+/*	Joins the sets of roots 'root1' and 'root2'. The smallest set is linked
+	to the largest one (union by size).	*/
+void merge(int root1, int root2, int* psite)
+{
+	if(root1==root2) return;
+	if(psite[root1] <= psite[root2])
+	{
+		psite[root1] += psite[root2];
+		psite[root2] = root1;
+	}
+	else
+	{
+		psite[root2] += psite[root1];
+		psite[root1] = root2;
+	}
+}
+//////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////
+///////////////////// CONCURRENT UNION-FIND /////////////////////
+/////////////////////////////////////////////////////////////////
+
+/*	Linking priority of a root. A fixed pseudo-random order over the nodes
+	avoids the long chains that an order by index would produce, and, being
+	a total order, it makes cycles impossible when several threads link roots
+	at the same time.	*/
+unsigned int LINK_PRIORITY(int node)
+{
+	unsigned int x = (unsigned int)node;
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+/*	Lock-free find with path halving. Parents only move towards the root, so
+	a failed compare-and-swap can be ignored.	*/
+int CONCURRENT_FINDROOT(int node, int* parent)
+{
+	int p, gp;
+	while(1)
+	{
+		p = __atomic_load_n(&parent[node], __ATOMIC_ACQUIRE);
+		if(p==node) return node;
+		gp = __atomic_load_n(&parent[p], __ATOMIC_ACQUIRE);
+		if(gp!=p) __atomic_compare_exchange_n(&parent[node], &p, gp, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+		node = gp;
+	}
+}
+
+/*	Lock-free union. The root with lower priority is linked below the other
+	one only if it is still a root, otherwise the roots are searched again.	*/
+void CONCURRENT_MERGE(int node1, int node2, int* parent)
+{
+	int root1, root2, expected;
+	unsigned int prior1, prior2;
+	while(1)
+	{
+		root1 = CONCURRENT_FINDROOT(node1, parent);
+		root2 = CONCURRENT_FINDROOT(node2, parent);
+		if(root1==root2) return;
+
+		prior1 = LINK_PRIORITY(root1);
+		prior2 = LINK_PRIORITY(root2);
+		if(prior1>prior2 || (prior1==prior2 && root1>root2))
+		{
+			expected = root1;
+			root1 = root2;
+			root2 = expected;
+		}
+		// 'root1' has the lowest priority and goes below 'root2'.
+		expected = root1;
+		if(__atomic_compare_exchange_n(&parent[root1], &expected, root2, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return;
+	}
+}
+
+struct UnionFindTask
+{
+	int** edges;
+	int first;
+	int last;
+	int* parent;
+};
+typedef struct UnionFindTask UFTASK;
+
+void* UNIONFIND_WORKER(void* arg)
+{
+	int j;
+	UFTASK* task = (UFTASK*)arg;
+	for(j=task->first; j<task->last; j++)
+		CONCURRENT_MERGE(task->edges[j][0], task->edges[j][1], task->parent);
+	return NULL;
+}
+
+/*	Launches 'nthreads' workers, each one consuming a contiguous slice of the
+	edgelist. The threads are only started here; 'JOIN_UNIONFIND' waits for them.
+	This way the caller can build the adjacency structures meanwhile.	*/
+extern UFTASK* START_UNIONFIND(int** edges, int nE, int N, int nthreads, pthread_t* threads)
+{
+	int t, j;
+	int* parent = (int*)malloc(N*sizeof(int));
+	for(j=0; j<N; j++) parent[j] = j;
+
+	UFTASK* tasks = (UFTASK*)malloc(nthreads*sizeof(UFTASK));
+	for(t=0; t<nthreads; t++)
+	{
+		tasks[t].edges = edges;
+		tasks[t].first = (int)(((long)nE*t)/nthreads);
+		tasks[t].last = (int)(((long)nE*(t+1))/nthreads);
+		tasks[t].parent = parent;
+		pthread_create(&threads[t], NULL, UNIONFIND_WORKER, &tasks[t]);
+	}
+	return tasks;
+}
+
+/*	Waits for the workers and converts the concurrent forest to the serial
+	representation in 'psite'. Returns the number of weakly connected components.	*/
+extern int JOIN_UNIONFIND(UFTASK* tasks, int N, int nthreads, pthread_t* threads, int* psite)
+{
+	int t, j, root;
+	int num_component = 0;
+	int* parent = tasks[0].parent;
+	for(t=0; t<nthreads; t++) pthread_join(threads[t], NULL);
+
+	for(j=0; j<N; j++) psite[j] = -1;
+	for(j=0; j<N; j++)
+	{
+		root = CONCURRENT_FINDROOT(j, parent);
+		if(root==j) num_component++;
+		else { psite[j] = root; psite[root]--; }
+	}
+
+	free(parent);
+	free(tasks);
+	return num_component;
+}
+//////////////////////////////////////////////////////////////////
+
+#endif
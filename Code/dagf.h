@@ -0,0 +1,290 @@
+/*	Linear-time fast path for the nodes with finite input-trees. A node has a finite
+	input-tree ('INFINITE_INTREE' equal to zero) when none of its ancestors belongs to a
+	cycle. For these nodes, the fiber is fully determined by the typed multiset of the
+	fibers of their in-neighbors, and all their in-neighbors also have finite input-trees.
+	Thus, visiting the condensation DAG of the strongly connected components (SCC) in
+	topological order, each of these nodes receives its fiber in a single step by looking
+	up its signature (weak component root + sorted list of (fiber, type) of its inputs)
+	in a hash table.
+
+	Only the nodes with infinite input-trees, i.e., the nontrivial SCCs (size larger
+	than one or with self-loops) and everything downstream of them, are refined by the
+	splitting procedure. For that, the finite fibers feeding these nodes are collapsed
+	into one source node each, keeping the edge multiplicities, and the resulting
+	subgraph is refined by 'REFINEMENT'/'PARALLEL_REFINEMENT'.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef DAGF_H
+#define DAGF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "fibrationf.h"
+#include "parallelf.h"
+
+/*	Iterative Tarjan's algorithm over the CSR arrays. 'scc[v]' receives the SCC index of
+	'v' and 'order' receives all the nodes in the order their SCCs are completed, which is
+	a reverse topological order of the condensation DAG. Returns the number of SCCs.	*/
+extern int STRONG_COMPONENTS(Graph* graph, int* scc, int* order)
+{
+	int N = graph->size;
+	int i, v, w, root;
+	int counter = 0, nscc = 0, norder = 0;
+	int top = 0, call_top = 0;
+	int* index = (int*)malloc(N*sizeof(int));
+	int* low = (int*)malloc(N*sizeof(int));
+	int* edge = (int*)malloc(N*sizeof(int));
+	int* stack = (int*)malloc(N*sizeof(int));
+	int* call = (int*)malloc(N*sizeof(int));
+	for(i=0; i<N; i++) { index[i] = -1; scc[i] = -1; }
+
+	for(root=0; root<N; root++)
+	{
+		if(index[root]>=0) continue;
+		call[call_top++] = root;
+		index[root] = low[root] = counter++;
+		edge[root] = graph->out_start[root];
+		stack[top++] = root;
+		while(call_top)
+		{
+			v = call[call_top-1];
+			if(edge[v]<graph->out_start[v+1])
+			{
+				w = graph->out_adj[edge[v]++];
+				if(index[w]<0)
+				{
+					index[w] = low[w] = counter++;
+					edge[w] = graph->out_start[w];
+					stack[top++] = w;
+					call[call_top++] = w;
+				}
+				else if(scc[w]<0 && index[w]<low[v]) low[v] = index[w];
+				continue;
+			}
+			// All the out-neighbors of 'v' were visited.
+			call_top--;
+			if(call_top && low[v]<low[call[call_top-1]]) low[call[call_top-1]] = low[v];
+			if(low[v]==index[v])
+			{
+				do
+				{
+					w = stack[--top];
+					scc[w] = nscc;
+					order[norder++] = w;
+				} while(w!=v);
+				nscc++;
+			}
+		}
+	}
+	free(index);
+	free(low);
+	free(edge);
+	free(stack);
+	free(call);
+	return nscc;
+}
+
+/*	Marks with one the nodes with infinite input-trees. */
+extern void INFINITE_INTREE_NODES(Graph* graph, int* scc, int* order, int nscc, int* infinite)
+{
+	int i, j, v;
+	int N = graph->size;
+	int* scc_size = (int*)calloc(nscc, sizeof(int));
+	for(i=0; i<N; i++) scc_size[scc[i]]++;
+
+	/*	Nodes of nontrivial SCCs are infinite. Following the topological order, the other
+		ones are infinite if they have self-loops or receive from infinite nodes.	*/
+	for(i=0; i<N; i++) infinite[i] = (scc_size[scc[i]]>1);
+	for(i=N-1; i>=0; i--)
+	{
+		v = order[i];
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			if(graph->in_adj[j]==v || infinite[graph->in_adj[j]]) { infinite[v] = 1; break; }
+	}
+	free(scc_size);
+}
+
+int cmp_signature(const void* a, const void* b)
+{
+	long long x = *(long long*)a;
+	long long y = *(long long*)b;
+	if(x<y) return -1;
+	else if(x>y) return 1;
+	return 0;
+}
+
+unsigned long long HASH_SIGNATURE(long long* sig, int len)
+{
+	int i;
+	unsigned long long h = FNV_OFFSET;
+	for(i=0; i<len; i++)
+	{
+		h ^= (unsigned long long)sig[i];
+		h *= FNV_PRIME;
+		h ^= h >> 29;
+	}
+	return h;
+}
+
+/*	Assigns a fiber to each node with finite input-tree, following the topological order.
+	Nodes without inputs receive their own fiber. Returns the number of fibers and
+	stores them in 'fiber' ('fiber[v] = -1' for the nodes with infinite input-trees).	*/
+extern int FINITE_FIBERS(Graph* graph, int* components, int* order, int* infinite, int* fiber)
+{
+	int N = graph->size;
+	int i, j, v, len, slot, nfiber = 0;
+	unsigned long long h;
+
+	int capacity = 1;
+	while(capacity<2*N) capacity <<= 1;
+	int* table = (int*)malloc(capacity*sizeof(int));		// fiber stored at each slot.
+	for(i=0; i<capacity; i++) table[i] = -1;
+
+	/*	The signature of each fiber is kept in one pool: 'pool[sig_start[f]]' is the weak
+		component root and the following entries are the sorted (fiber, type) pairs.	*/
+	long long* pool = (long long*)malloc((graph->num_edges+N)*sizeof(long long));
+	int* sig_start = (int*)malloc((N+1)*sizeof(int));
+	int* sig_len = (int*)malloc((N+1)*sizeof(int));
+	int pool_size = 0;
+
+	for(i=0; i<N; i++) fiber[i] = -1;
+	for(i=N-1; i>=0; i--)
+	{
+		v = order[i];
+		if(infinite[v]) continue;
+		if(graph->in_start[v]==graph->in_start[v+1]) { fiber[v] = nfiber++; continue; }
+
+		long long* sig = &pool[pool_size];
+		len = 0;
+		sig[len++] = findroot(v, components);
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			sig[len++] = 4*(long long)fiber[graph->in_adj[j]] + (graph->in_type[j]+1);
+		qsort(sig+1, len-1, sizeof(long long), cmp_signature);
+
+		h = HASH_SIGNATURE(sig, len);
+		slot = (int)(h & (capacity-1));
+		while(table[slot]>=0)
+		{
+			int f = table[slot];
+			if(sig_len[f]==len && memcmp(&pool[sig_start[f]], sig, len*sizeof(long long))==0) break;
+			slot = (slot+1) & (capacity-1);
+		}
+		if(table[slot]>=0) fiber[v] = table[slot];
+		else
+		{
+			// New fiber: its signature stays in the pool.
+			fiber[v] = nfiber;
+			table[slot] = nfiber;
+			sig_start[nfiber] = pool_size;
+			sig_len[nfiber] = len;
+			pool_size += len;
+			nfiber++;
+		}
+	}
+	free(table);
+	free(pool);
+	free(sig_start);
+	free(sig_len);
+	return nfiber;
+}
+
+/*	Same result of 'REFINEMENT', but only the nodes with infinite input-trees go
+	through the splitting procedure.	*/
+extern void DAG_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, int nthreads)
+{
+	int N = graph->size;
+	int i, j, v, f, r;
+	int* scc = (int*)malloc(N*sizeof(int));
+	int* order = (int*)malloc(N*sizeof(int));
+	int* infinite = (int*)malloc(N*sizeof(int));
+	int* fiber = (int*)malloc(N*sizeof(int));
+
+	int nscc = STRONG_COMPONENTS(graph, scc, order);
+	INFINITE_INTREE_NODES(graph, scc, order, nscc, infinite);
+	int nfiber = FINITE_FIBERS(graph, components, order, infinite, fiber);
+
+	// Blocks of the finite fibers. Nodes without inputs are single blocks of 'null_partition'.
+	BLOCK** fiber_block = (BLOCK**)malloc(nfiber*sizeof(BLOCK*));
+	for(f=0; f<nfiber; f++) fiber_block[f] = NULL;
+	for(v=N-1; v>=0; v--)
+	{
+		if(fiber[v]<0) continue;
+		f = fiber[v];
+		if(fiber_block[f]==NULL)
+		{
+			fiber_block[f] = (BLOCK*)malloc(sizeof(BLOCK));
+			fiber_block[f]->index = -1;
+			fiber_block[f]->size = 0;
+			fiber_block[f]->head = NULL;
+			if(graph->in_start[v]==graph->in_start[v+1]) push_block(null_partition, fiber_block[f]);
+			else push_block(partition, fiber_block[f]);
+		}
+		add_to_block(&fiber_block[f], v);
+	}
+	free(fiber_block);
+
+	/*	Subgraph of the infinite nodes, plus one source node for each finite fiber that
+		feeds them. The subgraph nodes are grouped by their weak component root.	*/
+	int n_targets = 0;
+	int* local = (int*)malloc(N*sizeof(int));
+	int* nodes = (int*)malloc(N*sizeof(int));
+	int* rep = (int*)malloc(nfiber*sizeof(int));
+	for(i=0; i<N; i++) local[i] = -1;
+	for(f=0; f<nfiber; f++) rep[f] = -1;
+	for(v=0; v<N; v++) if(infinite[v]) { local[v] = n_targets; nodes[n_targets++] = v; }
+	int n = n_targets;
+	for(i=0; i<n_targets; i++)
+	{
+		v = nodes[i];
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+		{
+			f = fiber[graph->in_adj[j]];
+			if(f>=0 && rep[f]<0) { rep[f] = n; nodes[n++] = graph->in_adj[j]; }
+		}
+	}
+	for(v=0; v<N; v++) if(fiber[v]>=0) local[v] = rep[fiber[v]];
+
+	if(n_targets>0)
+	{
+		Graph* sub = BUILD_SUBGRAPH(graph, nodes, n, n_targets, local);
+		int* subcomp = (int*)malloc(n*sizeof(int));
+		int* first = (int*)malloc(N*sizeof(int));
+		for(i=0; i<N; i++) first[i] = -1;
+		sub->num_component = 0;
+		for(i=0; i<n; i++)
+		{
+			r = findroot(nodes[i], components);
+			if(first[r]<0) { first[r] = i; subcomp[i] = -1; sub->num_component++; }
+			else { subcomp[i] = first[r]; subcomp[first[r]]--; }
+		}
+
+		PART* subpart = NULL;
+		PART* subnull = NULL;
+		if(sub->num_component>1) PARALLEL_REFINEMENT(&subpart, &subnull, subcomp, sub, nthreads);
+		else REFINEMENT(&subpart, &subnull, subcomp, sub);
+
+		// The collapsed finite fibers are the only sources of the subgraph.
+		LIFT_PARTITION(subpart, nodes);
+		SPLICE_PARTITION(partition, subpart);
+		FreePartition(&subnull);
+		free(subcomp);
+		free(first);
+		FreeGraph(sub);
+	}
+	free(local);
+	free(nodes);
+	free(rep);
+	free(scc);
+	free(order);
+	free(infinite);
+	free(fiber);
+}
+
+#endif
@@ -0,0 +1,351 @@
+/*	Distributed refinement: the nodes are split in K ranges of consecutive IDs (shards)
+	and each range is given to one worker process, which only keeps the edges pointing to
+	its own nodes. The coordinator keeps the partition ('EXTPART' of 'externalf.h', O(N))
+	and drives the refinement in synchronized rounds over a transport ('transportf.h'):
+
+	1.	The coordinator takes all the blocks waiting in the queue as the splitters of the
+		round and broadcasts their nodes, as (node, splitter) pairs.
+	2.	Each worker streams the edges leaving the splitter nodes into its shard and, for
+		each node reached, replies with its signature: the sorted list of (splitter and
+		edge type, number of edges) pairs.
+	3.	The coordinator splits the blocks by the signatures of their nodes, exactly as
+		'EXTERNAL_SPLIT' splits by the counts of one splitter, and enqueues the new blocks.
+
+	Refining by several splitters in the same round gives the same coarsest partition of
+	'REFINEMENT': the splitters are taken from the partition before the round, so each
+	block split in the round was either processed as a splitter or still waits in the
+	queue, as in the serial loop. The nodes whose only inputs are self-loops are the
+	splitters of a first round by themselves, as in 'PREPROCESSING'.
+
+	Messages (ints):
+		round	m node_1 splitter_1 ... node_m splitter_m		(m = -1 stops the workers)
+		reply	T, then for each reached node: node L key_1 count_1 ... key_L count_L
+
+	with key = 3*splitter + edge type.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef DISTRIBUTEDF_H
+#define DISTRIBUTEDF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "utilsforfiber.h"
+#include "externalf.h"
+#include "transportf.h"
+
+struct Shard
+{
+	int N;
+	int first;				// nodes 'first' to 'last-1' belong to the shard.
+	int last;
+	long long* out_start;	// edges from node 'u' into the shard: 'out_start[u]' to 'out_start[u+1]-1'.
+	int* target;
+	signed char* type;
+};
+typedef struct Shard SHARD;
+
+/*	Reads the edges of 'filename' pointing to the nodes of the shard. The edges of unknown
+	type are skipped, since they never split a block.	*/
+SHARD* LOAD_SHARD(char* filename, int N, int first, int last)
+{
+	int i, j, t;
+	long long k, nE;
+	char type[20];
+	FILE* EDGE_FILE = fopen(filename, "r");
+	if(EDGE_FILE==NULL) return NULL;
+	SHARD* shard = (SHARD*)malloc(sizeof(SHARD));
+	shard->N = N;
+	shard->first = first;
+	shard->last = last;
+	shard->out_start = (long long*)calloc(N+1, sizeof(long long));
+
+	long long capacity = 1024;
+	int* pairs = (int*)malloc(2*capacity*sizeof(int));
+	signed char* types = (signed char*)malloc(capacity*sizeof(signed char));
+	nE = 0;
+	while(fscanf(EDGE_FILE, "%d\t%d\t%s\n", &i, &j, type)==3)
+	{
+		if(i<0 || j<first || j>=last) continue;
+		t = REGULATION_TYPE(type);
+		if(t<0) continue;
+		if(nE==capacity)
+		{
+			capacity = 2*capacity;
+			pairs = (int*)realloc(pairs, 2*capacity*sizeof(int));
+			types = (signed char*)realloc(types, capacity*sizeof(signed char));
+		}
+		pairs[2*nE] = i;
+		pairs[2*nE+1] = j;
+		types[nE] = (signed char)t;
+		nE++;
+	}
+	fclose(EDGE_FILE);
+
+	for(k=0; k<nE; k++) shard->out_start[pairs[2*k]+1]++;
+	for(i=0; i<N; i++) shard->out_start[i+1] += shard->out_start[i];
+	shard->target = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	shard->type = (signed char*)malloc((nE>0 ? nE : 1)*sizeof(signed char));
+	long long* fill = (long long*)malloc((N>0 ? N : 1)*sizeof(long long));
+	memcpy(fill, shard->out_start, N*sizeof(long long));
+	for(k=0; k<nE; k++)
+	{
+		long long e = fill[pairs[2*k]]++;
+		shard->target[e] = pairs[2*k+1];
+		shard->type[e] = types[k];
+	}
+	free(fill);
+	free(pairs);
+	free(types);
+	return shard;
+}
+
+void FreeShard(SHARD* shard)
+{
+	free(shard->out_start);
+	free(shard->target);
+	free(shard->type);
+	free(shard);
+}
+
+int cmp_key(const void* a, const void* b)
+{
+	int x = *(int*)a;
+	int y = *(int*)b;
+	return (x>y) - (x<y);
+}
+
+/*	Worker loop: answers the rounds of the coordinator until it stops them. */
+void DISTRIBUTED_WORKER(TRANSPORT* transport, char* filename, int N, int first, int last)
+{
+	int k, u, v, n, s;
+	long long e, m, length;
+	SHARD* shard = LOAD_SHARD(filename, N, first, last);
+	int size = last - first;
+	int* splitter = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	int* nkeys = (int*)calloc(size>0 ? size : 1, sizeof(int));
+	long long* offset = (long long*)malloc((size>0 ? size : 1)*sizeof(long long));
+	int* reached = (int*)malloc((size>0 ? size : 1)*sizeof(int));
+	for(u=0; u<N; u++) splitter[u] = -1;
+	long long key_capacity = 1024;
+	long long reply_capacity = 1024;
+	int* keys = (int*)malloc(key_capacity*sizeof(int));
+	int* answer = (int*)malloc(reply_capacity*sizeof(int));
+
+	while(1)
+	{
+		int* round = transport->fetch(transport, &length);
+		if(round==NULL || length<1 || round[0]<0) break;
+		m = round[0];
+		if(shard==NULL)
+		{
+			// The coordinator stops when a worker can not read its shard.
+			answer[0] = -1;
+			if(transport->reply(transport, answer, 1)==0) break;
+			continue;
+		}
+		for(k=0; k<m; k++) splitter[round[1+2*k]] = round[2+2*k];
+
+		// Number of keys of each reached node.
+		int nreached = 0;
+		long long total = 0;
+		for(k=0; k<m; k++)
+		{
+			u = round[1+2*k];
+			for(e=shard->out_start[u]; e<shard->out_start[u+1]; e++)
+			{
+				v = shard->target[e] - first;
+				if(nkeys[v]==0) reached[nreached++] = v;
+				nkeys[v]++;
+				total++;
+			}
+		}
+		if(total>key_capacity)
+		{
+			key_capacity = total;
+			keys = (int*)realloc(keys, key_capacity*sizeof(int));
+		}
+		long long position = 0;
+		for(k=0; k<nreached; k++)
+		{
+			offset[reached[k]] = position;
+			position += nkeys[reached[k]];
+			nkeys[reached[k]] = 0;
+		}
+		for(k=0; k<m; k++)
+		{
+			u = round[1+2*k];
+			for(e=shard->out_start[u]; e<shard->out_start[u+1]; e++)
+			{
+				v = shard->target[e] - first;
+				keys[offset[v] + nkeys[v]++] = 3*splitter[u] + shard->type[e];
+			}
+		}
+
+		// Signatures: sorted keys with their multiplicities.
+		if(1 + 2*nreached + 2*total>reply_capacity)
+		{
+			reply_capacity = 1 + 2*nreached + 2*total;
+			answer = (int*)realloc(answer, reply_capacity*sizeof(int));
+		}
+		long long pos = 1;
+		answer[0] = nreached;
+		for(k=0; k<nreached; k++)
+		{
+			v = reached[k];
+			int* list = keys + offset[v];
+			n = nkeys[v];
+			qsort(list, n, sizeof(int), cmp_key);
+			answer[pos++] = v + first;
+			long long length_pos = pos++;
+			int npairs = 0;
+			for(s=0; s<n; s++)
+			{
+				if(s>0 && list[s]==list[s-1]) { answer[pos-1]++; continue; }
+				answer[pos++] = list[s];
+				answer[pos++] = 1;
+				npairs++;
+			}
+			answer[length_pos] = npairs;
+			nkeys[v] = 0;
+		}
+		for(k=0; k<m; k++) splitter[round[1+2*k]] = -1;
+		if(transport->reply(transport, answer, pos)==0) break;
+	}
+	if(shard!=NULL) FreeShard(shard);
+	free(splitter);
+	free(nkeys);
+	free(offset);
+	free(reached);
+	free(keys);
+	free(answer);
+}
+
+/*	Compares two nodes by their signatures, with the signature of each reached node as
+	context.	*/
+int cmp_distributed(int a, int b, void* context)
+{
+	int k;
+	int* x = ((int**)context)[a];
+	int* y = ((int**)context)[b];
+	int n = (x[0]<y[0]) ? x[0] : y[0];
+	for(k=1; k<=2*n; k++) if(x[k]!=y[k]) return (x[k]<y[k]) ? -1 : 1;
+	if(x[0]!=y[0]) return (x[0]<y[0]) ? -1 : 1;
+	return 0;
+}
+
+/*	One round: broadcasts the 'm' (node, splitter) pairs of 'round[1..2m]' and splits the
+	blocks by the signatures collected from the workers, kept in 'signature' (one entry for
+	each node). Returns zero if any worker fails.	*/
+int DISTRIBUTED_ROUND(TRANSPORT* transport, EXTPART* P, int N, int* round, int m, int** signature)
+{
+	int w, k;
+	long long n;
+	round[0] = m;
+	if(transport->broadcast(transport, round, 1 + 2*(long long)m)==0) return 0;
+	P->ntouched = 0;
+	for(w=0; w<transport->nworkers; w++)
+	{
+		int* answer = transport->collect(transport, w, &n);
+		if(answer==NULL || n<1 || answer[0]<0) return 0;
+		long long pos = 1;
+		for(k=0; k<answer[0]; k++)
+		{
+			int v = answer[pos];
+			signature[v] = answer + pos + 1;
+			P->touched[P->ntouched++] = v;
+			pos += 2 + 2*(long long)answer[pos+1];
+		}
+	}
+	EXTERNAL_SPLIT(P, N, cmp_distributed, signature, NULL);
+	P->ntouched = 0;
+	return 1;
+}
+
+/*	Coarsest refinement of the network in 'filename' with 'transport->nworkers' worker
+	processes. Returns the number of fibers (-1 on failure), with the fibers of the nodes
+	in '*fiber' (allocated here, numbered as in 'EXTERNAL_FIBERS') and the number of nodes
+	in '*N'. An edgelist without any edge is a failure, found before the workers start.	*/
+extern int DISTRIBUTED_REFINEMENT(char* filename, TRANSPORT* transport, int** fiber, int* N, int* nsolitaire)
+{
+	int i, k, b, p;
+	FILE* EDGE_FILE = fopen(filename, "r");
+	if(EDGE_FILE==NULL) { printf("ERROR in file reading"); return -1; }
+	EXTGRAPH* eg = EXTERNAL_SCAN(EDGE_FILE, NULL, NULL);
+	fclose(EDGE_FILE);
+	if(eg->nE==0)
+	{
+		printf("ERROR: no edge could be read from %s\n", filename);
+		FreeExternalGraph(eg);
+		return -1;
+	}
+	*N = eg->N;
+	int K = transport->nworkers;
+
+	fflush(stdout);
+	pid_t* workers = (pid_t*)malloc(K*sizeof(pid_t));
+	for(k=0; k<K; k++)
+	{
+		workers[k] = fork();
+		if(workers[k]==0)
+		{
+			transport->attach(transport, k);
+			DISTRIBUTED_WORKER(transport, filename, eg->N, (int)((long long)eg->N*k/K), (int)((long long)eg->N*(k+1)/K));
+			_exit(0);
+		}
+	}
+	transport->attach(transport, -1);
+	transport->workers = workers;
+
+	EXTPART* P = CreateExternalPartition(eg);
+	int** signature = (int**)malloc((eg->N>0 ? eg->N : 1)*sizeof(int*));
+	int* round = (int*)malloc((1 + 2*(long long)(eg->N>0 ? eg->N : 1))*sizeof(int));
+	int status = 1;
+
+	// First round: the nodes whose only inputs are self-loops, each one a splitter.
+	int m = 0;
+	for(i=0; i<eg->N; i++)
+		if(eg->inputs[i]==1) { round[1+2*m] = i; round[2+2*m] = m; m++; }
+	if(m>0) status = DISTRIBUTED_ROUND(transport, P, eg->N, round, m, signature);
+
+	// Next rounds: all the blocks waiting in the queue.
+	while(status && P->qsize>0)
+	{
+		m = 0;
+		int s = 0;
+		while(P->qsize>0)
+		{
+			b = EXTERNAL_DEQUEUE(P, eg->N);
+			for(p=P->first[b]; p<P->last[b]; p++) { round[1+2*m] = P->elements[p]; round[2+2*m] = s; m++; }
+			s++;
+		}
+		status = DISTRIBUTED_ROUND(transport, P, eg->N, round, m, signature);
+	}
+	round[0] = -1;
+	transport->broadcast(transport, round, 1);
+	for(k=0; k<K; k++) waitpid(workers[k], NULL, 0);	// already reaped if it died.
+	transport->workers = NULL;
+
+	int nfibers = -1;
+	if(status)
+	{
+		*fiber = (int*)malloc((eg->N>0 ? eg->N : 1)*sizeof(int));
+		nfibers = EXTERNAL_FIBERS(P, eg, *fiber, nsolitaire);
+	}
+	else printf("ERROR in the distributed refinement");
+	free(round);
+	free(signature);
+	free(workers);
+	FreeExternalPartition(P);
+	FreeExternalGraph(eg);
+	return nfibers;
+}
+
+#endif
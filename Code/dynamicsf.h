@@ -0,0 +1,307 @@
+/*	Gene expression dynamics integrated on the base graph of the fibration. Nodes of the
+	same fiber receive the same typed multiset of inputs from every fiber, so, starting
+	from an initial condition that is constant inside each fiber, their trajectories are
+	identical for all times. Therefore it is enough to integrate one variable per fiber on
+	the quotient graph ('quotientf.h'), with each base edge weighted by its multiplicity,
+	and to copy the value of each fiber to its nodes only when the node trajectories are
+	requested ('LIFT_TRAJECTORY'). The cost is reduced by the compression ratio N/|fibers|.
+
+	Two models are given:
+
+	ODE:	dx_i/dt = basal - gamma*x_i + sum_j m_ij*f_type(x_j), integrated by fourth order
+			Runge-Kutta, with Hill functions f_positive(x) = x^h/(K^h + x^h), f_negative(x) =
+			K^h/(K^h + x^h) and f_dual(x) = 4*f_positive(x)*f_negative(x), which activates at
+			intermediate levels and vanishes at both ends.
+	Boolean: s_i(t+1) = 1 if sum_j m_ij*w_type*s_j(t) > 0 and 0 otherwise, with w = +1 for
+			positive, -1 for negative and 0 for dual regulations (synchronous update). Fibers
+			without inputs keep their state.
+
+	The same integrators run on the full network through 'GRAPH_AS_QUOTIENT', the quotient
+	in which each node is its own fiber, so the lifted fiber trajectories can be checked
+	against the node trajectories ('MAX_DIFFERENCE').
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef DYNAMICSF_H
+#define DYNAMICSF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "structforfiber.h"
+#include "quotientf.h"
+
+struct DynamicsParameters
+{
+	double basal;
+	double gamma;
+	double K;
+	double hill;
+	double dt;
+};
+typedef struct DynamicsParameters DYNPARAMS;
+
+extern DYNPARAMS DEFAULT_DYNPARAMS()
+{
+	DYNPARAMS params;
+	params.basal = 0.1;
+	params.gamma = 1.0;
+	params.K = 0.5;
+	params.hill = 2.0;
+	params.dt = 0.01;
+	return params;
+}
+
+double HILL_REGULATION(double x, int type, DYNPARAMS* params)
+{
+	double xh = pow(x>0.0 ? x : 0.0, params->hill);
+	double Kh = pow(params->K, params->hill);
+	double act = xh/(Kh + xh);
+	switch(type)
+	{
+		case 0: return act;
+		case 1: return 1.0 - act;
+		case 2: return 4.0*act*(1.0 - act);
+	}
+	return 0.0;
+}
+
+/*	Right-hand side of the ODE for all fibers. 'reg' receives the regulation value of
+	each fiber for each type, so that the Hill functions are evaluated once per fiber.	*/
+void QUOTIENT_DERIVATIVE(QUOTIENT* quotient, double* x, double* dx, double* reg, DYNPARAMS* params)
+{
+	int f, j, t;
+	for(f=0; f<quotient->size; f++)
+		for(t=0; t<3; t++) reg[3*f+t] = HILL_REGULATION(x[f], t, params);
+	for(f=0; f<quotient->size; f++)
+	{
+		dx[f] = params->basal - params->gamma*x[f];
+		for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+			if(quotient->in_type[j]>=0) dx[f] += quotient->in_mult[j]*reg[3*quotient->in_adj[j]+quotient->in_type[j]];
+	}
+}
+
+/*	Integrates 'steps' Runge-Kutta steps starting from 'x0' (one value per fiber). The
+	state is recorded every 'record_every' steps, including the initial one, and the
+	returned array stores the records one after the other ('size' values each). The
+	number of records is stored in 'nrecords'.	*/
+extern double* INTEGRATE_QUOTIENT_ODE(QUOTIENT* quotient, double* x0, int steps, int record_every, DYNPARAMS* params, int* nrecords)
+{
+	int s, f;
+	int n = quotient->size;
+	double dt = params->dt;
+	if(record_every<1) record_every = 1;
+	*nrecords = steps/record_every + 1;
+	double* trajectory = (double*)malloc((size_t)(*nrecords)*n*sizeof(double));
+
+	double* x = (double*)malloc(n*sizeof(double));
+	double* tmp = (double*)malloc(n*sizeof(double));
+	double* k1 = (double*)malloc(n*sizeof(double));
+	double* k2 = (double*)malloc(n*sizeof(double));
+	double* k3 = (double*)malloc(n*sizeof(double));
+	double* k4 = (double*)malloc(n*sizeof(double));
+	double* reg = (double*)malloc(3*n*sizeof(double));
+	memcpy(x, x0, n*sizeof(double));
+	memcpy(trajectory, x, n*sizeof(double));
+
+	int record = 1;
+	for(s=1; s<=steps; s++)
+	{
+		QUOTIENT_DERIVATIVE(quotient, x, k1, reg, params);
+		for(f=0; f<n; f++) tmp[f] = x[f] + 0.5*dt*k1[f];
+		QUOTIENT_DERIVATIVE(quotient, tmp, k2, reg, params);
+		for(f=0; f<n; f++) tmp[f] = x[f] + 0.5*dt*k2[f];
+		QUOTIENT_DERIVATIVE(quotient, tmp, k3, reg, params);
+		for(f=0; f<n; f++) tmp[f] = x[f] + dt*k3[f];
+		QUOTIENT_DERIVATIVE(quotient, tmp, k4, reg, params);
+		for(f=0; f<n; f++) x[f] += dt*(k1[f] + 2.0*k2[f] + 2.0*k3[f] + k4[f])/6.0;
+		if(s%record_every==0) memcpy(&trajectory[(size_t)(record++)*n], x, n*sizeof(double));
+	}
+	free(x);
+	free(tmp);
+	free(k1);
+	free(k2);
+	free(k3);
+	free(k4);
+	free(reg);
+	return trajectory;
+}
+
+/*	Synchronous Boolean dynamics for 'steps' steps from 's0' (one state per fiber). The
+	returned array stores the 'steps+1' states one after the other.	*/
+extern int* BOOLEAN_QUOTIENT(QUOTIENT* quotient, int* s0, int steps)
+{
+	int s, f, j, input;
+	int n = quotient->size;
+	int* states = (int*)malloc((size_t)(steps+1)*n*sizeof(int));
+	memcpy(states, s0, n*sizeof(int));
+	for(s=1; s<=steps; s++)
+	{
+		int* old = &states[(size_t)(s-1)*n];
+		int* new = &states[(size_t)s*n];
+		for(f=0; f<n; f++)
+		{
+			if(quotient->in_start[f]==quotient->in_start[f+1]) { new[f] = old[f]; continue; }
+			input = 0;
+			for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+			{
+				if(old[quotient->in_adj[j]]==0) continue;
+				if(quotient->in_type[j]==0) input += quotient->in_mult[j];
+				else if(quotient->in_type[j]==1) input -= quotient->in_mult[j];
+			}
+			new[f] = (input>0);
+		}
+	}
+	return states;
+}
+
+/*	Parameters "basal,gamma,K,hill,dt" given as one word. Returns zero if the word does
+	not hold the five values or the step is not positive.	*/
+extern int PARSE_DYNPARAMS(char* word, DYNPARAMS* params)
+{
+	DYNPARAMS parsed;
+	if(sscanf(word, "%lf,%lf,%lf,%lf,%lf", &parsed.basal, &parsed.gamma, &parsed.K, &parsed.hill, &parsed.dt)!=5) return 0;
+	if(parsed.dt<=0.0) return 0;
+	*params = parsed;
+	return 1;
+}
+
+/*	Initial state of the nodes from a file ("%d\t%lf\n" -> Node ID/ Value). The nodes not
+	in the file start from zero. Returns NULL if the file can not be read or has a node
+	out of range.	*/
+extern double* READ_NODE_STATE(char* filename, int N)
+{
+	int v;
+	double value;
+	FILE* IN = fopen(filename, "r");
+	if(IN==NULL) return NULL;
+	double* state = (double*)calloc((N>0 ? N : 1), sizeof(double));
+	while(fscanf(IN, "%d\t%lf\n", &v, &value)==2)
+	{
+		if(v<0 || v>=N) { free(state); fclose(IN); return NULL; }
+		state[v] = value;
+	}
+	fclose(IN);
+	return state;
+}
+
+/*	Initial condition per fiber from a node initial condition. The value of a fiber is
+	the average over its nodes, which is exact when the nodes are already synchronized.	*/
+extern double* PROJECT_STATE(QUOTIENT* quotient, double* node_state)
+{
+	int v;
+	double* state = (double*)calloc(quotient->size, sizeof(double));
+	for(v=0; v<quotient->num_nodes; v++) state[quotient->fiber[v]] += node_state[v];
+	for(v=0; v<quotient->size; v++) if(quotient->fiber_size[v]>0) state[v] /= quotient->fiber_size[v];
+	return state;
+}
+
+/*	Returns one if 'node_state' is constant inside each fiber, the case in which the fiber
+	dynamics is exact for all times.	*/
+extern int IS_SYNCHRONIZED(QUOTIENT* quotient, double* node_state)
+{
+	int v;
+	int synchronized = 1;
+	double* first = (double*)malloc((quotient->size>0 ? quotient->size : 1)*sizeof(double));
+	char* seen = (char*)calloc((quotient->size>0 ? quotient->size : 1), sizeof(char));
+	for(v=0; synchronized && v<quotient->num_nodes; v++)
+	{
+		int f = quotient->fiber[v];
+		if(seen[f]==0) { seen[f] = 1; first[f] = node_state[v]; }
+		else if(node_state[v]!=first[f]) synchronized = 0;
+	}
+	free(first);
+	free(seen);
+	return synchronized;
+}
+
+/*	Copies the value of each fiber to its nodes for all the 'nrecords' records. */
+extern double* LIFT_TRAJECTORY(QUOTIENT* quotient, double* trajectory, int nrecords)
+{
+	int r, v;
+	int N = quotient->num_nodes;
+	double* lifted = (double*)malloc((size_t)nrecords*N*sizeof(double));
+	for(r=0; r<nrecords; r++)
+		for(v=0; v<N; v++) lifted[(size_t)r*N+v] = trajectory[(size_t)r*quotient->size + quotient->fiber[v]];
+	return lifted;
+}
+
+extern int* LIFT_BOOLEAN(QUOTIENT* quotient, int* states, int nrecords)
+{
+	int r, v;
+	int N = quotient->num_nodes;
+	int* lifted = (int*)malloc((size_t)nrecords*N*sizeof(int));
+	for(r=0; r<nrecords; r++)
+		for(v=0; v<N; v++) lifted[(size_t)r*N+v] = states[(size_t)r*quotient->size + quotient->fiber[v]];
+	return lifted;
+}
+
+/*	Quotient in which each node of 'graph' is its own fiber, with the edges of the graph
+	(multiplicity one), to integrate the dynamics on the full network.	*/
+extern QUOTIENT* GRAPH_AS_QUOTIENT(Graph* graph)
+{
+	int v, j;
+	int N = graph->size;
+	int nE = graph->in_start[N];
+	QUOTIENT* quotient = (QUOTIENT*)malloc(sizeof(QUOTIENT));
+	quotient->size = N;
+	quotient->num_nodes = N;
+	quotient->num_edges = nE;
+	quotient->fiber = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	quotient->fiber_size = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	quotient->in_start = (int*)malloc((N+1)*sizeof(int));
+	quotient->in_adj = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	quotient->in_type = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	quotient->in_mult = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	for(v=0; v<N; v++) { quotient->fiber[v] = v; quotient->fiber_size[v] = 1; }
+	memcpy(quotient->in_start, graph->in_start, (N+1)*sizeof(int));
+	memcpy(quotient->in_adj, graph->in_adj, nE*sizeof(int));
+	memcpy(quotient->in_type, graph->in_type, nE*sizeof(int));
+	for(j=0; j<nE; j++) quotient->in_mult[j] = 1;
+	return quotient;
+}
+
+/*	Largest absolute difference between two arrays of 'n' values. */
+extern double MAX_DIFFERENCE(double* a, double* b, size_t n)
+{
+	size_t k;
+	double diff = 0.0;
+	for(k=0; k<n; k++) if(fabs(a[k]-b[k])>diff) diff = fabs(a[k]-b[k]);
+	return diff;
+}
+
+/*	Writes one line per record: the time followed by the 'ncolumns' values of the record
+	(one per fiber, or one per node for a lifted trajectory).	*/
+extern void WRITE_TRAJECTORY(double* trajectory, int nrecords, int ncolumns, double dt, char* filename)
+{
+	int r, v;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	for(r=0; r<nrecords; r++)
+	{
+		fprintf(OUT, "%lf", r*dt);
+		for(v=0; v<ncolumns; v++) fprintf(OUT, "\t%lf", trajectory[(size_t)r*ncolumns + v]);
+		fprintf(OUT, "\n");
+	}
+	fclose(OUT);
+}
+
+extern void WRITE_BOOLEAN(int* states, int nrecords, int ncolumns, char* filename)
+{
+	int r, v;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	for(r=0; r<nrecords; r++)
+	{
+		fprintf(OUT, "%d", r);
+		for(v=0; v<ncolumns; v++) fprintf(OUT, "\t%d", states[(size_t)r*ncolumns + v]);
+		fprintf(OUT, "\n");
+	}
+	fclose(OUT);
+}
+
+#endif
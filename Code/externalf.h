@@ -0,0 +1,602 @@
+/*	Out-of-core refinement for networks whose edges do not fit in memory. Only O(N)
+	arrays are kept resident (the partition, the counters of the splitting step and the
+	row offsets of the edges), while the edges themselves stay on disk.
+
+	'EXTERNAL_GRAPH' streams the edgelist file once, converting it to a binary temporary
+	file and collecting the degrees, the nodes without inputs and the weakly connected
+	components (union-find of 'componentsf.h'). The edges are then written to disk as the
+	outgoing CSR of the network, with the sources in the order of the initial blocks of
+	'PREPROCESSING' (node 'order[p]' is at position 'p'), so the edges of each block form
+	one contiguous run of the files. The CSR is built in passes over the temporary file,
+	each pass filling the rows that fit in the memory budget. Targets (int) and types
+	(char) are kept in two files, memory-mapped for the refinement and unlinked at once,
+	so nothing is left on disk.
+
+	'EXTERNAL_REFINEMENT' gives the same coarsest partition of 'REFINEMENT', but the blocks
+	are contiguous ranges of one array of nodes, as in the partition refinement of Paige
+	and Tarjan (1987), instead of linked lists. For each splitter block, the outgoing
+	edges of its nodes are streamed from the mapped files, counting for each target the
+	edges of each type coming from the splitter. The touched nodes are moved to the end
+	of their blocks, sorted by their counts and the blocks are split into the resulting
+	ranges. When the splitting block was already waiting in the queue, all the new blocks
+	enter the queue, otherwise all except the largest one. The pages read from the mapped
+	files are released whenever they exceed the memory budget.
+
+	The counts of each type are stored by position in the array of nodes, not by node, and
+	are moved with the nodes, so the touched nodes of a block and their counts are both
+	contiguous ranges. A block is only sorted when these ranges are not uniform, which is
+	tested with the vectorized kernel of 'vectorf.h': most touched blocks receive the same
+	counts in all their touched nodes, and are split (or kept) without any sorting.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef EXTERNALF_H
+#define EXTERNALF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "utilsforfiber.h"
+#include "componentsf.h"
+#include "vectorf.h"
+
+#define EXTERNAL_DEFAULT_BUDGET (256LL << 20)
+#define EXTERNAL_STREAM_EDGES 65536
+
+struct ExternalGraph
+{
+	int N;
+	long long nE;
+	long long budget;		// bytes for the edge buffers and the mapped pages.
+	long long* out_start;	// edges of position 'p' are 'out_start[p]' to 'out_start[p+1]-1'.
+	int* order;				// node at each position of the CSR.
+	int* position;			// position of each node in the CSR.
+	char* inputs;			// 0 no inputs, 1 only self-loops, 2 inputs from other nodes.
+	int* psite;				// weakly connected components (see 'componentsf.h').
+	int* targets;			// mapped files.
+	signed char* types;
+	long long touched;		// bytes read from the mapped files since their last release.
+};
+typedef struct ExternalGraph EXTGRAPH;
+
+struct ExternalEdge
+{
+	int source;
+	int target;
+	int type;
+};
+typedef struct ExternalEdge EXTEDGE;
+
+/*	Grows the per-node arrays of the first pass to hold node 'node'. */
+void EXTERNAL_GROW(EXTGRAPH* eg, int node, int* capacity, long long** outdeg)
+{
+	int v;
+	int old = *capacity;
+	if(node<old) return;
+	while(node>=*capacity) *capacity = 2*(*capacity);
+	*outdeg = (long long*)realloc(*outdeg, (*capacity)*sizeof(long long));
+	eg->inputs = (char*)realloc(eg->inputs, (*capacity)*sizeof(char));
+	eg->psite = (int*)realloc(eg->psite, (*capacity)*sizeof(int));
+	for(v=old; v<*capacity; v++) { (*outdeg)[v] = 0; eg->inputs[v] = 0; eg->psite[v] = -1; }
+}
+
+/*	Creates one file in 'workdir' of 'size' bytes and returns its descriptor. The file is
+	unlinked at once, so it only lives while it is opened or mapped.	*/
+int EXTERNAL_FILE(char* workdir, long long size)
+{
+	char name[512];
+	snprintf(name, 512, "%s/fiberXXXXXX", workdir);
+	int fd = mkstemp(name);
+	if(fd<0) return -1;
+	unlink(name);
+	if(size>0 && ftruncate(fd, size)!=0) { close(fd); return -1; }
+	return fd;
+}
+
+/*	Maps 'size' bytes of 'fd' for reading. */
+void* EXTERNAL_MAP(int fd, long long size)
+{
+	if(size==0) return NULL;
+	void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	return (map==MAP_FAILED) ? NULL : map;
+}
+
+extern void FreeExternalGraph(EXTGRAPH* eg)
+{
+	if(eg->targets!=NULL) munmap(eg->targets, eg->nE*sizeof(int));
+	if(eg->types!=NULL) munmap(eg->types, eg->nE*sizeof(signed char));
+	free(eg->out_start);
+	free(eg->order);
+	free(eg->position);
+	free(eg->inputs);
+	free(eg->psite);
+	free(eg);
+}
+
+/*	First pass over the edgelist ("%d\t%d\t%s\n" as in 'defineNetwork'): number of nodes
+	and edges, nodes without inputs, weakly connected components and the positions of the
+	nodes in the order of the initial blocks of 'PREPROCESSING' (the nodes with inputs
+	grouped by their components, followed by the nodes without inputs). The edges are
+	copied to 'TEMP' in binary and the out-degrees returned in '*outdeg', when given.	*/
+extern EXTGRAPH* EXTERNAL_SCAN(FILE* EDGE_FILE, FILE* TEMP, long long** outdeg)
+{
+	int i, j, root1, root2;
+	char type[20];
+	EXTGRAPH* eg = (EXTGRAPH*)calloc(1, sizeof(EXTGRAPH));
+	int capacity = 1024;
+	long long* degree = (long long*)calloc(capacity, sizeof(long long));
+	eg->inputs = (char*)calloc(capacity, sizeof(char));
+	eg->psite = (int*)malloc(capacity*sizeof(int));
+	for(i=0; i<capacity; i++) eg->psite[i] = -1;
+
+	int max = -1;
+	EXTEDGE edge;
+	while(fscanf(EDGE_FILE, "%d\t%d\t%s\n", &i, &j, type)==3)
+	{
+		if(i<0 || j<0) continue;
+		if(i>max) max = i;
+		if(j>max) max = j;
+		EXTERNAL_GROW(eg, max, &capacity, &degree);
+		if(TEMP!=NULL)
+		{
+			edge.source = i;
+			edge.target = j;
+			edge.type = REGULATION_TYPE(type);
+			fwrite(&edge, sizeof(EXTEDGE), 1, TEMP);
+		}
+		degree[i]++;
+		if(i!=j) eg->inputs[j] = 2;
+		else if(eg->inputs[j]==0) eg->inputs[j] = 1;
+		root1 = findroot(i, eg->psite);
+		root2 = findroot(j, eg->psite);
+		merge(root1, root2, eg->psite);
+		eg->nE++;
+	}
+	int N = max + 1;
+	eg->N = N;
+
+	eg->order = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	eg->position = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	int* start = (int*)calloc(N+1, sizeof(int));
+	int nnull = 0;
+	for(i=0; i<N; i++)
+	{
+		if(eg->inputs[i]==0) nnull++;
+		else start[findroot(i, eg->psite)+1]++;
+	}
+	for(i=0; i<N; i++) start[i+1] += start[i];
+	int fill_null = N - nnull;
+	for(i=0; i<N; i++)
+	{
+		if(eg->inputs[i]==0) eg->position[i] = fill_null++;
+		else eg->position[i] = start[findroot(i, eg->psite)]++;
+		eg->order[eg->position[i]] = i;
+	}
+	free(start);
+	if(outdeg!=NULL) *outdeg = degree;
+	else free(degree);
+	return eg;
+}
+
+/*	Reads the edgelist 'filename' and writes its CSR to disk in 'workdir', using at most
+	'budget' bytes for the edge buffers. Returns NULL if the files can not be read or
+	written, or if no edge can be read from the edgelist.	*/
+extern EXTGRAPH* EXTERNAL_GRAPH(char* filename, char* workdir, long long budget)
+{
+	int i;
+	long long e, k;
+	FILE* EDGE_FILE = fopen(filename, "r");
+	if(EDGE_FILE==NULL) { printf("ERROR in file reading"); return NULL; }
+	int tmp = EXTERNAL_FILE(workdir, 0);
+	FILE* TEMP = (tmp>=0) ? fdopen(tmp, "w+b") : NULL;
+	if(TEMP==NULL) { printf("ERROR in file writing"); fclose(EDGE_FILE); return NULL; }
+
+	long long* outdeg;
+	EXTGRAPH* eg = EXTERNAL_SCAN(EDGE_FILE, TEMP, &outdeg);
+	eg->budget = (budget>0) ? budget : EXTERNAL_DEFAULT_BUDGET;
+	fclose(EDGE_FILE);
+	if(eg->nE==0)
+	{
+		printf("ERROR: no edge could be read from %s\n", filename);
+		free(outdeg);
+		fclose(TEMP);
+		FreeExternalGraph(eg);
+		return NULL;
+	}
+	fflush(TEMP);
+	int N = eg->N;
+	eg->out_start = (long long*)malloc((N+1)*sizeof(long long));
+	eg->out_start[0] = 0;
+	for(i=0; i<N; i++) eg->out_start[i+1] = eg->out_start[i] + outdeg[eg->order[i]];
+
+	/////////////////// NEXT PASSES: ROWS OF THE CSR WITHIN THE BUDGET //////////////////
+	int fd_targets = EXTERNAL_FILE(workdir, eg->nE*sizeof(int));
+	int fd_types = EXTERNAL_FILE(workdir, eg->nE*sizeof(signed char));
+	long long chunk_edges = eg->budget/(sizeof(int) + sizeof(signed char) + sizeof(EXTEDGE));
+	if(chunk_edges<1) chunk_edges = 1;
+	long long* cursor = outdeg;		// reused as the fill position of each row.
+	EXTEDGE* stream = (EXTEDGE*)malloc(EXTERNAL_STREAM_EDGES*sizeof(EXTEDGE));
+	int* chunk_targets = NULL;
+	signed char* chunk_types = NULL;
+	int status = (fd_targets>=0 && fd_types>=0);
+	int p0 = 0;
+	while(status && p0<N)
+	{
+		// Positions [p0, p1) whose rows fit in the budget (at least one row).
+		int p1 = p0 + 1;
+		while(p1<N && eg->out_start[p1+1] - eg->out_start[p0]<=chunk_edges) p1++;
+		long long first = eg->out_start[p0];
+		long long nchunk = eg->out_start[p1] - first;
+		chunk_targets = (int*)realloc(chunk_targets, (nchunk>0 ? nchunk : 1)*sizeof(int));
+		chunk_types = (signed char*)realloc(chunk_types, (nchunk>0 ? nchunk : 1)*sizeof(signed char));
+		for(i=p0; i<p1; i++) cursor[i] = eg->out_start[i] - first;
+
+		rewind(TEMP);
+		size_t nread;
+		while((nread = fread(stream, sizeof(EXTEDGE), EXTERNAL_STREAM_EDGES, TEMP))>0)
+		{
+			for(k=0; k<(long long)nread; k++)
+			{
+				int p = eg->position[stream[k].source];
+				if(p<p0 || p>=p1) continue;
+				e = cursor[p]++;
+				chunk_targets[e] = stream[k].target;
+				chunk_types[e] = (signed char)stream[k].type;
+			}
+		}
+		if(pwrite(fd_targets, chunk_targets, nchunk*sizeof(int), first*sizeof(int))!=(ssize_t)(nchunk*sizeof(int))) status = 0;
+		if(pwrite(fd_types, chunk_types, nchunk*sizeof(signed char), first*sizeof(signed char))!=(ssize_t)(nchunk*sizeof(signed char))) status = 0;
+		p0 = p1;
+	}
+	free(chunk_targets);
+	free(chunk_types);
+	free(stream);
+	free(outdeg);
+	fclose(TEMP);
+
+	if(status && eg->nE>0)
+	{
+		eg->targets = (int*)EXTERNAL_MAP(fd_targets, eg->nE*sizeof(int));
+		eg->types = (signed char*)EXTERNAL_MAP(fd_types, eg->nE*sizeof(signed char));
+		if(eg->targets==NULL || eg->types==NULL) status = 0;
+	}
+	if(fd_targets>=0) close(fd_targets);
+	if(fd_types>=0) close(fd_types);
+	if(status==0)
+	{
+		printf("ERROR in file writing");
+		FreeExternalGraph(eg);
+		return NULL;
+	}
+	return eg;
+}
+
+/*	Releases the pages of the mapped files once the pages read since the last release
+	exceed the budget. The pages are read again from disk when needed.	*/
+void EXTERNAL_RELEASE(EXTGRAPH* eg, long long bytes)
+{
+	eg->touched += bytes;
+	if(eg->touched<=eg->budget) return;
+	if(eg->targets!=NULL) madvise(eg->targets, eg->nE*sizeof(int), MADV_DONTNEED);
+	if(eg->types!=NULL) madvise(eg->types, eg->nE*sizeof(signed char), MADV_DONTNEED);
+	eg->touched = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+/////////////////////// ARRAY-BASED PARTITION ////////////////////////
+
+struct ExternalPartition
+{
+	int* elements;		// nodes, each block being a contiguous range.
+	int* location;		// index of each node in 'elements'.
+	int* block_of;
+	int* first;			// range of each block: 'first[b]' to 'last[b]-1'.
+	int* last;
+	int* marked;		// number of touched nodes of each block (kept at its end).
+	int nblocks;
+	int* queue;			// circular queue of splitter blocks.
+	char* in_queue;
+	int qhead;
+	int qsize;
+	int* count[3];		// edges of each type from the splitter, by position in 'elements'.
+	int* touched;
+	int ntouched;
+	int* split;			// blocks with touched nodes.
+	int nsplit;
+	int* sorted;		// buffer for the touched nodes of one block.
+};
+typedef struct ExternalPartition EXTPART;
+
+void EXTERNAL_ENQUEUE(EXTPART* P, int N, int b)
+{
+	if(P->in_queue[b]) return;
+	P->queue[(P->qhead + P->qsize)%N] = b;
+	P->qsize++;
+	P->in_queue[b] = 1;
+}
+
+int EXTERNAL_DEQUEUE(EXTPART* P, int N)
+{
+	int b = P->queue[P->qhead];
+	P->qhead = (P->qhead + 1)%N;
+	P->qsize--;
+	P->in_queue[b] = 0;
+	return b;
+}
+
+/*	Counts the edges coming from node 's' into its targets. */
+void EXTERNAL_COUNT(EXTGRAPH* eg, EXTPART* P, int s)
+{
+	long long e;
+	int t, type;
+	int p = eg->position[s];
+	for(e=eg->out_start[p]; e<eg->out_start[p+1]; e++)
+	{
+		type = eg->types[e];
+		if(type<0 || type>2) continue;
+		t = eg->targets[e];
+		int q = P->location[t];
+		if(P->count[0][q]==0 && P->count[1][q]==0 && P->count[2][q]==0) P->touched[P->ntouched++] = t;
+		P->count[type][q]++;
+	}
+	EXTERNAL_RELEASE(eg, (eg->out_start[p+1] - eg->out_start[p])*(sizeof(int) + sizeof(signed char)));
+}
+
+/*	Compares two nodes by the counts they received, with the partition 'P' as context. */
+int cmp_external(int a, int b, void* context)
+{
+	EXTPART* P = (EXTPART*)context;
+	int u = P->location[a];
+	int v = P->location[b];
+	int t;
+	for(t=0; t<3; t++)
+		if(P->count[t][u]!=P->count[t][v]) return (P->count[t][u]<P->count[t][v]) ? -1 : 1;
+	return 0;
+}
+
+/*	Whether the nodes at the positions 'begin' to 'end-1' received the same counts. */
+int uniform_external(EXTPART* P, int begin, int end)
+{
+	return UNIFORM_RANGE(P->count[0]+begin, end-begin) && UNIFORM_RANGE(P->count[1]+begin, end-begin)
+		&& UNIFORM_RANGE(P->count[2]+begin, end-begin);
+}
+
+/*	Clears the counts of the touched nodes. After a split the counts are no longer at the
+	positions of their nodes, but they stay in the ranges of the touched nodes.	*/
+void EXTERNAL_CLEAR(EXTPART* P)
+{
+	int k, q;
+	for(k=0; k<P->ntouched; k++)
+	{
+		q = P->location[P->touched[k]];
+		P->count[0][q] = 0;
+		P->count[1][q] = 0;
+		P->count[2][q] = 0;
+	}
+	P->ntouched = 0;
+}
+
+/*	Splits the blocks of the touched nodes, grouping the touched nodes of each block by
+	'compare' (a comparison of two nodes for 'SORT_INDICES', given 'context'), and enqueues
+	the new blocks. When given, 'uniform' tells whether all the nodes of a range of positions
+	are equivalent, so the touched nodes of that block need no sorting.	*/
+void EXTERNAL_SPLIT(EXTPART* P, int N, int (*compare)(int, int, void*), void* context, int (*uniform)(EXTPART*, int, int))
+{
+	int k, b, i, t;
+	P->nsplit = 0;
+	for(k=0; k<P->ntouched; k++)
+	{
+		int v = P->touched[k];
+		b = P->block_of[v];
+		if(P->marked[b]==0) P->split[P->nsplit++] = b;
+		// Moves 'v' (and its counts) to the end of its block, before the nodes already touched.
+		int dest = P->last[b] - 1 - P->marked[b];
+		int from = P->location[v];
+		int u = P->elements[dest];
+		P->elements[dest] = v;
+		P->elements[from] = u;
+		P->location[u] = from;
+		P->location[v] = dest;
+		for(t=0; t<3; t++)
+		{
+			int c = P->count[t][dest];
+			P->count[t][dest] = P->count[t][from];
+			P->count[t][from] = c;
+		}
+		P->marked[b]++;
+	}
+
+	for(k=0; k<P->nsplit; k++)
+	{
+		b = P->split[k];
+		int size = P->last[b] - P->first[b];
+		int nmarked = P->marked[b];
+		int begin = P->last[b] - nmarked;
+		int end = P->last[b];
+		P->marked[b] = 0;
+		int same = (uniform!=NULL && uniform(P, begin, end));
+		if(same && nmarked==size) continue;
+		memcpy(P->sorted, P->elements + begin, nmarked*sizeof(int));
+		if(same==0)
+		{
+			SORT_INDICES(P->sorted, nmarked, compare, context);
+			if(nmarked==size && compare(P->sorted[0], P->sorted[nmarked-1], context)==0) continue;
+		}
+
+		/*	Pieces: the untouched nodes (if any) keep the block 'b', each group of
+			touched nodes with the same counts becomes a new block. The groups are taken
+			from 'sorted' before the nodes are moved, while the counts are still at the
+			positions of their nodes.	*/
+		int was_queued = P->in_queue[b];
+		int largest = b;
+		int largest_size = begin - P->first[b];
+		int piece = 0;
+		if(begin==P->first[b])
+		{
+			// Every node was touched: the first group keeps the block 'b'.
+			while(piece<nmarked && compare(P->sorted[piece], P->sorted[0], context)==0) piece++;
+			largest_size = piece;
+		}
+		P->last[b] = begin + piece;
+		while(piece<nmarked)
+		{
+			int next = piece + 1;
+			if(same) next = nmarked;
+			while(next<nmarked && compare(P->sorted[next], P->sorted[piece], context)==0) next++;
+			int nb = P->nblocks++;
+			P->first[nb] = begin + piece;
+			P->last[nb] = begin + next;
+			P->marked[nb] = 0;
+			P->in_queue[nb] = 0;
+			for(i=piece; i<next; i++) P->block_of[P->sorted[i]] = nb;
+			if(was_queued) EXTERNAL_ENQUEUE(P, N, nb);
+			else if(next - piece>largest_size)
+			{
+				EXTERNAL_ENQUEUE(P, N, largest);
+				largest = nb;
+				largest_size = next - piece;
+			}
+			else EXTERNAL_ENQUEUE(P, N, nb);
+			piece = next;
+		}
+		if(same) continue;
+		for(i=0; i<nmarked; i++)
+		{
+			P->elements[begin+i] = P->sorted[i];
+			P->location[P->sorted[i]] = begin+i;
+		}
+	}
+}
+
+/*	Initial partition in the order of the CSR: one block for each component (nodes with
+	inputs) and one for each node without inputs, all of them in the queue.	*/
+extern EXTPART* CreateExternalPartition(EXTGRAPH* eg)
+{
+	int p, b, t;
+	int N = eg->N;
+	int size = (N>0) ? N : 1;
+	EXTPART* P = (EXTPART*)malloc(sizeof(EXTPART));
+	SELECT_VECTOR_KERNELS();
+	P->elements = (int*)malloc(size*sizeof(int));
+	P->location = (int*)malloc(size*sizeof(int));
+	P->block_of = (int*)malloc(size*sizeof(int));
+	P->first = (int*)malloc(size*sizeof(int));
+	P->last = (int*)malloc(size*sizeof(int));
+	P->marked = (int*)calloc(size, sizeof(int));
+	P->queue = (int*)malloc(size*sizeof(int));
+	P->in_queue = (char*)calloc(size, sizeof(char));
+	for(t=0; t<3; t++) P->count[t] = (int*)calloc(size, sizeof(int));
+	P->touched = (int*)malloc(size*sizeof(int));
+	P->split = (int*)malloc(size*sizeof(int));
+	P->sorted = (int*)malloc(size*sizeof(int));
+	P->nblocks = 0;
+	P->qhead = 0;
+	P->qsize = 0;
+	P->ntouched = 0;
+	for(p=0; p<N; p++)
+	{
+		int v = eg->order[p];
+		P->elements[p] = v;
+		P->location[v] = p;
+		int new_block = (p==0) || eg->inputs[v]==0 || eg->inputs[eg->order[p-1]]==0
+			|| findroot(v, eg->psite)!=findroot(eg->order[p-1], eg->psite);
+		if(new_block)
+		{
+			b = P->nblocks++;
+			P->first[b] = p;
+			EXTERNAL_ENQUEUE(P, N, b);
+		}
+		P->block_of[v] = P->nblocks - 1;
+		P->last[P->nblocks-1] = p + 1;
+	}
+	return P;
+}
+
+extern void FreeExternalPartition(EXTPART* P)
+{
+	int t;
+	free(P->elements);
+	free(P->location);
+	free(P->block_of);
+	free(P->first);
+	free(P->last);
+	free(P->marked);
+	free(P->queue);
+	free(P->in_queue);
+	for(t=0; t<3; t++) free(P->count[t]);
+	free(P->touched);
+	free(P->split);
+	free(P->sorted);
+	free(P);
+}
+
+/*	Writes the fiber of each node in 'fiber' and returns the number of fibers: first the
+	fibers of the nodes with inputs, numbered by their smallest node, then one fiber for
+	each node without inputs (solitaire), whose number is returned in 'nsolitaire'.	*/
+extern int EXTERNAL_FIBERS(EXTPART* P, EXTGRAPH* eg, int* fiber, int* nsolitaire)
+{
+	int i, b;
+	int nfibers = 0;
+	// 'marked' is reused as the fiber of each block.
+	for(b=0; b<P->nblocks; b++) P->marked[b] = -1;
+	for(i=0; i<eg->N; i++)
+	{
+		if(eg->inputs[i]==0) continue;
+		b = P->block_of[i];
+		if(P->marked[b]<0) P->marked[b] = nfibers++;
+		fiber[i] = P->marked[b];
+	}
+	for(b=0; b<P->nblocks; b++) P->marked[b] = 0;
+	*nsolitaire = 0;
+	for(i=0; i<eg->N; i++)
+		if(eg->inputs[i]==0) { fiber[i] = nfibers++; (*nsolitaire)++; }
+	return nfibers;
+}
+
+/*	Coarsest refinement of the network 'eg', with the fibers given as in
+	'EXTERNAL_FIBERS'.	*/
+extern int EXTERNAL_REFINEMENT(EXTGRAPH* eg, int* fiber, int* nsolitaire)
+{
+	int i, p, b;
+	int N = eg->N;
+	if(N==0) { *nsolitaire = 0; return 0; }
+	EXTPART* P = CreateExternalPartition(eg);
+
+	// The nodes with self-loops as only inputs are also splitters by themselves.
+	for(i=0; i<N; i++)
+	{
+		if(eg->inputs[i]!=1) continue;
+		EXTERNAL_COUNT(eg, P, i);
+		EXTERNAL_SPLIT(P, N, cmp_external, P, uniform_external);
+		EXTERNAL_CLEAR(P);
+	}
+	while(P->qsize>0)
+	{
+		b = EXTERNAL_DEQUEUE(P, N);
+		int end = P->last[b];
+		for(p=P->first[b]; p<end; p++) EXTERNAL_COUNT(eg, P, P->elements[p]);
+		EXTERNAL_SPLIT(P, N, cmp_external, P, uniform_external);
+		EXTERNAL_CLEAR(P);
+	}
+	int nfibers = EXTERNAL_FIBERS(P, eg, fiber, nsolitaire);
+	FreeExternalPartition(P);
+	return nfibers;
+}
+
+/*	Writes the fiber of each node ("%d\t%d\n" -> Node ID/ Fiber). */
+extern void WRITE_NODE_FIBERS(char* filename, int* fiber, int N)
+{
+	int i;
+	FILE* FIBERS = fopen(filename, "w");
+	if(FIBERS==NULL) { printf("ERROR in file writing"); return; }
+	for(i=0; i<N; i++) fprintf(FIBERS, "%d\t%d\n", i, fiber[i]);
+	fclose(FIBERS);
+}
+
+#endif
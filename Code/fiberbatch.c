@@ -0,0 +1,301 @@
+/*	Batch runner for many networks in one process. The networks are listed in a manifest
+	file, one per line:
+
+		file PATH				edgelist file as in 'main.c' ("%d\t%d\t%s\n").
+		labels PATH				edgelist file given by node labels (see 'labelsf.h').
+		erdos N c T K [SEED]	K directed Erdos-Renyi networks with N nodes, mean degree c
+								and T edge types (see 'randomnetf.h'), e.g. the samples of
+								'Scripts/res1_time_perf.sh'.
+
+	Empty lines and lines starting with '#' are skipped. Every network is one job, and
+	the jobs are taken by a pool of threads from the largest to the smallest one (by the
+	expected number of edges), so the large networks start first. Each thread keeps one
+	engine ('fiberlib.h') for all its jobs, and one edge buffer for the generated networks,
+	grown to the largest of them. Only that buffer is reused: loading a network into the
+	engine frees the graph, the partition and the scratch arrays of the previous job and
+	allocates them again for the new one.
+
+	Usage:	./fiberbatch MANIFEST OUTPUT [-t K] [-dag] [-reduce] [-classify]
+
+	with K the number of threads (K = 0 uses all the cores). The results are written to
+	OUTPUT as one table, one line per job in the order of the manifest:
+
+		job	source	sample	N	E	fibers	nontrivial	nodes_nontrivial	load_s	refine_s	classify_s	status
+
+	where 'nontrivial' counts the fibers with more than one node and 'nodes_nontrivial'
+	the nodes inside them. 'status' is "ok", or the stage that failed ("load", "refine" or
+	"classify") followed by the error of 'FIBER_ERROR_NAME'; the results of a failed job
+	are -1 from that stage on (N = -1 if its network can not be loaded). The exit status
+	is nonzero if any job failed.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "fiberlib.h"
+#include "randomnetf.h"
+#include "clockf.h"
+
+#define MANIFEST_LINE_SIZE 4096
+
+struct BatchJob
+{
+	int kind;			// 0 edgelist file, 1 labeled edgelist file, 2 Erdos-Renyi network.
+	char* source;		// file path or generator description.
+	int sample;
+	int N;
+	double c;
+	int ntypes;
+	unsigned long long seed;
+	double cost;		// expected number of edges, used to order the jobs.
+
+	// Results.
+	int size;
+	int num_edges;
+	int nfibers;
+	int nontrivial;
+	int nodes_nontrivial;
+	double load_time;
+	double refine_time;
+	double classify_time;
+	const char* failed_stage;	// NULL for a job without errors.
+	int error;
+};
+typedef struct BatchJob BATCHJOB;
+
+struct BatchTask
+{
+	BATCHJOB* jobs;
+	int* order;			// jobs from the largest to the smallest one.
+	int njobs;
+	int next;			// next position of 'order' (shared counter).
+	FIBEROPTIONS options;
+	int classify;
+};
+typedef struct BatchTask BATCHTASK;
+
+/*	Adds the jobs of one manifest line. Returns zero for a malformed line. */
+int PARSE_MANIFEST_LINE(char* line, BATCHJOB** jobs, int* njobs, int* capacity)
+{
+	int k, N, ntypes, samples;
+	double c;
+	unsigned long long seed = DEFAULT_SEED;
+	char kind[32];
+	char path[MANIFEST_LINE_SIZE];
+	struct stat info;
+
+	if(sscanf(line, "%31s", kind)!=1 || kind[0]=='#') return 1;
+	int nfields = 0;
+	if(strcmp(kind, "erdos")==0)
+	{
+		nfields = sscanf(line, "%*s %d %lf %d %d %llu", &N, &c, &ntypes, &samples, &seed);
+		if(nfields<4 || N<2 || samples<1) return 0;
+	}
+	else if(strcmp(kind, "file")==0 || strcmp(kind, "labels")==0)
+	{
+		if(sscanf(line, "%*s %4095s", path)!=1) return 0;
+		samples = 1;
+	}
+	else return 0;
+
+	for(k=0; k<samples; k++)
+	{
+		if(*njobs==*capacity)
+		{
+			*capacity = 2*(*capacity);
+			*jobs = (BATCHJOB*)realloc(*jobs, (*capacity)*sizeof(BATCHJOB));
+		}
+		BATCHJOB* job = &((*jobs)[(*njobs)++]);
+		memset(job, 0, sizeof(BATCHJOB));
+		job->sample = k;
+		if(kind[0]=='e')
+		{
+			job->kind = 2;
+			job->N = N;
+			job->c = c;
+			job->ntypes = ntypes;
+			// Each sample has its own sequence, independent of the thread running it.
+			job->seed = seed + 0x9E3779B97F4A7C15ULL*(unsigned long long)k;
+			job->cost = (double)N*(c + 1.0);
+			job->source = (char*)malloc(64);
+			snprintf(job->source, 64, "erdos:%d:%g:%d", N, c, ntypes);
+		}
+		else
+		{
+			job->kind = (kind[0]=='l') ? 1 : 0;
+			job->cost = (stat(path, &info)==0) ? (double)info.st_size/16.0 : 0.0;
+			job->source = (char*)malloc(strlen(path)+1);
+			strcpy(job->source, path);
+		}
+	}
+	return 1;
+}
+
+/*	Orders (cost, job) pairs by decreasing cost, and by job for equal costs. */
+int cmp_jobcost(const void* a, const void* b)
+{
+	double x = ((double*)a)[0];
+	double y = ((double*)b)[0];
+	if(x>y) return -1;
+	else if(x<y) return 1;
+	return (((double*)a)[1]<((double*)b)[1]) ? -1 : 1;
+}
+
+void* BATCH_WORKER(void* arg)
+{
+	int i, f, status;
+	double t0;
+	BATCHTASK* task = (BATCHTASK*)arg;
+	FIBERENGINE* engine = FIBER_CREATE();
+	int* pairs = NULL;
+	int* types = NULL;
+	int capacity = 0;
+
+	while((i = __atomic_fetch_add(&(task->next), 1, __ATOMIC_RELAXED)) < task->njobs)
+	{
+		BATCHJOB* job = &(task->jobs[task->order[i]]);
+		t0 = WALL_TIME();
+		if(job->kind==2)
+		{
+			RNGSTATE state = job->seed;
+			int nE = ERDOS_RENYI_EDGES(job->N, job->c, job->ntypes, &state, &pairs, &types, &capacity);
+			status = FIBER_LOAD_EDGES(engine, pairs, types, nE, job->N, 1);
+		}
+		else status = FIBER_LOAD_FILE(engine, job->source, NULL, job->kind, 1);
+		job->load_time = WALL_TIME() - t0;
+		if(status!=FIBER_OK)
+		{
+			job->size = job->num_edges = job->nfibers = job->nontrivial = job->nodes_nontrivial = -1;
+			job->failed_stage = "load";
+			job->error = status;
+			continue;
+		}
+		job->size = FIBER_NUM_NODES(engine);
+		job->num_edges = FIBER_NUM_EDGES(engine);
+
+		t0 = WALL_TIME();
+		status = FIBER_REFINE(engine, &(task->options));
+		job->refine_time = WALL_TIME() - t0;
+		if(status!=FIBER_OK)
+		{
+			job->nfibers = job->nontrivial = job->nodes_nontrivial = -1;
+			job->failed_stage = "refine";
+			job->error = status;
+			continue;
+		}
+		if(task->classify==1)
+		{
+			t0 = WALL_TIME();
+			status = FIBER_CLASSIFY(engine);
+			job->classify_time = WALL_TIME() - t0;
+			if(status!=FIBER_OK) { job->failed_stage = "classify"; job->error = status; }
+		}
+
+		job->nfibers = FIBER_NUM_FIBERS(engine);
+		for(f=0; f<job->nfibers; f++)
+		{
+			int size = FIBER_FIBER_SIZE(engine, f);
+			if(size>1) { job->nontrivial++; job->nodes_nontrivial += size; }
+		}
+	}
+	FIBER_FREE(engine);
+	free(pairs);
+	free(types);
+	return NULL;
+}
+
+void USAGE(char* program)
+{
+	printf("Usage: %s MANIFEST OUTPUT [-t K] [-dag] [-reduce] [-classify]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+	int i, arg;
+	int nthreads = 1;
+	if(argc<3)
+	{
+		USAGE(argv[0]);
+		return 1;
+	}
+	BATCHTASK task;
+	task.options = FIBER_DEFAULT_OPTIONS();
+	task.classify = 0;
+	for(arg=3; arg<argc; arg++)
+	{
+		if(strcmp(argv[arg], "-t")==0 && arg+1<argc) nthreads = atoi(argv[++arg]);
+		else if(strcmp(argv[arg], "-dag")==0) task.options.dag = 1;
+		else if(strcmp(argv[arg], "-reduce")==0) task.options.reduce = 1;
+		else if(strcmp(argv[arg], "-classify")==0) task.classify = 1;
+		else
+		{
+			printf("ERROR: unknown option or missing value: %s\n", argv[arg]);
+			USAGE(argv[0]);
+			return 1;
+		}
+	}
+	if(nthreads<=0)
+	{
+		long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = (ncores>0) ? (int)ncores : 1;
+	}
+
+	//////////////////////////////// MANIFEST ////////////////////////////////
+	FILE* MANIFEST = fopen(argv[1], "r");
+	if(MANIFEST==NULL) { printf("ERROR in file reading"); return 1; }
+	char line[MANIFEST_LINE_SIZE];
+	int capacity = 64;
+	int lineno = 0;
+	task.njobs = 0;
+	task.jobs = (BATCHJOB*)malloc(capacity*sizeof(BATCHJOB));
+	while(fgets(line, MANIFEST_LINE_SIZE, MANIFEST))
+	{
+		lineno++;
+		if(PARSE_MANIFEST_LINE(line, &(task.jobs), &(task.njobs), &capacity)==0)
+			printf("Skipping malformed manifest line %d\n", lineno);
+	}
+	fclose(MANIFEST);
+
+	task.order = (int*)malloc((task.njobs>0 ? task.njobs : 1)*sizeof(int));
+	double* cost = (double*)malloc(2*(task.njobs>0 ? task.njobs : 1)*sizeof(double));
+	for(i=0; i<task.njobs; i++) { cost[2*i] = task.jobs[i].cost; cost[2*i+1] = i; }
+	qsort(cost, task.njobs, 2*sizeof(double), cmp_jobcost);
+	for(i=0; i<task.njobs; i++) task.order[i] = (int)cost[2*i+1];
+	free(cost);
+	task.next = 0;
+	//////////////////////////////////////////////////////////////////////////
+
+	double t0 = WALL_TIME();
+	if(nthreads>task.njobs) nthreads = (task.njobs>0) ? task.njobs : 1;
+	pthread_t* threads = (pthread_t*)malloc(nthreads*sizeof(pthread_t));
+	for(i=0; i<nthreads; i++) pthread_create(&threads[i], NULL, BATCH_WORKER, &task);
+	for(i=0; i<nthreads; i++) pthread_join(threads[i], NULL);
+	free(threads);
+
+	FILE* OUT = fopen(argv[2], "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return 1; }
+	fprintf(OUT, "job\tsource\tsample\tN\tE\tfibers\tnontrivial\tnodes_nontrivial\tload_s\trefine_s\tclassify_s\tstatus\n");
+	int nfailed = 0;
+	for(i=0; i<task.njobs; i++)
+	{
+		BATCHJOB* job = &(task.jobs[i]);
+		fprintf(OUT, "%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%.6lf\t%.6lf\t%.6lf\t", i, job->source, job->sample, job->size, job->num_edges,
+			job->nfibers, job->nontrivial, job->nodes_nontrivial, job->load_time, job->refine_time, job->classify_time);
+		if(job->failed_stage==NULL) fprintf(OUT, "ok\n");
+		else { fprintf(OUT, "%s: %s\n", job->failed_stage, FIBER_ERROR_NAME(job->error)); nfailed++; }
+		free(job->source);
+	}
+	fclose(OUT);
+	printf("%d networks in %.3lf s with %d threads\n", task.njobs, WALL_TIME() - t0, nthreads);
+	if(nfailed>0) printf("%d jobs failed (see the status column of %s)\n", nfailed, argv[2]);
+	free(task.jobs);
+	free(task.order);
+	return (nfailed>0) ? 1 : 0;
+}
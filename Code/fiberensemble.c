@@ -0,0 +1,337 @@
+/*	Null-model ensemble for the significance of the fibers. The network is refined and
+	its nontrivial fibers classified once, and then R randomized replicates are generated by typed
+	degree-preserving edge swaps ('nullmodelf.h') and go through the same pipeline in
+	one process. The replicates are taken by a pool of threads, each one keeping its own
+	engine ('fiberlib.h') and its own copy of the edges, reused by all its replicates.
+	Each replicate starts from the original network with its own random sequence, so the
+	results only depend on the seed and not on the number of threads.
+
+	Usage:	./fiberensemble ARG1 ARG2 R OUTPUT [-t K] [-swaps Q] [-seed S] [-dag] [-reduce] [-labels]
+
+	with ARG1, ARG2 and the options as in 'main.c', K the number of threads (K = 0 uses
+	all the cores) and Q*E swaps tried on each replicate, for E edges (Q = 10 by default).
+	The fibers with more than one node are counted for each fiber class |n, l> (see
+	'ShowClassification' in 'structforfiber.h'), and OUTPUT receives one line per class
+	found in the network or in any replicate, plus the total number of such fibers and of
+	nodes inside them:
+
+		statistic	n	l	observed	mean	std	z	p_over	p_under
+
+	where 'mean' and 'std' are taken over the replicates, z = (observed - mean)/std and
+	the empirical p-values are p_over = (1 + #{replicate >= observed})/(R + 1) and
+	p_under = (1 + #{replicate <= observed})/(R + 1). If the load or the refinement of
+	any replicate fails, the error is printed and no table is written.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include <pthread.h>
+#include "fiberlib.h"
+#include "nullmodelf.h"
+#include "clockf.h"
+
+
+struct ClassCount
+{
+	long long n_key;	// fundamental number n rounded to 4 decimals, times 10^4.
+	int l;
+	int count;
+};
+typedef struct ClassCount CLASSCOUNT;
+
+struct Replicate
+{
+	int nontrivial;
+	int nodes_nontrivial;
+	int nclasses;
+	CLASSCOUNT* classes;
+	long accepted;
+	int status;			// FIBER_OK, or the error of the failed load or refinement.
+};
+typedef struct Replicate REPLICATE;
+
+struct EnsembleTask
+{
+	NULLMODEL* model;
+	int* pairs;			// edges of the original network in CSR order.
+	int N;
+	int nE;
+	long nswaps;
+	unsigned long long seed;
+	FIBEROPTIONS options;
+	REPLICATE* replicates;
+	int R;
+	int next;			// next replicate (shared counter).
+};
+typedef struct EnsembleTask ENSEMBLETASK;
+
+int cmp_classcount(const void* a, const void* b)
+{
+	CLASSCOUNT* x = (CLASSCOUNT*)a;
+	CLASSCOUNT* y = (CLASSCOUNT*)b;
+	if(x->n_key!=y->n_key) return (x->n_key<y->n_key) ? -1 : 1;
+	if(x->l!=y->l) return (x->l<y->l) ? -1 : 1;
+	return 0;
+}
+
+/*	Counts the nontrivial fibers of an engine by class, sorted by (n, l). Only these
+	fibers are classified.	*/
+void COUNT_CLASSES(FIBERENGINE* engine, REPLICATE* rep)
+{
+	int f, k, l;
+	double n;
+	int nfibers = FIBER_NUM_FIBERS(engine);
+	CLASSCOUNT* list = (CLASSCOUNT*)malloc((nfibers>0 ? nfibers : 1)*sizeof(CLASSCOUNT));
+	int nlist = 0;
+	rep->nontrivial = 0;
+	rep->nodes_nontrivial = 0;
+	for(f=0; f<nfibers; f++)
+	{
+		int size = FIBER_FIBER_SIZE(engine, f);
+		if(size<=1) continue;
+		rep->nontrivial++;
+		rep->nodes_nontrivial += size;
+		FIBER_FIBER_CLASS(engine, f, &n, &l);
+		list[nlist].n_key = llround(n*1e4);
+		list[nlist].l = l;
+		list[nlist].count = 1;
+		nlist++;
+	}
+	qsort(list, nlist, sizeof(CLASSCOUNT), cmp_classcount);
+	rep->nclasses = 0;
+	for(k=0; k<nlist; k++)
+	{
+		if(rep->nclasses>0 && cmp_classcount(&list[rep->nclasses-1], &list[k])==0) list[rep->nclasses-1].count++;
+		else list[rep->nclasses++] = list[k];
+	}
+	rep->classes = list;
+}
+
+void* ENSEMBLE_WORKER(void* arg)
+{
+	int r, status;
+	ENSEMBLETASK* task = (ENSEMBLETASK*)arg;
+	FIBERENGINE* engine = FIBER_CREATE();
+	int* pairs = (int*)malloc(2*(task->nE>0 ? task->nE : 1)*sizeof(int));
+
+	while((r = __atomic_fetch_add(&(task->next), 1, __ATOMIC_RELAXED)) < task->R)
+	{
+		REPLICATE* rep = &(task->replicates[r]);
+		RNGSTATE state = task->seed + 0x9E3779B97F4A7C15ULL*(unsigned long long)(r+1);
+		memcpy(pairs, task->pairs, 2*(size_t)task->nE*sizeof(int));
+		rep->accepted = TYPED_EDGE_SWAPS(task->model, pairs, task->nswaps, &state);
+		status = FIBER_LOAD_EDGES(engine, pairs, task->model->out_type, task->nE, task->N, 1);
+		if(status==FIBER_OK) status = FIBER_REFINE(engine, &(task->options));
+		rep->status = status;
+		if(status!=FIBER_OK) continue;
+		COUNT_CLASSES(engine, rep);
+	}
+	FIBER_FREE(engine);
+	free(pairs);
+	return NULL;
+}
+
+/*	Writes one line of the table for the statistic with the observed value 'observed'
+	and the values 'values' of the R replicates.	*/
+void WRITE_STATISTIC(FILE* OUT, const char* name, const char* n, const char* l, int observed, int* values, int R)
+{
+	int r;
+	int over = 0;
+	int under = 0;
+	double mean = 0.0;
+	double var = 0.0;
+	for(r=0; r<R; r++)
+	{
+		mean += values[r];
+		if(values[r]>=observed) over++;
+		if(values[r]<=observed) under++;
+	}
+	mean = mean/R;
+	for(r=0; r<R; r++) var += (values[r] - mean)*(values[r] - mean);
+	double std = (R>1) ? sqrt(var/(R-1)) : 0.0;
+	fprintf(OUT, "%s\t%s\t%s\t%d\t%.4lf\t%.4lf\t", name, n, l, observed, mean, std);
+	if(std>0.0) fprintf(OUT, "%.4lf", (observed - mean)/std);
+	else fprintf(OUT, "nan");
+	fprintf(OUT, "\t%.6lf\t%.6lf\n", (1.0 + over)/(R + 1.0), (1.0 + under)/(R + 1.0));
+}
+
+void USAGE(char* program)
+{
+	printf("Usage: %s ARG1 ARG2 R OUTPUT [-t K] [-swaps Q] [-seed S] [-dag] [-reduce] [-labels]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+	int i, r, v, k, arg;
+	int nthreads = 1;
+	double swaps_per_edge = 10.0;
+	if(argc<5)
+	{
+		USAGE(argv[0]);
+		return 1;
+	}
+	char net_edges[256] = "../Data/";
+	char nodename[256] = "../Data/";
+	strncat(net_edges, argv[1], 200);
+	strcat(net_edges, "edgelist.dat");
+	strncat(nodename, argv[1], 200);
+	strcat(nodename, "nameID.dat");
+	int nodename_bool = (strcmp(argv[2], "-y")==0);
+	int R = atoi(argv[3]);
+	if(R<1) { printf("ERROR: R must be positive\n"); return 1; }
+
+	int labels = 0;
+	ENSEMBLETASK task;
+	task.seed = DEFAULT_SEED;
+	task.options = FIBER_DEFAULT_OPTIONS();
+	for(arg=5; arg<argc; arg++)
+	{
+		if(strcmp(argv[arg], "-t")==0 && arg+1<argc) nthreads = atoi(argv[++arg]);
+		else if(strcmp(argv[arg], "-swaps")==0 && arg+1<argc) swaps_per_edge = atof(argv[++arg]);
+		else if(strcmp(argv[arg], "-seed")==0 && arg+1<argc) task.seed = strtoull(argv[++arg], NULL, 10);
+		else if(strcmp(argv[arg], "-dag")==0) task.options.dag = 1;
+		else if(strcmp(argv[arg], "-reduce")==0) task.options.reduce = 1;
+		else if(strcmp(argv[arg], "-labels")==0) labels = 1;
+		else
+		{
+			printf("ERROR: unknown option or missing value: %s\n", argv[arg]);
+			USAGE(argv[0]);
+			return 1;
+		}
+	}
+	if(nthreads<=0)
+	{
+		long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+		nthreads = (ncores>0) ? (int)ncores : 1;
+	}
+	if(nthreads>R) nthreads = R;
+
+	//////////////////////////////// ORIGINAL NETWORK ////////////////////////////////
+	double t0 = WALL_TIME();
+	FIBERENGINE* engine = FIBER_CREATE();
+	int status = FIBER_LOAD_FILE(engine, net_edges, nodename_bool ? nodename : NULL, labels, 1);
+	if(status==FIBER_OK) status = FIBER_REFINE(engine, &(task.options));
+	if(status!=FIBER_OK)
+	{
+		printf("ERROR: %s\n", FIBER_ERROR_NAME(status));
+		FIBER_FREE(engine);
+		return 1;
+	}
+	REPLICATE observed;
+	COUNT_CLASSES(engine, &observed);
+
+	// Edges in CSR order: the outgoing edges of node 0, then of node 1, and so on.
+	task.N = FIBER_NUM_NODES(engine);
+	task.nE = FIBER_NUM_EDGES(engine);
+	task.pairs = (int*)malloc(2*(task.nE>0 ? task.nE : 1)*sizeof(int));
+	int* out_start = (int*)malloc((task.N+1)*sizeof(int));
+	int* out_type = (int*)malloc((task.nE>0 ? task.nE : 1)*sizeof(int));
+	int* targets = (int*)malloc((task.nE>0 ? task.nE : 1)*sizeof(int));
+	out_start[0] = 0;
+	for(v=0; v<task.N; v++)
+	{
+		int deg = FIBER_OUT_NEIGHBORS(engine, v, targets + out_start[v], out_type + out_start[v], task.nE - out_start[v]);
+		for(k=out_start[v]; k<out_start[v]+deg; k++)
+		{
+			task.pairs[2*k] = v;
+			task.pairs[2*k+1] = targets[k];
+		}
+		out_start[v+1] = out_start[v] + deg;
+	}
+	FIBER_FREE(engine);
+	task.model = CreateNullModel(task.N, task.nE, out_start, out_type);
+	task.nswaps = (long)(swaps_per_edge*task.nE);
+	free(out_start);
+	free(out_type);
+	free(targets);
+	printf("Original network: %d nodes, %d edges, %d nontrivial fibers (%.3lf s)\n", task.N, task.nE, observed.nontrivial, WALL_TIME() - t0);
+	//////////////////////////////////////////////////////////////////////////////////
+
+	t0 = WALL_TIME();
+	task.R = R;
+	task.next = 0;
+	task.replicates = (REPLICATE*)calloc(R, sizeof(REPLICATE));
+	pthread_t* threads = (pthread_t*)malloc(nthreads*sizeof(pthread_t));
+	for(i=0; i<nthreads; i++) pthread_create(&threads[i], NULL, ENSEMBLE_WORKER, &task);
+	for(i=0; i<nthreads; i++) pthread_join(threads[i], NULL);
+	free(threads);
+	for(r=0; r<R; r++)
+	{
+		if(task.replicates[r].status==FIBER_OK) continue;
+		printf("ERROR: replicate %d: %s\n", r, FIBER_ERROR_NAME(task.replicates[r].status));
+		for(r=0; r<R; r++) free(task.replicates[r].classes);
+		free(task.replicates);
+		free(observed.classes);
+		free(task.pairs);
+		FreeNullModel(task.model);
+		return 1;
+	}
+	double accepted = 0.0;
+	for(r=0; r<R; r++) accepted += task.replicates[r].accepted;
+	printf("%d replicates in %.3lf s with %d threads (%.1lf%% of the swaps accepted)\n", R, WALL_TIME() - t0, nthreads,
+		(task.nswaps>0) ? 100.0*accepted/((double)R*task.nswaps) : 0.0);
+
+	//////////////////////////////// STATISTICS ////////////////////////////////
+	// All the classes found in the network or in any replicate, sorted by (n, l).
+	int nall = observed.nclasses;
+	for(r=0; r<R; r++) nall += task.replicates[r].nclasses;
+	CLASSCOUNT* all = (CLASSCOUNT*)malloc((nall>0 ? nall : 1)*sizeof(CLASSCOUNT));
+	memcpy(all, observed.classes, observed.nclasses*sizeof(CLASSCOUNT));
+	nall = observed.nclasses;
+	for(r=0; r<R; r++)
+	{
+		memcpy(all + nall, task.replicates[r].classes, task.replicates[r].nclasses*sizeof(CLASSCOUNT));
+		nall += task.replicates[r].nclasses;
+	}
+	qsort(all, nall, sizeof(CLASSCOUNT), cmp_classcount);
+	int nunique = 0;
+	for(k=0; k<nall; k++)
+		if(nunique==0 || cmp_classcount(&all[nunique-1], &all[k])!=0) all[nunique++] = all[k];
+
+	FILE* OUT = fopen(argv[4], "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return 1; }
+	fprintf(OUT, "statistic\tn\tl\tobserved\tmean\tstd\tz\tp_over\tp_under\n");
+	int* values = (int*)malloc(R*sizeof(int));
+	int* position = (int*)calloc(R, sizeof(int));	// merge position on the sorted classes of each replicate.
+	int obs_position = 0;
+	char nstr[32], lstr[32];
+	for(k=0; k<nunique; k++)
+	{
+		int obs_count = 0;
+		if(obs_position<observed.nclasses && cmp_classcount(&observed.classes[obs_position], &all[k])==0)
+			obs_count = observed.classes[obs_position++].count;
+		for(r=0; r<R; r++)
+		{
+			REPLICATE* rep = &(task.replicates[r]);
+			values[r] = 0;
+			if(position[r]<rep->nclasses && cmp_classcount(&rep->classes[position[r]], &all[k])==0)
+				values[r] = rep->classes[position[r]++].count;
+		}
+		snprintf(nstr, 32, "%.4lf", all[k].n_key*1e-4);
+		snprintf(lstr, 32, "%d", all[k].l);
+		WRITE_STATISTIC(OUT, "class", nstr, lstr, obs_count, values, R);
+	}
+	for(r=0; r<R; r++) values[r] = task.replicates[r].nontrivial;
+	WRITE_STATISTIC(OUT, "nontrivial", "-", "-", observed.nontrivial, values, R);
+	for(r=0; r<R; r++) values[r] = task.replicates[r].nodes_nontrivial;
+	WRITE_STATISTIC(OUT, "nodes_nontrivial", "-", "-", observed.nodes_nontrivial, values, R);
+	fclose(OUT);
+	////////////////////////////////////////////////////////////////////////////
+
+	for(r=0; r<R; r++) free(task.replicates[r].classes);
+	free(task.replicates);
+	free(observed.classes);
+	free(all);
+	free(values);
+	free(position);
+	free(task.pairs);
+	FreeNullModel(task.model);
+	return 0;
+}
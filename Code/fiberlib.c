@@ -0,0 +1,601 @@
+/*	Implementation of the library interface of 'fiberlib.h'. The modules of this folder
+	define their functions in the headers, so they are all compiled here, in this single
+	translation unit, and only the FIBER_* functions are exported (the others are hidden
+	by '-fvisibility=hidden', see 'Makefile'). None of the modules keeps global state:
+	everything a network needs lives in its 'FiberEngine'.
+
+	After the refinement, the fibers are stored in arrays indexed by fiber ('fiber_start'
+	and 'fiber_nodes', as the CSR arrays of the graph) and the membership and the base
+	graph are taken from the quotient graph, so the queries do not walk the partition lists.
+	The classification of each fiber is computed on its first request ('classifyf.h').
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "fibrationf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "parallelf.h"
+#include "dagf.h"
+#include "reductionf.h"
+#include "quotientf.h"
+#include "labelsf.h"
+#include "reorderf.h"
+#include "classifyf.h"
+#include "verifyf.h"
+#include "historyf.h"
+#include "fiberlib.h"
+
+struct FiberEngine
+{
+	pthread_rwlock_t lock;		// read by the queries, written by the stages.
+	pthread_mutex_t class_lock;	// the fibers are classified on their first request.
+
+	// Network.
+	Graph* graph;
+	int* components;
+	NODEDICT* dict;				// node labels or names, to find the nodes by name.
+	int* name_node;				// node of each name of 'dict' (NULL for labels: the same IDs).
+	int** pair_buffer;			// edge pointers and types given to 'addEdges', kept between the
+	int* type_buffer;			// loads of 'FIBER_LOAD_EDGES' and grown to the largest network.
+	int buffer_capacity;
+
+	// Refinement.
+	PART* partition;
+	PART* null_partition;
+	QUOTIENT* quotient;
+	int* fiber_start;			// nodes of fiber 'f' are 'fiber_nodes[fiber_start[f]]' to 'fiber_nodes[fiber_start[f+1]-1]'.
+	int* fiber_nodes;
+	int nsolitaire_from;		// fibers from this index on are solitaire ones.
+	HISTORY* history;			// split tree, only with 'options.history'.
+
+	// Classification, kept in the blocks of the partitions.
+	CLASSIFIER* classifier;
+};
+
+FIBEROPTIONS FIBER_DEFAULT_OPTIONS(void)
+{
+	FIBEROPTIONS options;
+	options.nthreads = 1;
+	options.dag = 0;
+	options.reduce = 0;
+	options.reorder = FIBER_REORDER_NONE;
+	options.history = 0;
+	return options;
+}
+
+const char* FIBER_ERROR_NAME(int status)
+{
+	switch(status)
+	{
+		case FIBER_OK: return "ok";
+		case FIBER_ERROR_FILE: return "file can not be read";
+		case FIBER_ERROR_STATE: return "missing previous stage";
+		case FIBER_ERROR_ARGUMENT: return "invalid argument";
+	}
+	return "unknown error";
+}
+
+FIBERENGINE* FIBER_CREATE(void)
+{
+	FIBERENGINE* engine = (FIBERENGINE*)calloc(1, sizeof(FIBERENGINE));
+	if(engine==NULL) return NULL;
+	pthread_rwlock_init(&(engine->lock), NULL);
+	pthread_mutex_init(&(engine->class_lock), NULL);
+	return engine;
+}
+
+void FREE_RESULTS(FIBERENGINE* engine)
+{
+	if(engine->classifier!=NULL) FreeClassifier(engine->classifier);
+	FreePartition(&(engine->partition));
+	FreePartition(&(engine->null_partition));
+	if(engine->quotient!=NULL) FreeQuotient(engine->quotient);
+	if(engine->history!=NULL) FreeHistory(engine->history);
+	free(engine->fiber_start);
+	free(engine->fiber_nodes);
+	engine->quotient = NULL;
+	engine->fiber_start = NULL;
+	engine->fiber_nodes = NULL;
+	engine->classifier = NULL;
+	engine->history = NULL;
+}
+
+void FREE_NETWORK(FIBERENGINE* engine)
+{
+	FREE_RESULTS(engine);
+	if(engine->graph!=NULL) FreeGraph(engine->graph);
+	if(engine->dict!=NULL) FreeDictionary(engine->dict);
+	free(engine->name_node);
+	free(engine->components);
+	engine->graph = NULL;
+	engine->dict = NULL;
+	engine->name_node = NULL;
+	engine->components = NULL;
+}
+
+void FIBER_FREE(FIBERENGINE* engine)
+{
+	if(engine==NULL) return;
+	FREE_NETWORK(engine);
+	free(engine->pair_buffer);
+	free(engine->type_buffer);
+	pthread_rwlock_destroy(&(engine->lock));
+	pthread_mutex_destroy(&(engine->class_lock));
+	free(engine);
+}
+
+/*	Index of the node names of a network loaded by IDs, read from the name file at load
+	time, so 'FIBER_FIND_NODE' is one lookup and the queries never write to the graph. A
+	name given to several nodes finds the first one.	*/
+void INDEX_NODE_NAMES(FIBERENGINE* engine)
+{
+	int j, id, size;
+	Graph* graph = engine->graph;
+	engine->dict = CreateDictionary();
+	engine->name_node = (int*)malloc((graph->size>0 ? graph->size : 1)*sizeof(int));
+	for(j=0; j<graph->size; j++)
+	{
+		char* name = NODE_NAME(graph, j);
+		if(name[0]=='\0') continue;
+		size = engine->dict->size;
+		id = INTERN_LABEL(engine->dict, name);
+		if(engine->dict->size>size) engine->name_node[id] = j;
+	}
+}
+
+/*	Whether 'filename' can be opened and read (a folder can be opened, but not read). */
+int READABLE_FILE(const char* filename)
+{
+	FILE* test = fopen(filename, "r");
+	if(test==NULL) return 0;
+	int readable = (getc(test)!=EOF || ferror(test)==0);
+	fclose(test);
+	return readable;
+}
+
+/////////////////////////////////// STAGES ///////////////////////////////////
+int FIBER_LOAD_FILE(FIBERENGINE* engine, const char* edgefile, const char* namefile, int labels, int nthreads)
+{
+	int j, N;
+	int** edges = NULL;
+	int status = FIBER_OK;
+	if(engine==NULL || edgefile==NULL) return FIBER_ERROR_ARGUMENT;
+	// The files are checked here, so the readers below never print their own errors.
+	if(READABLE_FILE(edgefile)==0 || (namefile!=NULL && READABLE_FILE(namefile)==0)) return FIBER_ERROR_FILE;
+
+	nthreads = NUMBER_OF_THREADS(nthreads);
+	pthread_rwlock_wrlock(&(engine->lock));
+	FREE_NETWORK(engine);
+	if(labels==1)
+	{
+		engine->dict = CreateDictionary();
+		edges = defineLabeledNetwork(edges, &(engine->components), &(engine->graph), engine->dict, (char*)edgefile, nthreads);
+	}
+	else if((N = GetNodeNumber((char*)edgefile))>0)
+	{
+		engine->components = (int*)malloc(N*sizeof(int));
+		engine->graph = createGraph(N, (char*)namefile, namefile!=NULL);
+		edges = defineNetwork(edges, engine->components, engine->graph, (char*)edgefile, nthreads);
+		if(namefile!=NULL) INDEX_NODE_NAMES(engine);
+	}
+	// The edge list is not needed once the CSR arrays are built.
+	if(edges!=NULL)
+	{
+		for(j=0; j<engine->graph->num_edges; j++) free(edges[j]);
+		free(edges);
+	}
+	// A file without any edge that can be parsed leaves no network.
+	if(engine->graph==NULL || engine->graph->num_edges==0)
+	{
+		FREE_NETWORK(engine);
+		status = FIBER_ERROR_FILE;
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return status;
+}
+
+int FIBER_LOAD_EDGES(FIBERENGINE* engine, const int* edges, const int* types, int nE, int N, int nthreads)
+{
+	int j;
+	if(engine==NULL || nE<0 || (nE>0 && edges==NULL)) return FIBER_ERROR_ARGUMENT;
+	for(j=0; j<2*nE; j++)
+	{
+		if(edges[j]<0) return FIBER_ERROR_ARGUMENT;
+		if(edges[j]+1>N) N = edges[j]+1;
+	}
+	for(j=0; types!=NULL && j<nE; j++) if(types[j]<-1 || types[j]>2) return FIBER_ERROR_ARGUMENT;
+	if(N<=0) return FIBER_ERROR_ARGUMENT;
+
+	nthreads = NUMBER_OF_THREADS(nthreads);
+	pthread_rwlock_wrlock(&(engine->lock));
+	FREE_NETWORK(engine);
+	if(nE>engine->buffer_capacity)
+	{
+		engine->buffer_capacity = nE;
+		engine->pair_buffer = (int**)realloc(engine->pair_buffer, nE*sizeof(int*));
+		engine->type_buffer = (int*)realloc(engine->type_buffer, nE*sizeof(int));
+	}
+	for(j=0; j<nE; j++)
+	{
+		engine->pair_buffer[j] = (int*)&edges[2*j];
+		engine->type_buffer[j] = (types!=NULL) ? types[j] : 0;
+	}
+	engine->components = (int*)malloc(N*sizeof(int));
+	engine->graph = createGraph(N, NULL, 0);
+	addEdges(engine->pair_buffer, engine->components, engine->graph, engine->type_buffer, nE, nthreads);
+	pthread_rwlock_unlock(&(engine->lock));
+	return FIBER_OK;
+}
+
+int FIBER_REFINE(FIBERENGINE* engine, const FIBEROPTIONS* options)
+{
+	int f, k;
+	PART* current_part;
+	NODELIST* nodelist;
+	FIBEROPTIONS defaults = FIBER_DEFAULT_OPTIONS();
+	if(engine==NULL) return FIBER_ERROR_ARGUMENT;
+	if(options==NULL) options = &defaults;
+	if(options->reorder<FIBER_REORDER_NONE || options->reorder>FIBER_REORDER_COMPONENT) return FIBER_ERROR_ARGUMENT;
+	int nthreads = NUMBER_OF_THREADS(options->nthreads);
+
+	pthread_rwlock_wrlock(&(engine->lock));
+	if(engine->graph==NULL) { pthread_rwlock_unlock(&(engine->lock)); return FIBER_ERROR_STATE; }
+	FREE_RESULTS(engine);
+	Graph* graph = engine->graph;
+	int* components = engine->components;
+	if(options->history==1)
+	{
+		engine->history = CreateHistory(graph->size);
+		HISTORY_REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph, engine->history);
+	}
+	else if(options->reorder!=FIBER_REORDER_NONE)
+		REORDERED_REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph, nthreads, options->reorder, options->dag, options->reduce);
+	else if(options->reduce==1) REDUCED_REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph, nthreads, options->dag);
+	else if(options->dag==1) DAG_REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph, nthreads);
+	else if(graph->num_component>1) PARALLEL_REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph, nthreads);
+	else REFINEMENT(&(engine->partition), &(engine->null_partition), components, graph);
+
+	engine->quotient = BUILD_QUOTIENT(graph, engine->partition, engine->null_partition);
+	engine->nsolitaire_from = GetPartitionSize(engine->partition);
+	int F = engine->quotient->size;
+	engine->fiber_start = (int*)malloc((F+1)*sizeof(int));
+	engine->fiber_nodes = (int*)malloc((graph->size)*sizeof(int));
+	f = 0;
+	k = 0;
+	for(current_part=engine->partition; current_part!=NULL; current_part=current_part->next, f++)
+	{
+		engine->fiber_start[f] = k;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) engine->fiber_nodes[k++] = nodelist->data;
+	}
+	for(current_part=engine->null_partition; current_part!=NULL; current_part=current_part->next, f++)
+	{
+		engine->fiber_start[f] = k;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) engine->fiber_nodes[k++] = nodelist->data;
+	}
+	engine->fiber_start[F] = k;
+	engine->classifier = CreateClassifier(engine->partition, engine->null_partition, graph);
+	pthread_rwlock_unlock(&(engine->lock));
+	return FIBER_OK;
+}
+
+int FIBER_CLASSIFY(FIBERENGINE* engine)
+{
+	int f;
+	if(engine==NULL) return FIBER_ERROR_ARGUMENT;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->classifier==NULL) { pthread_rwlock_unlock(&(engine->lock)); return FIBER_ERROR_STATE; }
+	pthread_mutex_lock(&(engine->class_lock));
+	for(f=0; f<engine->classifier->size; f++) CLASSIFY_FIBER(engine->classifier, f);
+	pthread_mutex_unlock(&(engine->class_lock));
+	pthread_rwlock_unlock(&(engine->lock));
+	return FIBER_OK;
+}
+
+FIBERFILTER FIBER_DEFAULT_FILTER(void)
+{
+	FIBERFILTER filter;
+	filter.min_size = 0;
+	filter.nodes = NULL;
+	filter.nnodes = 0;
+	filter.scc_node = -1;
+	return filter;
+}
+
+int FIBER_CLASSIFY_FIBERS(FIBERENGINE* engine, const FIBERFILTER* filter, int* fibers, int max)
+{
+	int k;
+	int n = -1;
+	FIBERFILTER defaults = FIBER_DEFAULT_FILTER();
+	if(engine==NULL) return -1;
+	if(filter==NULL) filter = &defaults;
+	if(filter->nnodes<0 || (filter->nnodes>0 && filter->nodes==NULL)) return -1;
+	CLASSFILTER internal = DEFAULT_CLASSFILTER();
+	internal.min_size = filter->min_size;
+	internal.nodes = (int*)filter->nodes;
+	internal.nnodes = filter->nnodes;
+	internal.scc_node = filter->scc_node;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->classifier!=NULL)
+	{
+		int* selected = (int*)malloc((engine->classifier->size>0 ? engine->classifier->size : 1)*sizeof(int));
+		pthread_mutex_lock(&(engine->class_lock));
+		n = CLASSIFY_FIBERS(engine->classifier, &internal, selected);
+		pthread_mutex_unlock(&(engine->class_lock));
+		for(k=0; k<n && k<max; k++) fibers[k] = selected[k];
+		free(selected);
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+//////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////// QUERIES ///////////////////////////////////
+int FIBER_NUM_NODES(FIBERENGINE* engine)
+{
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->graph!=NULL) n = engine->graph->size;
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_NUM_EDGES(FIBERENGINE* engine)
+{
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->graph!=NULL) n = engine->graph->num_edges;
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_NUM_FIBERS(FIBERENGINE* engine)
+{
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL) n = engine->quotient->size;
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_NODE_NAME(FIBERENGINE* engine, int node, char* name, size_t size)
+{
+	int length = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	// The names are read at load time, so 'NODE_NAME' only reads the graph here.
+	if(engine->graph!=NULL && node>=0 && node<engine->graph->size)
+	{
+		const char* stored = NODE_NAME(engine->graph, node);
+		length = strlen(stored);
+		if(name!=NULL && size>0) snprintf(name, size, "%s", stored);
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return length;
+}
+
+/*	Node of label 'name', or of the node name 'name' for networks loaded by IDs. */
+int FIBER_FIND_NODE(FIBERENGINE* engine, const char* name)
+{
+	int node = -1;
+	if(engine==NULL || name==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->dict!=NULL)
+	{
+		node = FIND_LABEL(engine->dict, name);
+		if(node>=0 && engine->name_node!=NULL) node = engine->name_node[node];
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return node;
+}
+
+int COPY_NEIGHBORS(FIBERENGINE* engine, int node, int* nodes, int* types, int max, int out_bool)
+{
+	int j, k;
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	Graph* graph = engine->graph;
+	if(graph!=NULL && node>=0 && node<graph->size)
+	{
+		int* start = (out_bool==1) ? graph->out_start : graph->in_start;
+		int* adj = (out_bool==1) ? graph->out_adj : graph->in_adj;
+		int* type = (out_bool==1) ? graph->out_type : graph->in_type;
+		n = start[node+1] - start[node];
+		for(j=start[node], k=0; j<start[node+1] && k<max; j++, k++)
+		{
+			if(nodes!=NULL) nodes[k] = adj[j];
+			if(types!=NULL) types[k] = type[j];
+		}
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_IN_NEIGHBORS(FIBERENGINE* engine, int node, int* nodes, int* types, int max)
+{
+	return COPY_NEIGHBORS(engine, node, nodes, types, max, 0);
+}
+
+int FIBER_OUT_NEIGHBORS(FIBERENGINE* engine, int node, int* nodes, int* types, int max)
+{
+	return COPY_NEIGHBORS(engine, node, nodes, types, max, 1);
+}
+
+int FIBER_NODE_FIBER(FIBERENGINE* engine, int node)
+{
+	int f = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL && node>=0 && node<engine->quotient->num_nodes) f = engine->quotient->fiber[node];
+	pthread_rwlock_unlock(&(engine->lock));
+	return f;
+}
+
+int FIBER_FIBER_SIZE(FIBERENGINE* engine, int fiber)
+{
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL && fiber>=0 && fiber<engine->quotient->size) n = engine->quotient->fiber_size[fiber];
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_FIBER_SOLITAIRE(FIBERENGINE* engine, int fiber)
+{
+	int s = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL && fiber>=0 && fiber<engine->quotient->size) s = (fiber>=engine->nsolitaire_from);
+	pthread_rwlock_unlock(&(engine->lock));
+	return s;
+}
+
+int FIBER_FIBER_NODES(FIBERENGINE* engine, int fiber, int* nodes, int max)
+{
+	int j, k;
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL && fiber>=0 && fiber<engine->quotient->size)
+	{
+		n = engine->fiber_start[fiber+1] - engine->fiber_start[fiber];
+		for(j=engine->fiber_start[fiber], k=0; k<n && k<max; j++, k++) nodes[k] = engine->fiber_nodes[j];
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_FIBER_CLASS(FIBERENGINE* engine, int fiber, double* n, int* l)
+{
+	int status = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->classifier!=NULL && fiber>=0 && fiber<engine->classifier->size)
+	{
+		pthread_mutex_lock(&(engine->class_lock));
+		PART* block = CLASSIFY_FIBER(engine->classifier, fiber);
+		pthread_mutex_unlock(&(engine->class_lock));
+		if(n!=NULL) *n = block->fundamental_number;
+		if(l!=NULL) *l = block->number_regulators;
+		status = FIBER_OK;
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return status;
+}
+
+int FIBER_FIBER_REGULATORS(FIBERENGINE* engine, int fiber, int* nodes, int max)
+{
+	int k;
+	int n = -1;
+	NODELIST* nodelist;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->classifier!=NULL && fiber>=0 && fiber<engine->classifier->size)
+	{
+		pthread_mutex_lock(&(engine->class_lock));
+		PART* block = CLASSIFY_FIBER(engine->classifier, fiber);
+		pthread_mutex_unlock(&(engine->class_lock));
+		n = block->number_regulators;
+		for(nodelist=block->regulators, k=0; nodelist!=NULL && k<max; nodelist=nodelist->next, k++) nodes[k] = nodelist->data;
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_VERIFY(FIBERENGINE* engine, int* witness)
+{
+	int node;
+	int unstable = FIBER_ERROR_STATE;
+	if(engine==NULL) return FIBER_ERROR_ARGUMENT;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL) unstable = VERIFY_STABILITY(engine->graph, engine->quotient->fiber, engine->quotient->size, &node);
+	pthread_rwlock_unlock(&(engine->lock));
+	if(witness!=NULL && unstable>=0) *witness = node;
+	return unstable;
+}
+
+int FIBER_HISTORY_ROUNDS(FIBERENGINE* engine)
+{
+	int rounds = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->history!=NULL) rounds = engine->history->rounds;
+	pthread_rwlock_unlock(&(engine->lock));
+	return rounds;
+}
+
+int FIBER_PARTITION_AT_DEPTH(FIBERENGINE* engine, int depth, int* blocks)
+{
+	int n = -1;
+	if(engine==NULL || blocks==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->history!=NULL) n = HISTORY_PARTITION(engine->history, depth, blocks);
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_SEPARATION_ROUND(FIBERENGINE* engine, int u, int v)
+{
+	int round = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	HISTORY* history = engine->history;
+	if(history!=NULL && u>=0 && u<history->num_nodes && v>=0 && v<history->num_nodes) round = HISTORY_SEPARATION(history, u, v);
+	pthread_rwlock_unlock(&(engine->lock));
+	return round;
+}
+
+int FIBER_QUOTIENT_EDGES(FIBERENGINE* engine, int* rows, int max)
+{
+	int f, j;
+	int n = -1;
+	if(engine==NULL) return -1;
+	pthread_rwlock_rdlock(&(engine->lock));
+	QUOTIENT* quotient = engine->quotient;
+	if(quotient!=NULL)
+	{
+		n = quotient->num_edges;
+		for(f=0; f<quotient->size; f++)
+			for(j=quotient->in_start[f]; j<quotient->in_start[f+1] && j<max; j++)
+			{
+				rows[4*j] = quotient->in_adj[j];
+				rows[4*j+1] = f;
+				rows[4*j+2] = quotient->in_type[j];
+				rows[4*j+3] = quotient->in_mult[j];
+			}
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return n;
+}
+
+int FIBER_WRITE_QUOTIENT(FIBERENGINE* engine, const char* filename)
+{
+	int status = FIBER_ERROR_STATE;
+	if(engine==NULL || filename==NULL) return FIBER_ERROR_ARGUMENT;
+	pthread_rwlock_rdlock(&(engine->lock));
+	if(engine->quotient!=NULL)
+	{
+		FILE* test = fopen(filename, "wb");
+		if(test==NULL) status = FIBER_ERROR_FILE;
+		else
+		{
+			fclose(test);
+			WRITE_QUOTIENT_BINARY(engine->quotient, (char*)filename);
+			status = FIBER_OK;
+		}
+	}
+	pthread_rwlock_unlock(&(engine->lock));
+	return status;
+}
+//////////////////////////////////////////////////////////////////////////////
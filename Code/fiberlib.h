@@ -0,0 +1,150 @@
+/*	Public interface of the fiber library ('libfiber.a'/'libfiber.so', see 'Makefile').
+	All the state of one network (graph, partition, classification, quotient graph) is
+	kept inside an opaque engine handle, so several networks can be analysed at the same
+	time in one process, each one by its own engine.
+
+	Usage:	engine = FIBER_CREATE();
+			FIBER_LOAD_FILE(engine, "../Data/ECOLIedgelist.dat", "../Data/ECOLInameID.dat", 0, 1);
+			options = FIBER_DEFAULT_OPTIONS();
+			FIBER_REFINE(engine, &options);
+			... queries ...
+			FIBER_FREE(engine);
+
+	The functions are reentrant. Each engine also holds a read-write lock: the queries
+	can be made concurrently by any number of threads, while loading and refining take
+	the engine for themselves. The classification of a fiber is computed on its first
+	request and kept, so only the fibers that are asked for are classified. The functions that return a status give
+	FIBER_OK or one of the negative error codes below; the queries return -1 (or NULL)
+	for invalid arguments or when the needed stage was not run yet.
+
+	The fibers are numbered as in 'BUILD_QUOTIENT' ('quotientf.h'): first the fibers of
+	the nodes with inputs and then the solitaire fibers of the nodes without inputs.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef FIBERLIB_H
+#define FIBERLIB_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FIBER_OK 0
+#define FIBER_ERROR_FILE -1		// the file can not be read.
+#define FIBER_ERROR_STATE -2	// a previous stage is missing (e.g., refining before loading).
+#define FIBER_ERROR_ARGUMENT -3
+
+// Node orderings of '-reorder' (see 'reorderf.h').
+#define FIBER_REORDER_NONE 0
+#define FIBER_REORDER_DEGREE 1
+#define FIBER_REORDER_RCM 2
+#define FIBER_REORDER_COMPONENT 3
+
+// Only the functions below are exported by the shared library.
+#if defined(__GNUC__)
+#define FIBER_API __attribute__((visibility("default")))
+#else
+#define FIBER_API
+#endif
+
+typedef struct FiberEngine FIBERENGINE;
+
+struct FiberOptions
+{
+	int nthreads;	// 0 uses all the cores.
+	int dag;		// same as '-dag' in 'main.c'.
+	int reduce;		// same as '-reduce'.
+	int reorder;	// one of FIBER_REORDER_*.
+	int history;	// records the split tree, as '-history' (the other options are then ignored).
+};
+typedef struct FiberOptions FIBEROPTIONS;
+
+FIBER_API FIBEROPTIONS FIBER_DEFAULT_OPTIONS(void);
+
+/*	Selection of fibers for 'FIBER_CLASSIFY_FIBERS' (see 'classifyf.h'). */
+struct FiberFilter
+{
+	int min_size;		// only the fibers with at least 'min_size' nodes.
+	const int* nodes;	// only the fibers containing one of these nodes (if nnodes>0).
+	int nnodes;
+	int scc_node;		// only the fibers meeting the strongly connected component of this node (if >=0).
+};
+typedef struct FiberFilter FIBERFILTER;
+
+FIBER_API FIBERFILTER FIBER_DEFAULT_FILTER(void);
+
+FIBER_API FIBERENGINE* FIBER_CREATE(void);
+FIBER_API void FIBER_FREE(FIBERENGINE* engine);
+FIBER_API const char* FIBER_ERROR_NAME(int status);
+
+/*	Loading replaces any network previously held by the engine, so one engine can be used
+	for many networks one after the other. 'namefile' may be NULL. With 'labels' equal to
+	one the edgelist gives the nodes by labels ('labelsf.h'). Returns FIBER_ERROR_FILE,
+	with no network loaded, when a file can not be read or the edgelist has no edge. */
+FIBER_API int FIBER_LOAD_FILE(FIBERENGINE* engine, const char* edgefile, const char* namefile, int labels, int nthreads);
+/*	'edges' holds 'nE' (source, target) pairs and 'types' one type per edge (NULL when
+	all edges have the same type). The network has max('N', largest node ID + 1) nodes.	*/
+FIBER_API int FIBER_LOAD_EDGES(FIBERENGINE* engine, const int* edges, const int* types, int nE, int N, int nthreads);
+FIBER_API int FIBER_REFINE(FIBERENGINE* engine, const FIBEROPTIONS* options);
+/*	Classifies all the fibers at once. It is never required, since the classification
+	queries compute it for the fibers they are asked for.	*/
+FIBER_API int FIBER_CLASSIFY(FIBERENGINE* engine);
+/*	Classifies the fibers that pass 'filter' (all of them if NULL), writes at most 'max'
+	of them in 'fibers', in increasing order, and returns their number.	*/
+FIBER_API int FIBER_CLASSIFY_FIBERS(FIBERENGINE* engine, const FIBERFILTER* filter, int* fibers, int max);
+
+////////////////////////////// QUERIES //////////////////////////////
+FIBER_API int FIBER_NUM_NODES(FIBERENGINE* engine);
+FIBER_API int FIBER_NUM_EDGES(FIBERENGINE* engine);
+FIBER_API int FIBER_NUM_FIBERS(FIBERENGINE* engine);
+/*	Copies the name (or label) of 'node' to 'name', truncated to 'size' bytes with the final
+	'\0', and returns its length (0 for a node without name), or -1 for an invalid node. The
+	copy stays valid after the engine loads another network.	*/
+FIBER_API int FIBER_NODE_NAME(FIBERENGINE* engine, int node, char* name, size_t size);
+/*	Node with the given label or name, found in an index built at load time. */
+FIBER_API int FIBER_FIND_NODE(FIBERENGINE* engine, const char* name);
+/*	The neighbor queries write at most 'max' neighbors (and their edge types, if 'types'
+	is not NULL) and return the total number of neighbors.	*/
+FIBER_API int FIBER_IN_NEIGHBORS(FIBERENGINE* engine, int node, int* nodes, int* types, int max);
+FIBER_API int FIBER_OUT_NEIGHBORS(FIBERENGINE* engine, int node, int* nodes, int* types, int max);
+
+FIBER_API int FIBER_NODE_FIBER(FIBERENGINE* engine, int node);
+FIBER_API int FIBER_FIBER_SIZE(FIBERENGINE* engine, int fiber);
+FIBER_API int FIBER_FIBER_SOLITAIRE(FIBERENGINE* engine, int fiber);
+/*	Writes at most 'max' nodes of 'fiber' and returns its size. */
+FIBER_API int FIBER_FIBER_NODES(FIBERENGINE* engine, int fiber, int* nodes, int max);
+/*	Classification |n,l> of 'fiber', computed on the first request: the fundamental
+	number n (branch ratio) and the number l of external regulators.	*/
+FIBER_API int FIBER_FIBER_CLASS(FIBERENGINE* engine, int fiber, double* n, int* l);
+/*	Writes at most 'max' external regulators of 'fiber' and returns their number. */
+FIBER_API int FIBER_FIBER_REGULATORS(FIBERENGINE* engine, int fiber, int* nodes, int max);
+
+/*	Checks in one pass that the fibers are input-tree stable (see 'verifyf.h'). Returns the
+	number of unstable fibers, zero for a correct result; 'witness', if not NULL, receives
+	a node of the first unstable fiber.	*/
+FIBER_API int FIBER_VERIFY(FIBERENGINE* engine, int* witness);
+
+/*	Split tree of a refinement run with 'options.history' (see 'historyf.h'). The rounds
+	query returns the last round with a split, the depth query writes the block of each
+	node after round 'depth' in 'blocks' (one per node) and returns the number of blocks,
+	and the separation query returns the round in which 'u' and 'v' were put in different
+	blocks (-1 if never).	*/
+FIBER_API int FIBER_HISTORY_ROUNDS(FIBERENGINE* engine);
+FIBER_API int FIBER_PARTITION_AT_DEPTH(FIBERENGINE* engine, int depth, int* blocks);
+FIBER_API int FIBER_SEPARATION_ROUND(FIBERENGINE* engine, int u, int v);
+
+/*	Base graph: writes at most 'max' edges as (source fiber, target fiber, type,
+	multiplicity) rows and returns the number of base edges.	*/
+FIBER_API int FIBER_QUOTIENT_EDGES(FIBERENGINE* engine, int* rows, int max);
+FIBER_API int FIBER_WRITE_QUOTIENT(FIBERENGINE* engine, const char* filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,258 @@
+/*	Resident query server. The network is loaded and refined once, and then the queries
+	are answered over a Unix domain socket, each client served by its own thread. The
+	queries only take the read lock of the engine ('fiberlib.h'), so any number of clients
+	are answered at the same time. Each fiber is classified on its first class query.
+
+	Usage:	./fiberserver SOCKET ARG1 ARG2 [-t K] [-dag] [-reduce] [-labels]
+
+	with ARG1, ARG2 and the options as in 'main.c'. The protocol is line based: each
+	request is one line and receives one line, starting with "OK" or with "ERR" followed
+	by the reason. Nodes may be given by ID or by name. Requests:
+
+		STATS				OK <nodes> <edges> <fibers>
+		NODE <node>			OK <ID> <name> <fiber>
+		IN <node>			OK <count> <neighbor>:<type> ...	(incoming neighbors)
+		OUT <node>			OK <count> <neighbor>:<type> ...	(outgoing neighbors)
+		FIBER <node>		OK <fiber>
+		MEMBERS <fiber>		OK <size> <node> ...
+		CLASS <fiber>		OK <n> <l>
+		REGULATORS <fiber>	OK <count> <node> ...
+		QUIT				closes the connection.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "fiberlib.h"
+
+#define REQUEST_SIZE 4096
+
+struct ClientTask
+{
+	int fd;
+	int labels;
+	FIBERENGINE* engine;
+};
+typedef struct ClientTask CLIENTTASK;
+
+/*	Node given by 'word': its label (or name) first, then its ID. */
+int PARSE_NODE(FIBERENGINE* engine, char* word, int labels)
+{
+	char* end;
+	int node = -1;
+	if(labels==1) node = FIBER_FIND_NODE(engine, word);
+	if(node>=0) return node;
+	long id = strtol(word, &end, 10);
+	if(*end=='\0' && end!=word) return (id>=0 && id<FIBER_NUM_NODES(engine)) ? (int)id : -1;
+	return FIBER_FIND_NODE(engine, word);
+}
+
+int PARSE_FIBER(FIBERENGINE* engine, char* word)
+{
+	char* end;
+	long id = strtol(word, &end, 10);
+	if(*end!='\0' || end==word || id<0 || id>=FIBER_NUM_FIBERS(engine)) return -1;
+	return (int)id;
+}
+
+void WRITE_NEIGHBORS(FILE* OUT, FIBERENGINE* engine, int node, int out_bool)
+{
+	int k;
+	int n = out_bool ? FIBER_OUT_NEIGHBORS(engine, node, NULL, NULL, 0) : FIBER_IN_NEIGHBORS(engine, node, NULL, NULL, 0);
+	int* nodes = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	int* types = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	if(out_bool) FIBER_OUT_NEIGHBORS(engine, node, nodes, types, n);
+	else FIBER_IN_NEIGHBORS(engine, node, nodes, types, n);
+	fprintf(OUT, "OK %d", n);
+	for(k=0; k<n; k++) fprintf(OUT, " %d:%d", nodes[k], types[k]);
+	fprintf(OUT, "\n");
+	free(nodes);
+	free(types);
+}
+
+void WRITE_NODES(FILE* OUT, int* nodes, int n)
+{
+	int k;
+	fprintf(OUT, "OK %d", n);
+	for(k=0; k<n; k++) fprintf(OUT, " %d", nodes[k]);
+	fprintf(OUT, "\n");
+}
+
+/*	Answers one request line. Returns zero when the client asks to close. */
+int ANSWER_REQUEST(FILE* OUT, FIBERENGINE* engine, char* line, int labels)
+{
+	int node, fiber, n, l;
+	double fundamental;
+	char* saveptr;
+	char* command = strtok_r(line, " \t\r\n", &saveptr);
+	char* word = strtok_r(NULL, " \t\r\n", &saveptr);
+	if(command==NULL) { fprintf(OUT, "ERR empty request\n"); return 1; }
+	if(strcmp(command, "QUIT")==0) return 0;
+	if(strcmp(command, "STATS")==0)
+	{
+		fprintf(OUT, "OK %d %d %d\n", FIBER_NUM_NODES(engine), FIBER_NUM_EDGES(engine), FIBER_NUM_FIBERS(engine));
+		return 1;
+	}
+
+	if(strcmp(command, "NODE")==0 || strcmp(command, "IN")==0 || strcmp(command, "OUT")==0 || strcmp(command, "FIBER")==0)
+	{
+		if(word==NULL) { fprintf(OUT, "ERR missing argument\n"); return 1; }
+		node = PARSE_NODE(engine, word, labels);
+		if(node<0) { fprintf(OUT, "ERR unknown node\n"); return 1; }
+		if(command[0]=='N')
+		{
+			char name[1024];
+			int length = FIBER_NODE_NAME(engine, node, name, sizeof(name));
+			fprintf(OUT, "OK %d %s %d\n", node, (length>0) ? name : "-", FIBER_NODE_FIBER(engine, node));
+		}
+		else if(command[0]=='I') WRITE_NEIGHBORS(OUT, engine, node, 0);
+		else if(command[0]=='O') WRITE_NEIGHBORS(OUT, engine, node, 1);
+		else fprintf(OUT, "OK %d\n", FIBER_NODE_FIBER(engine, node));
+		return 1;
+	}
+
+	if(strcmp(command, "MEMBERS")==0 || strcmp(command, "CLASS")==0 || strcmp(command, "REGULATORS")==0)
+	{
+		if(word==NULL) { fprintf(OUT, "ERR missing argument\n"); return 1; }
+		fiber = PARSE_FIBER(engine, word);
+		if(fiber<0) { fprintf(OUT, "ERR unknown fiber\n"); return 1; }
+		if(command[0]=='C')
+		{
+			FIBER_FIBER_CLASS(engine, fiber, &fundamental, &l);
+			fprintf(OUT, "OK %.4lf %d\n", fundamental, l);
+			return 1;
+		}
+		n = (command[0]=='M') ? FIBER_FIBER_SIZE(engine, fiber) : FIBER_FIBER_REGULATORS(engine, fiber, NULL, 0);
+		int* nodes = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+		if(command[0]=='M') FIBER_FIBER_NODES(engine, fiber, nodes, n);
+		else FIBER_FIBER_REGULATORS(engine, fiber, nodes, n);
+		WRITE_NODES(OUT, nodes, n);
+		free(nodes);
+		return 1;
+	}
+	fprintf(OUT, "ERR unknown request\n");
+	return 1;
+}
+
+void* CLIENT_WORKER(void* arg)
+{
+	CLIENTTASK* task = (CLIENTTASK*)arg;
+	char line[REQUEST_SIZE];
+	FILE* IN = fdopen(task->fd, "r");
+	FILE* OUT = fdopen(dup(task->fd), "w");
+	if(IN!=NULL && OUT!=NULL)
+	{
+		while(fgets(line, REQUEST_SIZE, IN))
+		{
+			if(ANSWER_REQUEST(OUT, task->engine, line, task->labels)==0) break;
+			if(fflush(OUT)!=0) break;
+		}
+	}
+	if(IN!=NULL) fclose(IN);
+	else close(task->fd);
+	if(OUT!=NULL) fclose(OUT);
+	free(task);
+	return NULL;
+}
+
+void USAGE(char* program)
+{
+	printf("Usage: %s SOCKET ARG1 ARG2 [-t K] [-dag] [-reduce] [-labels]\n", program);
+}
+
+int main(int argc, char** argv)
+{
+	int arg, fd, client;
+	struct stat info;
+	if(argc<4)
+	{
+		USAGE(argv[0]);
+		return 1;
+	}
+	char net_edges[256] = "../Data/";
+	char nodename[256] = "../Data/";
+	strncat(net_edges, argv[2], 200);
+	strcat(net_edges, "edgelist.dat");
+	strncat(nodename, argv[2], 200);
+	strcat(nodename, "nameID.dat");
+	int nodename_bool = (strcmp(argv[3], "-y")==0);
+
+	int labels = 0;
+	FIBEROPTIONS options = FIBER_DEFAULT_OPTIONS();
+	for(arg=4; arg<argc; arg++)
+	{
+		if(strcmp(argv[arg], "-t")==0 && arg+1<argc) options.nthreads = atoi(argv[++arg]);
+		else if(strcmp(argv[arg], "-dag")==0) options.dag = 1;
+		else if(strcmp(argv[arg], "-reduce")==0) options.reduce = 1;
+		else if(strcmp(argv[arg], "-labels")==0) labels = 1;
+		else
+		{
+			printf("ERROR: unknown option or missing value: %s\n", argv[arg]);
+			USAGE(argv[0]);
+			return 1;
+		}
+	}
+
+	FIBERENGINE* engine = FIBER_CREATE();
+	int status = FIBER_LOAD_FILE(engine, net_edges, nodename_bool ? nodename : NULL, labels, options.nthreads);
+	if(status==FIBER_OK) status = FIBER_REFINE(engine, &options);
+	if(status!=FIBER_OK)
+	{
+		printf("ERROR: %s\n", FIBER_ERROR_NAME(status));
+		FIBER_FREE(engine);
+		return 1;
+	}
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(strlen(argv[1])>=sizeof(address.sun_path)) { printf("ERROR: socket path too long\n"); return 1; }
+	strcpy(address.sun_path, argv[1]);
+	// The socket left by an earlier server is replaced, but no other kind of file is removed.
+	if(lstat(argv[1], &info)==0)
+	{
+		if(!S_ISSOCK(info.st_mode))
+		{
+			printf("ERROR: %s exists and is not a socket\n", argv[1]);
+			FIBER_FREE(engine);
+			return 1;
+		}
+		unlink(argv[1]);
+	}
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(fd<0 || bind(fd, (struct sockaddr*)&address, sizeof(address))<0 || listen(fd, 64)<0)
+	{
+		printf("ERROR in socket creation\n");
+		return 1;
+	}
+	// A client closing its connection must not stop the server.
+	signal(SIGPIPE, SIG_IGN);
+	printf("Serving %d nodes and %d fibers at %s\n", FIBER_NUM_NODES(engine), FIBER_NUM_FIBERS(engine), argv[1]);
+	fflush(stdout);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	while(1)
+	{
+		client = accept(fd, NULL, NULL);
+		if(client<0) continue;
+		CLIENTTASK* task = (CLIENTTASK*)malloc(sizeof(CLIENTTASK));
+		task->fd = client;
+		task->labels = labels;
+		task->engine = engine;
+		pthread_t thread;
+		if(pthread_create(&thread, &attr, CLIENT_WORKER, task)!=0) { close(client); free(task); }
+	}
+	return 0;
+}
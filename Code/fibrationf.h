@@ -15,7 +15,9 @@
 ///////////////////
 #include "utilsforfiber.h"
 #include "structforfiber.h"
+#include "vectorf.h"
 #define SENTINEL -96
+#define GATHER_SIZE 64		// nodes whose counts are gathered and tested at once.
 
 /////////////////////////////////////////////////////////////////////////
 /////////////////////// FIBRATION CLASSIFICATION ////////////////////////
@@ -46,7 +48,6 @@ extern int INFINITE_INTREE(int root, Graph* graph)
 extern int FIBERNODE_FOR_BRANCHING(PART* fiber, Graph* graph)
 {
 	NODELIST* nodelist;
-	NODELIST* regulators;
 	NODELIST* strong_component = NULL;
 
 	int max = -1;
@@ -138,7 +139,7 @@ extern int DISTANCE_TREEOUTPUT(int root, int wanted, NODELIST* scc, Graph* graph
 	and its length gives the appropriate generalized golden ratio.	*/
 extern double BRANCH_RATIO(PART* block_info, Graph* graph)
 {
-	double n, n_j;
+	double n_j = 0.0;
 	int i, a_top, a_bottom;
 
 	NODELIST* nodelist;
@@ -233,7 +234,6 @@ extern void CALC_BRANCHING(PART** partition, Graph* graph)
 {
 	double nloop;
 	PART* current_part;
-	NODELIST* nodelist;
 	for(current_part=(*partition); current_part!=NULL; current_part=current_part->next)
 	{
 		if(current_part->block->size>1)
@@ -246,7 +246,7 @@ extern void CALC_BRANCHING(PART** partition, Graph* graph)
 
 extern void GET_EIGMAX(NODELIST* scc_nodes, Graph* graph)
 {
-	int i, j, k;
+	int j, k;
 	int nn = GetListSize(scc_nodes);
 	int* temp_index = (int*)malloc(nn*sizeof(int));
     double* temp_adjmatrix = (double*)malloc(nn*nn*sizeof(double));
@@ -322,46 +322,49 @@ int VERIFY_IF_REGULATOR(NODELIST* fibernodes, int regulator, Graph* graph)
 	return 1;	// If the function reaches this line, then the given node is an external regulator.
 }
 
-/*	Defines all the external regulators for each fiber block. An external regulator is a node
+/*	Defines the external regulators of one fiber block. An external regulator is a node
 	outside the fiber that directly regulates all nodes inside the fiber. */
-extern void CALCULATE_REGULATORS(PART** partition, Graph* graph)
+extern void CALCULATE_BLOCK_REGULATORS(PART* current_part, Graph* graph)
 {
 	int* in_neighbors;	
 	int i, current_node, boolean_in, boolean_out;
-	
-	PART* current_part;
 	NODELIST* nodelist;
-	// For each fiber.
-	for(current_part=(*partition); current_part!=NULL; current_part=current_part->next)
+	// For each node inside the fiber.
+	for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
 	{
-		// For each node inside the fiber.
-		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
+		current_node = nodelist->data;
+		int n_in = GETNin(graph, current_node);
+		// gets all the nodes that regulates the current node.
+		in_neighbors = GET_INNEIGH(graph, current_node);
+		for(i=0; i<n_in; i++)
 		{
-			current_node = nodelist->data;
-			int n_in = GETNin(graph, current_node);
-			// gets all the nodes that regulates the current node.
-			in_neighbors = GET_INNEIGH(graph, current_node);
-			for(i=0; i<n_in; i++)
-			{
-				// First check if the regulation node is part of the fiber.
-				boolean_in = doublycheck_element(current_part->block->head, in_neighbors[i]);
-				// Second check	if it is already defined as an external regulator.			
-				boolean_out = doublycheck_element(current_part->regulators, in_neighbors[i]);
-				if(boolean_out==0 && boolean_in==0)
-				{ 
-					int reg_verification = VERIFY_IF_REGULATOR(nodelist, in_neighbors[i], graph);
-					if(reg_verification==1)
-					{
-						push_doublylist(&(current_part->regulators), in_neighbors[i]); 
-						current_part->number_regulators++;
-					}
-					
+			// First check if the regulation node is part of the fiber.
+			boolean_in = doublycheck_element(current_part->block->head, in_neighbors[i]);
+			// Second check	if it is already defined as an external regulator.			
+			boolean_out = doublycheck_element(current_part->regulators, in_neighbors[i]);
+			if(boolean_out==0 && boolean_in==0)
+			{ 
+				int reg_verification = VERIFY_IF_REGULATOR(nodelist, in_neighbors[i], graph);
+				if(reg_verification==1)
+				{
+					push_doublylist(&(current_part->regulators), in_neighbors[i]); 
+					current_part->number_regulators++;
 				}
+				
 			}
 		}
 		free(in_neighbors);
 	}
 }
+
+/*	Defines all the external regulators for each fiber block. */
+extern void CALCULATE_REGULATORS(PART** partition, Graph* graph)
+{
+	PART* current_part;
+	// For each fiber.
+	for(current_part=(*partition); current_part!=NULL; current_part=current_part->next)
+		CALCULATE_BLOCK_REGULATORS(current_part, graph);
+}
 //############################################################//
 
 /////////////////////////////////////////////////////////////////////////////
@@ -372,10 +375,8 @@ extern void CALCULATE_REGULATORS(PART** partition, Graph* graph)
 
 void UPGRADE_PARTITION(PART** new_blocks, PART** old_blocks, PART** partition)
 {
-	BLOCK* temp_block = NULL;	
 	PART* current_old = *old_blocks;
 	PART* current_new = *new_blocks;
-	PART* current_part;
 	// Erase in 'partition' all the blocks contained in 'old_blocks'.
 	while(current_old)
 	{
@@ -397,7 +398,6 @@ void Push_On_Block(int node, int nodeindex1, int nodeindex2, int nodeindex3, PAR
 /*	First thing, we need to loop over the blocks of the given partition
 	and check if there is a block with the same index. */
 	PART* current_part = *subpart2;
-	NODELIST* nodelist = NULL;
 	
 	for(current_part=(*subpart2); current_part!=NULL; current_part=current_part->next)
 	{
@@ -422,33 +422,38 @@ void Push_On_Block(int node, int nodeindex1, int nodeindex2, int nodeindex3, PAR
 }
 
 /*	Given the 'Set' block, now we select all the blocks in the 'partition' that aren't 
-	stable with respect to 'Set'. We store these blocks into 'subpart' partition structure. */
+	stable with respect to 'Set'. We store these blocks into 'subpart' partition structure.
+	The counts of the nodes of each block are gathered, GATHER_SIZE nodes at a time, into
+	one contiguous buffer for each edge type, after the counts of the first node of the
+	block, and each buffer is tested with 'UNIFORM_RANGE' ('vectorf.h'). */
 extern void GET_NONSTABLE_BLOCKS1(PART** partition, PART** subpart, int* pos_fromSet, int* neg_fromSet, int* dual_fromSet, Graph* graph, BLOCK* Set)
 {
-	int node, nextnode;
-	int npos_node, npos_nextnode;
-	int nneg_node, nneg_nextnode;
-	int ndual_node, ndual_nextnode;
-	
+	int n, node;
+	int pos[GATHER_SIZE+1];		// Number of 'Set' positive edges received by each gathered node
+	int neg[GATHER_SIZE+1];		// Number of 'Set' negative edges received by each gathered node
+	int dual[GATHER_SIZE+1];	// Number of 'Set' dual edges received by each gathered node
+
 	PART* current_part;
 	NODELIST* nodelist;
+	SELECT_VECTOR_KERNELS_ONCE();
 	for(current_part=(*partition); current_part!=NULL; current_part=current_part->next)
 	{
 		nodelist = current_part->block->head;
-		if(nodelist!=NULL)
+		if(nodelist==NULL) continue;
+		node = nodelist->data;
+		pos[0] = pos_fromSet[node];
+		neg[0] = neg_fromSet[node];
+		dual[0] = dual_fromSet[node];
+		for(nodelist=nodelist->next; nodelist!=NULL; )
 		{
-			node = nodelist->data;
-			npos_node = pos_fromSet[node];
-			nneg_node = neg_fromSet[node];
-			ndual_node = dual_fromSet[node];
-		} 		
-		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
-		{
-			nextnode = nodelist->data;
-			npos_nextnode = pos_fromSet[nextnode];		// Number of 'Set' positive edges received by 'nextnode'
-			nneg_nextnode = neg_fromSet[nextnode];		// Number of 'Set' negatives edges received by 'nextnode'
-			ndual_nextnode = dual_fromSet[nextnode];		// Number of 'Set' dual edges received by 'nextnode'
-			if(((npos_node!=npos_nextnode) || (nneg_node!=nneg_nextnode)) || (ndual_node!=ndual_nextnode)) 
+			for(n=1; n<=GATHER_SIZE && nodelist!=NULL; n++, nodelist=nodelist->next)
+			{
+				node = nodelist->data;
+				pos[n] = pos_fromSet[node];
+				neg[n] = neg_fromSet[node];
+				dual[n] = dual_fromSet[node];
+			}
+			if(!UNIFORM_RANGE(pos, n) || !UNIFORM_RANGE(neg, n) || !UNIFORM_RANGE(dual, n))
 			{
 				push_block(subpart, current_part->block); 
 				break; 
@@ -493,14 +498,37 @@ void SPLIT_BLOCK(BLOCK* block, int* pos_fromSet, int* neg_fromSet, int* dual_fro
 void BLOCKS_PARTITIONING(PART** subpart1, PART** subpart2, int* pos_fromSet, int* neg_fromSet, int* dual_fromSet, Graph* graph, BLOCK* Set)
 {
 	PART* part_to_split = *subpart1;	
-	NODELIST* nodelist = NULL;		
 	for(part_to_split=(*subpart1); part_to_split!=NULL; part_to_split = part_to_split->next)
 		SPLIT_BLOCK(part_to_split->block, pos_fromSet, neg_fromSet, dual_fromSet, subpart2);
 }
 
-extern void S_SPLIT(PART** partition, BLOCK* Set, Graph* graph, QBLOCK** qhead, QBLOCK** qtail)
+/*	Adds the blocks of 'subpart2' to the split tree, each one as a child of the block its
+	nodes were in, created in the round 'history->current'.	*/
+void RECORD_SPLITS(HISTORY* history, PART* subpart2)
+{
+	PART* current_part;
+	NODELIST* nodelist;
+	for(current_part=subpart2; current_part!=NULL; current_part=current_part->next)
+	{
+		if(history->size==history->capacity)
+		{
+			history->capacity *= 2;
+			history->parent = (int*)realloc(history->parent, history->capacity*sizeof(int));
+			history->round = (int*)realloc(history->round, history->capacity*sizeof(int));
+		}
+		int b = history->size++;
+		history->parent[b] = history->leaf[current_part->block->head->data];
+		history->round[b] = history->current;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) history->leaf[nodelist->data] = b;
+	}
+	if(history->current>history->rounds) history->rounds = history->current;
+}
+
+/*	Splits the blocks of 'partition' with respect to 'Set'. When 'history' is not NULL,
+	the new blocks are recorded in the split tree.	*/
+extern void S_SPLIT(PART** partition, BLOCK* Set, Graph* graph, QBLOCK** qhead, QBLOCK** qtail, HISTORY* history)
 {	
-	int N, i;
+	int i;
 	PART* subpart1 = NULL;
 	PART* subpart2 = NULL;
 	PART* current_part = NULL;
@@ -530,6 +558,7 @@ extern void S_SPLIT(PART** partition, BLOCK* Set, Graph* graph, QBLOCK** qhead,
 	in the queue of refining blocks, except the largest one. */
 	if(GetPartitionSize(subpart2)>GetPartitionSize(subpart1))
 	{
+		if(history!=NULL) RECORD_SPLITS(history, subpart2);
 		UPGRADE_PARTITION(&subpart2, &subpart1, partition);
 	/*	Given a partition of blocks, insert all these blocks, except the largest ones, to
 		the queue of refining blocks. */
@@ -591,7 +620,6 @@ extern void push_block_by_index(int node, int index, PART** partition)
 /*	First thing, we need to loop over the blocks of the given partition
 	and check if there is a block with the same index. */
 	PART* current_part = *partition;
-	NODELIST* nodelist = NULL;
 	
 	for(current_part=(*partition); current_part!=NULL; current_part=current_part->next)
 	{
@@ -615,13 +643,11 @@ extern void push_block_by_index(int node, int index, PART** partition)
 extern void PREPROCESSING(PART** partition, PART** null_partition, PART** null_partition1, int* components, Graph* graph)
 {    
 	int N = graph->size;
-	int root, n_in, n_out, i;
+	int root, i;
 	int* roots = (int*)malloc(N*sizeof(int));
 	
 	for(i=0; i<N; i++)
 	{
-		n_out = GETNout(graph, i);
-		n_in = GETNin(graph, i);
 		int solitaire = IDENTIFY_SOLITAIRE(graph, i);
 		if(solitaire==0) roots[i] = -1;
 		else if(solitaire==1) roots[i] = -2;
@@ -658,6 +684,34 @@ extern void PREPROCESSING(PART** partition, PART** null_partition, PART** null_p
 	for(nodelist=P->head; nodelist!=NULL; nodelist=nodelist->next)
 		InitiateBlock(null_partition1, nodelist->data);        
 }
+
+/*	Coarsest refinement of the whole graph: defines the initial partition through
+	'PREPROCESSING' and then splits the blocks until the queue of refining blocks is
+	empty. All fibers are returned in 'partition' and the nodes without inputs are
+	returned as single blocks in 'null_partition'.	*/
+extern void REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph)
+{
+	PART* null_partition1 = NULL;
+	PREPROCESSING(partition, null_partition, &null_partition1, components, graph);
+
+	// Initialize the queue of blocks with the initial blocks above.
+	QBLOCK* qhead = NULL;
+	QBLOCK* qtail = NULL;
+	ENQUEUE_BLOCKS(partition, &qhead, &qtail);
+	ENQUEUE_BLOCKS(null_partition, &qhead, &qtail);
+	ENQUEUE_BLOCKS(&null_partition1, &qhead, &qtail);
+	FreePartition(&null_partition1);
+
+	// Until the queue is empty, we procedure the splitting process.
+	BLOCK* CurrentSet;	
+	while(qhead)
+	{
+		CurrentSet = dequeue_block(&qhead, &qtail);
+		S_SPLIT(partition, CurrentSet, graph, &qhead, &qtail, NULL);
+		deleteList(&(CurrentSet->head));
+		free(CurrentSet);
+	}
+}
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////
 
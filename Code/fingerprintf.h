@@ -0,0 +1,355 @@
+/*	Canonical fingerprints of the fibers and of the partition, and the diff of two runs.
+
+	Each node is identified by a key, the hash of its name (or of its ID, written as text,
+	when the network has no names), so the same node is recognized in two versions of a
+	network even if the node IDs changed. For each fiber of the quotient graph:
+
+		members		the hash of the set of keys of its nodes;
+		inputs		the hash of its typed inputs, as the multiset of (members of the source
+					fiber, type of regulation, multiplicity);
+		fingerprint	the hash of both.
+
+	The set and multiset hashes are sums of mixed hashes of their elements, which do not
+	depend on the order of the elements, so no sorting is needed and the fingerprints do
+	not depend on the order of the block lists nor on the fiber indexes. The fingerprint
+	of the partition is the sum of the mixed fingerprints of its fibers. All of them are
+	computed in O(N+M).
+
+	The fingerprint file is written as the line "%016llx\t%d\t%d\n" -> Partition
+	fingerprint/ Number of fibers/ Number of nodes, one line per fiber as
+	"%d\t%d\t%016llx\t%016llx\t%016llx\n" -> Fiber/ Size/ Fingerprint/ Members/ Inputs, and
+	one line per node as "%s\t%d\n" -> Node name (or ID)/ Fiber.
+
+	The diff of an older run (A) and a newer one (B) matches the nodes by their keys and
+	writes one line per change as "%s\t%s\t%s\n" -> Kind/ Fibers of A/ Fibers of B, the
+	fibers of one run being separated by commas ("-" for none). The kinds are:
+
+		unchanged	same nodes and same fingerprint;
+		changed		the fiber kept its identity (no node left or joined from another fiber),
+					but it gained or lost nodes or its inputs changed;
+		split		the nodes of one fiber of A are in several fibers of B, which have no
+					other node of A;
+		merged		the converse of 'split';
+		regrouped	any other exchange of nodes between fibers;
+		removed		no node of the fiber of A is in B;
+		added		no node of the fiber of B is in A.
+
+	The diff is done in O(N) (expected, for the hash table of the keys).
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef FINGERPRINTF_H
+#define FINGERPRINTF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+struct Fingerprints
+{
+	int N;						// Number of nodes.
+	int size;					// Number of fibers.
+	unsigned long long partition;
+	int* fiber_size;
+	unsigned long long* fiber;	// Fingerprint of each fiber.
+	unsigned long long* members;
+	unsigned long long* inputs;
+	unsigned long long* key;	// Key of each node.
+	int* node_fiber;
+};
+typedef struct Fingerprints FPRINT;
+
+/*	FNV-1a hash of a string. */
+unsigned long long NODE_KEY(const char* name)
+{
+	return FNV_BYTES(FNV_OFFSET, name, strlen(name));
+}
+
+FPRINT* AllocFingerprints(int N, int nfibers)
+{
+	FPRINT* fp = (FPRINT*)malloc(sizeof(FPRINT));
+	fp->N = N;
+	fp->size = nfibers;
+	fp->partition = 0;
+	fp->fiber_size = (int*)calloc((nfibers>0 ? nfibers : 1), sizeof(int));
+	fp->fiber = (unsigned long long*)malloc((nfibers>0 ? nfibers : 1)*sizeof(unsigned long long));
+	fp->members = (unsigned long long*)malloc((nfibers>0 ? nfibers : 1)*sizeof(unsigned long long));
+	fp->inputs = (unsigned long long*)malloc((nfibers>0 ? nfibers : 1)*sizeof(unsigned long long));
+	fp->key = (unsigned long long*)malloc((N>0 ? N : 1)*sizeof(unsigned long long));
+	fp->node_fiber = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	return fp;
+}
+
+extern void FreeFingerprints(FPRINT* fp)
+{
+	free(fp->fiber_size);
+	free(fp->fiber);
+	free(fp->members);
+	free(fp->inputs);
+	free(fp->key);
+	free(fp->node_fiber);
+	free(fp);
+}
+
+/*	Name of 'node' used as its key: its name or, without names, its ID. */
+char* KEY_NAME(Graph* graph, int node, char* buffer)
+{
+	char* name = NODE_NAME(graph, node);
+	if(name[0]!='\0') return name;
+	sprintf(buffer, "%d", node);
+	return buffer;
+}
+
+/*	Fingerprints of the fibers of 'quotient', built from 'graph'. */
+extern FPRINT* FIBER_FINGERPRINTS(Graph* graph, QUOTIENT* quotient)
+{
+	int v, f, j;
+	char buffer[32];
+	FPRINT* fp = AllocFingerprints(quotient->num_nodes, quotient->size);
+	for(f=0; f<fp->size; f++)
+	{
+		fp->fiber_size[f] = quotient->fiber_size[f];
+		fp->members[f] = MIX64((unsigned long long)quotient->fiber_size[f]);
+		fp->inputs[f] = 0;
+	}
+	for(v=0; v<fp->N; v++)
+	{
+		fp->key[v] = NODE_KEY(KEY_NAME(graph, v, buffer));
+		fp->node_fiber[v] = quotient->fiber[v];
+		fp->members[quotient->fiber[v]] += MIX64(fp->key[v]);
+	}
+	for(f=0; f<fp->size; f++)
+		for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+			fp->inputs[f] += MIX64(fp->members[quotient->in_adj[j]] ^ MIX64(4ULL*quotient->in_mult[j] + quotient->in_type[j] + 1));
+
+	fp->partition = MIX64((unsigned long long)fp->size);
+	for(f=0; f<fp->size; f++)
+	{
+		fp->fiber[f] = MIX64(fp->members[f] ^ MIX64(fp->inputs[f]));
+		fp->partition += MIX64(fp->fiber[f]);
+	}
+	return fp;
+}
+
+extern void WRITE_FINGERPRINTS(FPRINT* fp, Graph* graph, char* filename)
+{
+	int f, v;
+	char buffer[32];
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	fprintf(OUT, "%016llx\t%d\t%d\n", fp->partition, fp->size, fp->N);
+	for(f=0; f<fp->size; f++)
+		fprintf(OUT, "%d\t%d\t%016llx\t%016llx\t%016llx\n", f, fp->fiber_size[f], fp->fiber[f], fp->members[f], fp->inputs[f]);
+	for(v=0; v<fp->N; v++) fprintf(OUT, "%s\t%d\n", KEY_NAME(graph, v, buffer), fp->node_fiber[v]);
+	fclose(OUT);
+}
+
+/*	Returns NULL if the file can not be read or is not a fingerprint file. */
+extern FPRINT* READ_FINGERPRINTS(char* filename)
+{
+	int N, nfibers, f, v, index;
+	unsigned long long partition;
+	char name[1024];
+	FILE* IN = fopen(filename, "r");
+	if(IN==NULL) return NULL;
+	if(fscanf(IN, "%llx\t%d\t%d\n", &partition, &nfibers, &N)!=3 || nfibers<0 || N<0) { fclose(IN); return NULL; }
+	FPRINT* fp = AllocFingerprints(N, nfibers);
+	fp->partition = partition;
+	for(f=0; f<nfibers; f++)
+	{
+		if(fscanf(IN, "%d\t%d\t%llx\t%llx\t%llx\n", &index, &(fp->fiber_size[f]), &(fp->fiber[f]), &(fp->members[f]), &(fp->inputs[f]))!=5 || index!=f)
+			{ fclose(IN); FreeFingerprints(fp); return NULL; }
+	}
+	for(v=0; v<N; v++)
+	{
+		if(fscanf(IN, "%1023s\t%d\n", name, &(fp->node_fiber[v]))!=2 || fp->node_fiber[v]<0 || fp->node_fiber[v]>=nfibers)
+			{ fclose(IN); FreeFingerprints(fp); return NULL; }
+		fp->key[v] = NODE_KEY(name);
+	}
+	fclose(IN);
+	return fp;
+}
+
+/*	Nodes of each fiber, grouped by a counting sort: the nodes of fiber 'f' are
+	'nodes[start[f]..start[f+1]-1]'.	*/
+void FIBER_MEMBERS(FPRINT* fp, int** start, int** nodes)
+{
+	int f, v;
+	*start = (int*)calloc(fp->size+1, sizeof(int));
+	*nodes = (int*)malloc((fp->N>0 ? fp->N : 1)*sizeof(int));
+	for(v=0; v<fp->N; v++) (*start)[fp->node_fiber[v]+1]++;
+	for(f=0; f<fp->size; f++) (*start)[f+1] += (*start)[f];
+	int* fill = (int*)malloc((fp->size>0 ? fp->size : 1)*sizeof(int));
+	memcpy(fill, *start, fp->size*sizeof(int));
+	for(v=0; v<fp->N; v++) (*nodes)[fill[fp->node_fiber[v]]++] = v;
+	free(fill);
+}
+
+/*	For each node of 'A', the node of 'B' with the same key, or -1. Open addressing
+	table over the keys of 'B'.	*/
+int* MATCH_NODES(FPRINT* A, FPRINT* B)
+{
+	int v, u;
+	unsigned long long mask = 1;
+	while(mask<2ULL*(unsigned long long)B->N) mask <<= 1;
+	int* table = (int*)malloc(mask*sizeof(int));
+	mask--;
+	for(v=0; v<=(int)mask; v++) table[v] = -1;
+	unsigned long long slot;
+	for(u=0; u<B->N; u++)
+	{
+		for(slot=MIX64(B->key[u]) & mask; table[slot]!=-1 && B->key[table[slot]]!=B->key[u]; slot=(slot+1) & mask);
+		if(table[slot]==-1) table[slot] = u;
+	}
+	int* match = (int*)malloc((A->N>0 ? A->N : 1)*sizeof(int));
+	for(v=0; v<A->N; v++)
+	{
+		for(slot=MIX64(A->key[v]) & mask; table[slot]!=-1 && B->key[table[slot]]!=A->key[v]; slot=(slot+1) & mask);
+		match[v] = table[slot];
+	}
+	free(table);
+	return match;
+}
+
+/*	Fibers of 'other' reached by the nodes of each fiber of 'fp' through 'match': their
+	number in 'nreach', the first one in 'first' and the nodes without a match in 'lost'.	*/
+void FIBER_REACH(FPRINT* fp, FPRINT* other, int* match, int* start, int* nodes, int* nreach, int* first, int* lost)
+{
+	int f, k, g;
+	int* seen = (int*)malloc((other->size>0 ? other->size : 1)*sizeof(int));
+	for(g=0; g<other->size; g++) seen[g] = -1;
+	for(f=0; f<fp->size; f++)
+	{
+		nreach[f] = 0;
+		first[f] = -1;
+		lost[f] = 0;
+		for(k=start[f]; k<start[f+1]; k++)
+		{
+			if(match[nodes[k]]<0) { lost[f]++; continue; }
+			g = other->node_fiber[match[nodes[k]]];
+			if(seen[g]==f) continue;
+			seen[g] = f;
+			if(nreach[f]==0) first[f] = g;
+			nreach[f]++;
+		}
+	}
+	free(seen);
+}
+
+/*	Writes the fibers of 'other' reached by fiber 'f' (its nodes are 'nodes[start[f]]' to
+	'nodes[start[f+1]-1]'), separated by commas.	*/
+void WRITE_REACHED(FILE* OUT, FPRINT* other, int* match, int* start, int* nodes, int* seen, int f)
+{
+	int k, g, count = 0;
+	for(k=start[f]; k<start[f+1]; k++)
+	{
+		if(match[nodes[k]]<0) continue;
+		g = other->node_fiber[match[nodes[k]]];
+		if(seen[g]==f) continue;
+		seen[g] = f;
+		fprintf(OUT, (count++>0 ? ",%d" : "%d"), g);
+	}
+	if(count==0) fprintf(OUT, "-");
+}
+
+/*	Diff of the fibers of the run 'A' (older) and 'B' (newer), written to 'filename'.
+	The number of fibers of each kind is returned in 'counts', in the order: unchanged,
+	changed, split, merged, regrouped, removed, added.	*/
+extern void FINGERPRINT_DIFF(FPRINT* A, FPRINT* B, char* filename, int* counts)
+{
+	int a, b;
+	for(a=0; a<7; a++) counts[a] = 0;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+
+	int *startA, *nodesA, *startB, *nodesB;
+	FIBER_MEMBERS(A, &startA, &nodesA);
+	FIBER_MEMBERS(B, &startB, &nodesB);
+	int* matchA = MATCH_NODES(A, B);
+	int* matchB = MATCH_NODES(B, A);
+	int* reachA = (int*)malloc((A->size>0 ? A->size : 1)*sizeof(int));
+	int* firstA = (int*)malloc((A->size>0 ? A->size : 1)*sizeof(int));
+	int* lostA = (int*)malloc((A->size>0 ? A->size : 1)*sizeof(int));
+	int* reachB = (int*)malloc((B->size>0 ? B->size : 1)*sizeof(int));
+	int* firstB = (int*)malloc((B->size>0 ? B->size : 1)*sizeof(int));
+	int* lostB = (int*)malloc((B->size>0 ? B->size : 1)*sizeof(int));
+	FIBER_REACH(A, B, matchA, startA, nodesA, reachA, firstA, lostA);
+	FIBER_REACH(B, A, matchB, startB, nodesB, reachB, firstB, lostB);
+
+	// 'seenA' and 'seenB' mark the fibers already written for the current fiber.
+	int* seenA = (int*)malloc((A->size>0 ? A->size : 1)*sizeof(int));
+	int* seenB = (int*)malloc((B->size>0 ? B->size : 1)*sizeof(int));
+	for(a=0; a<A->size; a++) seenA[a] = -1;
+	for(b=0; b<B->size; b++) seenB[b] = -1;
+
+	// A fiber of B is part of a merge when its fibers of A reach no other fiber of B.
+	int* merged = (int*)calloc((B->size>0 ? B->size : 1), sizeof(int));
+	int* split = (int*)calloc((A->size>0 ? A->size : 1), sizeof(int));
+	int k, all;
+	for(b=0; b<B->size; b++)
+	{
+		if(reachB[b]<2) continue;
+		for(all=1, k=startB[b]; all && k<startB[b+1]; k++)
+			if(matchB[nodesB[k]]>=0 && reachA[A->node_fiber[matchB[nodesB[k]]]]!=1) all = 0;
+		merged[b] = all;
+	}
+	for(a=0; a<A->size; a++)
+	{
+		if(reachA[a]<2) continue;
+		for(all=1, k=startA[a]; all && k<startA[a+1]; k++)
+			if(matchA[nodesA[k]]>=0 && reachB[B->node_fiber[matchA[nodesA[k]]]]!=1) all = 0;
+		split[a] = all;
+	}
+
+	for(a=0; a<A->size; a++)
+	{
+		b = firstA[a];
+		if(reachA[a]==0) { fprintf(OUT, "removed\t%d\t-\n", a); counts[5]++; continue; }
+		if(reachA[a]==1 && reachB[b]==1)
+		{
+			if(lostA[a]==0 && lostB[b]==0 && A->fiber[a]==B->fiber[b]) { fprintf(OUT, "unchanged\t%d\t%d\n", a, b); counts[0]++; }
+			else { fprintf(OUT, "changed\t%d\t%d\n", a, b); counts[1]++; }
+			continue;
+		}
+		// Merges are written once, from the fiber of B.
+		if(reachA[a]==1 && merged[b]==1) continue;
+		fprintf(OUT, (split[a]==1 ? "split\t%d\t" : "regrouped\t%d\t"), a);
+		counts[(split[a]==1 ? 2 : 4)]++;
+		WRITE_REACHED(OUT, B, matchA, startA, nodesA, seenB, a);
+		fprintf(OUT, "\n");
+	}
+	for(b=0; b<B->size; b++)
+	{
+		if(reachB[b]==0) { fprintf(OUT, "added\t-\t%d\n", b); counts[6]++; continue; }
+		if(merged[b]==0) continue;
+		fprintf(OUT, "merged\t");
+		WRITE_REACHED(OUT, A, matchB, startB, nodesB, seenA, b);
+		fprintf(OUT, "\t%d\n", b);
+		counts[3]++;
+	}
+	fclose(OUT);
+
+	free(merged);
+	free(split);
+	free(seenA);
+	free(seenB);
+	free(reachA);
+	free(firstA);
+	free(lostA);
+	free(reachB);
+	free(firstB);
+	free(lostB);
+	free(matchA);
+	free(matchB);
+	free(startA);
+	free(nodesA);
+	free(startB);
+	free(nodesB);
+}
+
+#endif
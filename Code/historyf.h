@@ -0,0 +1,188 @@
+/*	Split tree of the refinement. 'REFINEMENT' only keeps the final partition; with
+	'HISTORY_REFINEMENT' every block created by 'S_SPLIT' is also recorded in a tree,
+	with its parent block and the round in which it was created, so the partitions of the
+	intermediate rounds and the round in which two nodes were separated can be queried
+	after the refinement, without running it again with a limited number of steps.
+
+	Block 0 holds all the nodes. The initial blocks of 'PREPROCESSING' (one for each weak
+	component and one for each node without inputs) are created in round 0. The queue of
+	splitters is processed in rounds: round r splits the blocks with the splitters that
+	were in the queue at the end of round r-1, so the splitters of round 1 are the initial
+	blocks. The rounds of the blocks never decrease from a block to its children, and the
+	partition at depth d is given by the deepest block with round <= d on the path of each
+	node to the root. The tree takes one parent and one round for each block ever created
+	(at most 2N blocks) and one block for each node.
+
+	The history is written to (and read from) a text file:
+
+		"%d\t%d\t%d\n" -> Number of nodes/ Number of blocks/ Rounds;
+		one line for each block "%d\t%d\t%d\n" -> Block/ Parent/ Round;
+		one line for each node "%d\t%d\n" -> Node ID/ Final block.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef HISTORYF_H
+#define HISTORYF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fibrationf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+/*	History with only the root block, holding the N nodes. */
+extern HISTORY* CreateHistory(int N)
+{
+	int v;
+	HISTORY* history = (HISTORY*)malloc(sizeof(HISTORY));
+	history->num_nodes = N;
+	history->size = 1;
+	history->capacity = (N>0) ? 2*N : 2;
+	history->rounds = 0;
+	history->current = 0;
+	history->parent = (int*)malloc(history->capacity*sizeof(int));
+	history->round = (int*)malloc(history->capacity*sizeof(int));
+	history->leaf = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	history->parent[0] = -1;
+	history->round[0] = 0;
+	for(v=0; v<N; v++) history->leaf[v] = 0;
+	return history;
+}
+
+extern void FreeHistory(HISTORY* history)
+{
+	free(history->parent);
+	free(history->round);
+	free(history->leaf);
+	free(history);
+}
+
+/*	'REFINEMENT' recording the split tree in 'history', created for 'graph->size' nodes. */
+extern void HISTORY_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, HISTORY* history)
+{
+	PART* null_partition1 = NULL;
+	PREPROCESSING(partition, null_partition, &null_partition1, components, graph);
+	history->current = 0;
+	if(GetPartitionSize(*partition) + GetPartitionSize(*null_partition)>1)
+	{
+		RECORD_SPLITS(history, *partition);
+		RECORD_SPLITS(history, *null_partition);
+	}
+
+	QBLOCK* qhead = NULL;
+	QBLOCK* qtail = NULL;
+	ENQUEUE_BLOCKS(partition, &qhead, &qtail);
+	ENQUEUE_BLOCKS(null_partition, &qhead, &qtail);
+	ENQUEUE_BLOCKS(&null_partition1, &qhead, &qtail);
+	FreePartition(&null_partition1);
+
+	// The round ends with the splitter that was the last one in the queue when it began.
+	BLOCK* last = (qtail!=NULL) ? qtail->block : NULL;
+	BLOCK* CurrentSet;
+	history->current = 1;
+	while(qhead)
+	{
+		CurrentSet = dequeue_block(&qhead, &qtail);
+		S_SPLIT(partition, CurrentSet, graph, &qhead, &qtail, history);
+		if(CurrentSet==last)
+		{
+			history->current++;
+			last = (qtail!=NULL) ? qtail->block : NULL;
+		}
+		deleteList(&(CurrentSet->head));
+		free(CurrentSet);
+	}
+}
+
+/*	Partition after round 'depth': 'block[v]' receives the block of node 'v', the blocks
+	numbered from 0 in the order of their first node. Returns the number of blocks.	*/
+extern int HISTORY_PARTITION(HISTORY* history, int depth, int* block)
+{
+	int b, v;
+	int nblocks = 0;
+	// A parent is always recorded before its children.
+	int* ancestor = (int*)malloc(history->size*sizeof(int));
+	int* number = (int*)malloc(history->size*sizeof(int));
+	for(b=0; b<history->size; b++)
+	{
+		if(b==0 || history->round[b]<=depth) ancestor[b] = b;
+		else ancestor[b] = ancestor[history->parent[b]];
+		number[b] = -1;
+	}
+	for(v=0; v<history->num_nodes; v++)
+	{
+		b = ancestor[history->leaf[v]];
+		if(number[b]<0) number[b] = nblocks++;
+		block[v] = number[b];
+	}
+	free(ancestor);
+	free(number);
+	return nblocks;
+}
+
+/*	Round in which nodes 'u' and 'v' were put in different blocks, or -1 if they are in
+	the same final block.	*/
+extern int HISTORY_SEPARATION(HISTORY* history, int u, int v)
+{
+	int a = history->leaf[u];
+	int b = history->leaf[v];
+	int below = -1;
+	// The blocks are numbered after their parents, so the larger one is the deeper one.
+	while(a!=b)
+	{
+		if(a>b) { below = a; a = history->parent[a]; }
+		else { below = b; b = history->parent[b]; }
+	}
+	if(below<0) return -1;
+	return history->round[below];
+}
+
+extern void WRITE_HISTORY(HISTORY* history, char* filename)
+{
+	int b, v;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	fprintf(OUT, "%d\t%d\t%d\n", history->num_nodes, history->size, history->rounds);
+	for(b=0; b<history->size; b++) fprintf(OUT, "%d\t%d\t%d\n", b, history->parent[b], history->round[b]);
+	for(v=0; v<history->num_nodes; v++) fprintf(OUT, "%d\t%d\n", v, history->leaf[v]);
+	fclose(OUT);
+}
+
+/*	Reads a history written by 'WRITE_HISTORY'. Returns NULL if the file can not be read
+	or is not a valid tree.	*/
+extern HISTORY* READ_HISTORY(char* filename)
+{
+	int N, size, rounds, b, v, k, parent, round;
+	FILE* IN = fopen(filename, "r");
+	if(IN==NULL) return NULL;
+	if(fscanf(IN, "%d\t%d\t%d\n", &N, &size, &rounds)!=3 || N<0 || size<1) { fclose(IN); return NULL; }
+	HISTORY* history = CreateHistory(N);
+	history->rounds = rounds;
+	if(size>history->capacity)
+	{
+		history->capacity = size;
+		history->parent = (int*)realloc(history->parent, size*sizeof(int));
+		history->round = (int*)realloc(history->round, size*sizeof(int));
+	}
+	history->size = size;
+	int valid = 1;
+	for(k=0; valid && k<size; k++)
+	{
+		if(fscanf(IN, "%d\t%d\t%d\n", &b, &parent, &round)!=3 || b!=k || parent>=b || (b>0 && parent<0)) valid = 0;
+		else { history->parent[b] = parent; history->round[b] = round; }
+	}
+	for(k=0; valid && k<N; k++)
+	{
+		if(fscanf(IN, "%d\t%d\n", &v, &b)!=2 || v!=k || b<0 || b>=size) valid = 0;
+		else history->leaf[v] = b;
+	}
+	fclose(IN);
+	if(valid==0) { FreeHistory(history); return NULL; }
+	return history;
+}
+
+#endif
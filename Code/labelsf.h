@@ -0,0 +1,196 @@
+/*	Native reading of edgelists whose nodes are given by arbitrary labels (gene names, for
+	instance) instead of pre-numbered integers. Each line is "Source Target [Type]", with
+	the fields separated by spaces or tabs and the type given as in 'defineNetwork'. The
+	file is read only once: each label is interned in a node dictionary, a hash table with
+	open addressing whose strings are stored one after the other in a single character
+	pool, and receives a dense node ID in the order of its first appearance. The labels are
+	copied to the node names of the graph; 'WRITE_LABELS' writes the map from node IDs to
+	labels ("%d\t%s\n" -> Node ID/ Label), which gives the labels of the node IDs of all the
+	other outputs, and the dictionary can then be freed (the library keeps it to find the
+	nodes by label).
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef LABELSF_H
+#define LABELSF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+#define LABEL_LINE_SIZE 4096
+
+struct NodeDictionary
+{
+	int size;				// number of labels.
+	int capacity;			// number of slots of the hash table (power of two).
+	int* table;				// label ID stored at each slot (-1 if empty).
+	long* offset;			// label 'id' starts at 'pool[offset[id]]'.
+	int offset_capacity;
+	char* pool;
+	long pool_size;
+	long pool_capacity;
+};
+typedef struct NodeDictionary NODEDICT;
+
+extern NODEDICT* CreateDictionary()
+{
+	int i;
+	NODEDICT* dict = (NODEDICT*)malloc(sizeof(NODEDICT));
+	dict->size = 0;
+	dict->capacity = 1024;
+	dict->table = (int*)malloc((dict->capacity)*sizeof(int));
+	for(i=0; i<dict->capacity; i++) dict->table[i] = -1;
+	dict->offset_capacity = 512;
+	dict->offset = (long*)malloc((dict->offset_capacity)*sizeof(long));
+	dict->pool_capacity = 8192;
+	dict->pool_size = 0;
+	dict->pool = (char*)malloc(dict->pool_capacity);
+	return dict;
+}
+
+extern void FreeDictionary(NODEDICT* dict)
+{
+	free(dict->table);
+	free(dict->offset);
+	free(dict->pool);
+	free(dict);
+}
+
+unsigned int HASH_LABEL(const char* label)
+{
+	unsigned int h = 2166136261U;
+	while(*label) { h ^= (unsigned char)(*label++); h *= 16777619U; }
+	return h;
+}
+
+extern char* GET_LABEL(NODEDICT* dict, int id)
+{
+	return &(dict->pool[dict->offset[id]]);
+}
+
+/*	Doubles the hash table and reinserts all the labels. */
+void GROW_DICTIONARY(NODEDICT* dict)
+{
+	int i, id, slot;
+	free(dict->table);
+	dict->capacity *= 2;
+	dict->table = (int*)malloc((dict->capacity)*sizeof(int));
+	for(i=0; i<dict->capacity; i++) dict->table[i] = -1;
+	for(id=0; id<dict->size; id++)
+	{
+		slot = HASH_LABEL(GET_LABEL(dict, id)) & (dict->capacity-1);
+		while(dict->table[slot]>=0) slot = (slot+1) & (dict->capacity-1);
+		dict->table[slot] = id;
+	}
+}
+
+/*	Returns the ID of 'label', if it is not in the dictionary it receives the next ID. */
+extern int INTERN_LABEL(NODEDICT* dict, const char* label)
+{
+	int slot = HASH_LABEL(label) & (dict->capacity-1);
+	while(dict->table[slot]>=0)
+	{
+		if(strcmp(GET_LABEL(dict, dict->table[slot]), label)==0) return dict->table[slot];
+		slot = (slot+1) & (dict->capacity-1);
+	}
+
+	// New label: copy it to the pool.
+	long length = strlen(label) + 1;
+	while(dict->pool_size+length>dict->pool_capacity)
+	{
+		dict->pool_capacity *= 2;
+		dict->pool = (char*)realloc(dict->pool, dict->pool_capacity);
+	}
+	if(dict->size==dict->offset_capacity)
+	{
+		dict->offset_capacity *= 2;
+		dict->offset = (long*)realloc(dict->offset, (dict->offset_capacity)*sizeof(long));
+	}
+	memcpy(&(dict->pool[dict->pool_size]), label, length);
+	dict->offset[dict->size] = dict->pool_size;
+	dict->pool_size += length;
+	dict->table[slot] = dict->size;
+	dict->size++;
+
+	if(2*(dict->size)>dict->capacity) GROW_DICTIONARY(dict);
+	return dict->size-1;
+}
+
+/*	Returns the ID of 'label' or -1 if it is not in the dictionary. */
+extern int FIND_LABEL(NODEDICT* dict, const char* label)
+{
+	int slot = HASH_LABEL(label) & (dict->capacity-1);
+	while(dict->table[slot]>=0)
+	{
+		if(strcmp(GET_LABEL(dict, dict->table[slot]), label)==0) return dict->table[slot];
+		slot = (slot+1) & (dict->capacity-1);
+	}
+	return -1;
+}
+
+/*	Writes the label of each node ID to 'filename' ("%d\t%s\n" -> Node ID/ Label). */
+extern void WRITE_LABELS(NODEDICT* dict, char* filename)
+{
+	int id;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	for(id=0; id<dict->size; id++) fprintf(OUT, "%d\t%s\n", id, GET_LABEL(dict, id));
+	fclose(OUT);
+}
+
+/*	Reads the labeled edgelist 'filename', creates the graph in '*graph' with one node per
+	label and defines its structure as 'defineNetwork' does. The labels are interned in
+	'dict' and also assigned as the node names.	*/
+extern int** defineLabeledNetwork(int** edges, int** components, Graph** graph, NODEDICT* dict, char* filename, int nthreads)
+{
+	FILE* EDGE_FILE = fopen(filename, "r");
+	if(EDGE_FILE==NULL) { printf("ERROR in file reading"); return NULL; }
+
+	int j, nfields;
+	int nlink = 0;
+	int link_capacity = 1024;
+	char line[LABEL_LINE_SIZE];
+	char* fields[3];
+	char* token;
+	char* saveptr;
+	edges = (int**)malloc(link_capacity*sizeof(int*));
+	int* regulator = (int*)malloc(link_capacity*sizeof(int));
+	while(fgets(line, LABEL_LINE_SIZE, EDGE_FILE))
+	{
+		nfields = 0;
+		token = strtok_r(line, " \t\r\n", &saveptr);
+		while(token!=NULL && nfields<3) { fields[nfields++] = token; token = strtok_r(NULL, " \t\r\n", &saveptr); }
+		if(nfields<2 || fields[0][0]=='#') continue;	// empty and comment lines.
+
+		if(nlink==link_capacity)
+		{
+			link_capacity *= 2;
+			edges = (int**)realloc(edges, link_capacity*sizeof(int*));
+			regulator = (int*)realloc(regulator, link_capacity*sizeof(int));
+		}
+		edges[nlink] = (int*)malloc(2*sizeof(int));
+		edges[nlink][0] = INTERN_LABEL(dict, fields[0]);
+		edges[nlink][1] = INTERN_LABEL(dict, fields[1]);
+		regulator[nlink] = (nfields>2) ? REGULATION_TYPE(fields[2]) : -1;
+		nlink++;
+	}
+	fclose(EDGE_FILE);
+
+	int N = dict->size;
+	*graph = createGraph(N, NULL, 0);
+	(*graph)->meta = CreateMetadata(N, NULL);
+	(*graph)->meta->loaded = 1;
+	for(j=0; j<N; j++) SET_NODE_NAME((*graph)->meta, j, GET_LABEL(dict, j));
+	*components = (int*)malloc(N*sizeof(int));
+	addEdges(edges, *components, *graph, regulator, nlink, nthreads);
+	free(regulator);
+	return edges;
+}
+
+#endif
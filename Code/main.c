@@ -19,6 +19,81 @@
 	name/ Gene ID number). Thus, if there is a gene name file, the code will properly link all the node numbers with their 
 	corresponding name if 'ARG2' is passed as '-y', otherwise just the node numbers is stored for each node.
 
+	Optional arguments may follow the first two:
+		'-t K'			number of threads K used while loading and refining the network (K = 0 uses all the cores); on
+						machines with several memory domains the refinement threads are spread and pinned over them.
+						The refinement threads share the weak components, so one giant component is refined by a
+						single thread (see 'parallelf.h' and 'numabench.sh').
+		'-dag'			resolves the nodes with finite input-trees in one topological sweep and only refines the
+						remaining ones (see 'dagf.h').
+		'-reduce'		collapses the nodes with identical inputs before the refinement (see 'reductionf.h').
+		'-quotient'		writes the base graph of the fibration to 'ARG1quotient.dat', 'ARG1nodefiber.dat' and
+						'ARG1quotient.bin' (see 'quotientf.h').
+		'-verify'		checks in one pass that the resulting partition is input-tree stable (see 'verifyf.h').
+		'-reference F'	same, and also compares the partition with the fibers of the file F ("%d\t%d\n" -> Node
+						ID/ Fiber, as 'ARG1nodefiber.dat'), to check that it is the coarsest one.
+		'-classify'		computes the classification |n,l> of the fibers and writes it to 'ARG1classification.dat'
+						(see 'classifyf.h'). Without it (and without the filters below), the fibers are not
+						classified at all.
+		'-min-size K'	only classifies the fibers with at least K nodes.
+		'-nodes A,B,..'	only classifies the fibers containing one of the given node IDs.
+		'-scc A'		only classifies the fibers with a node in the strongly connected component of node A.
+		'-fingerprint'	writes the canonical fingerprints of the fibers and of the partition, with the fiber of each
+						node, to 'ARG1fingerprint.dat' (see 'fingerprintf.h').
+		'-diff F'		compares the fibers with the ones of the fingerprint file F, written by an earlier run, and
+						writes the fibers unchanged, changed, split, merged, regrouped, removed and added to
+						'ARG1diff.dat' (see 'fingerprintf.h').
+		'-orbits'		computes the orbits of the automorphism group of the network, seeded by the fibers, and
+						writes the orbit of each node to 'ARG1orbits.dat' ("%d\t%d\n" -> Node ID/ Orbit), see
+						'orbitsf.h'.
+		'-ode S'		runs S steps of the ODE dynamics on the base graph and writes them to 'ARG1ode.dat', one
+						column per fiber (see 'dynamicsf.h').
+		'-boolean S'	same for the Boolean dynamics, written to 'ARG1boolean.dat'.
+		'-lift'			writes the dynamics with one column per node instead of one per fiber.
+		'-params B,G,K,H,DT'	parameters of the ODE dynamics: basal rate, degradation rate gamma, Hill constant
+						K, Hill exponent and time step (0.1,1,0.5,2,0.01 by default).
+		'-initial F'	initial state of the nodes, read from the file F ("%d\t%lf\n" -> Node ID/ Value, zero
+						for the nodes not listed). The state of a fiber is the average over its nodes; the
+						Boolean dynamics starts from 1 for the nodes with a positive value. Without it, the
+						ODE starts from zero and the Boolean dynamics from 1 everywhere.
+		'-compare'		also runs the dynamics on the full network, from the same node state, and prints the
+						largest difference to the lifted fiber dynamics (zero when the initial state is
+						constant inside each fiber).
+		'-reorder O'	relabels the nodes by the ordering O ('degree', 'rcm' or 'component') before the
+						refinement, the result is given in the original node IDs (see 'reorderf.h').
+		'-checkpoint F S'	writes the state of the refinement to the file F every S seconds and, when F already
+						holds the state of an interrupted run on the same network, resumes from it (see
+						'checkpointf.h'). It runs the serial refinement over the whole network, so it can
+						not be combined with '-t', '-dag', '-reduce' or '-reorder', and the fibers, the
+						same as without it, may be numbered in another order.
+		'-history'		records the split tree of the refinement (the parent and the round of each block) and
+						writes it to 'ARG1history.dat' (see 'historyf.h'). The serial refinement is used,
+						whatever the other options, and '-checkpoint' is ignored.
+		'-depth D'		same, and writes the partition after round D to 'ARG1depth.dat' ("%d\t%d\n" -> Node
+						ID/ Block).
+		'-separation A B'	same, and prints the round in which nodes A and B were put in different blocks.
+		'-cache DIR'	keeps the partition and the classified fibers in the folder DIR, under a key made from
+						the network and the options, and reads them back on the next runs on the same network
+						instead of refining (see 'cachef.h'). Not used with '-history'.
+		'-cache-size M'	removes the least recently used entries of the cache folder beyond M megabytes (256 by
+						default).
+		'-external M'	out-of-core refinement for networks larger than the memory, with a budget of M megabytes
+						for the edge buffers (see 'externalf.h'). Only the fibers are computed and written to
+						'ARG1nodefiber.dat' ("%d\t%d\n" -> Node ID/ Fiber), the fibers of the nodes without
+						inputs being numbered last. Its blocks are contiguous ranges tested in place by the
+						vectorized kernel of 'vectorf.h', which the default refinement uses on gathered copies.
+						The edgelist must give node IDs, so it can not be combined with '-labels', and a file
+						without any edge is an error.
+		'-distributed K'	refinement by K worker processes, each one keeping the edges that point to one range of
+						nodes (see 'distributedf.h'). The fibers are written as with '-external', and as with it
+						the edgelist must give node IDs (no '-labels') and hold at least one edge.
+		'-transport T'	transport between the processes of '-distributed': 'shared' (shared memory, default) or
+						'socket' (Unix sockets), see 'transportf.h'.
+		'-labels'		the edgelist gives the nodes by labels ("%s %s %s\n" -> Source label/ Target label/ Type of
+						regulation), which are also used as node names. The label of each node ID is written to
+						'ARG1labels.dat' ("%d\t%s\n" -> Node ID/ Label), see 'labelsf.h'.
+		node ID			prints the incoming and outgoing neighbors of that node.
+
 	The result is stored in the 'partition' and 'null_partition' structures, together with the 'graph' structure. To check 
 	which data each one of this structures stores the user can refer to the 'structforfiber.h' module. In general, a partition 
 	stores all the fiber blocks and each block stores the list of node that belongs to it. The values of n and l are stored in 
@@ -42,11 +117,34 @@
 #include "fibrationf.h"
 #include "utilsforfiber.h"
 #include "structforfiber.h"
+#include "parallelf.h"
+#include "dagf.h"
+#include "reductionf.h"
+#include "quotientf.h"
+#include "dynamicsf.h"
+#include "labelsf.h"
+#include "reorderf.h"
+#include "externalf.h"
+#include "distributedf.h"
+#include "checkpointf.h"
+#include "historyf.h"
+#include "cachef.h"
+#include "fingerprintf.h"
+#include "verifyf.h"
+#include "classifyf.h"
+#include "orbitsf.h"
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
-void main(int argv, char** argc) 
+void USAGE()
+{
+	printf("Usage: ./fiber ARG1 -y|-n [options] [node ID], with the options listed at the top of 'main.c'\n");
+}
+
+int main(int argv, char** argc) 
 { 
-	int N, M;                         	// Number of nodes and edges of the network.
+	int N;                         		// Number of nodes of the network.
+	int i, k;
+	if(argv<3) { USAGE(); return 1; }
 	char net_edges[100] = "../Data/";   // File containing all the directed links in the network.
 	char nodename[100] = "../Data/";	// File containing all the nodes name.
 	strcat(net_edges, argc[1]);
@@ -54,72 +152,457 @@ void main(int argv, char** argc)
 	strcat(nodename, argc[1]);
 	strcat(nodename, "nameID.dat");
 
-	// From the edgelist get the number of nodes in the network.
-	N = GetNodeNumber(net_edges);
-
 	//// Check if it is necessary to check for the file containing names for the nodes ////
 	int nodename_bool;
 	if(strcmp(argc[2], "-y")==0) nodename_bool = 1;
 	else nodename_bool = 0;
+
+	int arg;
+	int nthreads = 1;
+	int dag_bool = 0;
+	int reduce_bool = 0;
+	int quotient_bool = 0;
+	int fingerprint_bool = 0;
+	int orbits_bool = 0;
+	int verify_bool = 0;
+	int classify_bool = 0;
+	CLASSFILTER filter = DEFAULT_CLASSFILTER();
+	char* filter_nodes = NULL;
+	char* reference_file = NULL;
+	char* diff_file = NULL;
+	int ode_steps = 0;
+	int boolean_steps = 0;
+	int lift_bool = 0;
+	int compare_bool = 0;
+	DYNPARAMS params = DEFAULT_DYNPARAMS();
+	char* initial_file = NULL;
+	int labels_bool = 0;
+	int reorder_mode = REORDER_NONE;
+	long long external_budget = 0;
+	int nworkers = 0;
+	char* checkpoint_file = NULL;
+	double checkpoint_interval = 0.0;
+	int history_bool = 0;
+	int history_depth = -1;
+	int separation[2] = {-1, -1};
+	char* cache_dir = NULL;
+	long long cache_budget = 256LL << 20;
+	char* transport_name = "shared";
+	int node = -1;
+	for(arg=3; arg<argv; arg++)
+	{
+		if(strcmp(argc[arg], "-t")==0 && arg+1<argv) nthreads = NUMBER_OF_THREADS(atoi(argc[++arg]));
+		else if(strcmp(argc[arg], "-dag")==0) dag_bool = 1;
+		else if(strcmp(argc[arg], "-reduce")==0) reduce_bool = 1;
+		else if(strcmp(argc[arg], "-quotient")==0) quotient_bool = 1;
+		else if(strcmp(argc[arg], "-verify")==0) verify_bool = 1;
+		else if(strcmp(argc[arg], "-reference")==0 && arg+1<argv) { verify_bool = 1; reference_file = argc[++arg]; }
+		else if(strcmp(argc[arg], "-classify")==0) classify_bool = 1;
+		else if(strcmp(argc[arg], "-min-size")==0 && arg+1<argv) { classify_bool = 1; filter.min_size = atoi(argc[++arg]); }
+		else if(strcmp(argc[arg], "-nodes")==0 && arg+1<argv) { classify_bool = 1; filter_nodes = argc[++arg]; }
+		else if(strcmp(argc[arg], "-scc")==0 && arg+1<argv) { classify_bool = 1; filter.scc_node = atoi(argc[++arg]); }
+		else if(strcmp(argc[arg], "-fingerprint")==0) fingerprint_bool = 1;
+		else if(strcmp(argc[arg], "-diff")==0 && arg+1<argv) diff_file = argc[++arg];
+		else if(strcmp(argc[arg], "-orbits")==0) orbits_bool = 1;
+		else if(strcmp(argc[arg], "-ode")==0 && arg+1<argv) ode_steps = atoi(argc[++arg]);
+		else if(strcmp(argc[arg], "-boolean")==0 && arg+1<argv) boolean_steps = atoi(argc[++arg]);
+		else if(strcmp(argc[arg], "-lift")==0) lift_bool = 1;
+		else if(strcmp(argc[arg], "-compare")==0) compare_bool = 1;
+		else if(strcmp(argc[arg], "-initial")==0 && arg+1<argv) initial_file = argc[++arg];
+		else if(strcmp(argc[arg], "-params")==0 && arg+1<argv)
+		{
+			if(PARSE_DYNPARAMS(argc[++arg], &params)==0) { printf("ERROR: '-params' takes basal,gamma,K,hill,dt\n"); return 1; }
+		}
+		else if(strcmp(argc[arg], "-labels")==0) labels_bool = 1;
+		else if(strcmp(argc[arg], "-reorder")==0 && arg+1<argv)
+		{
+			reorder_mode = REORDER_MODE(argc[++arg]);
+			if(reorder_mode<0) { printf("ERROR: unknown ordering %s ('degree', 'rcm' or 'component')\n", argc[arg]); return 1; }
+		}
+		else if(strcmp(argc[arg], "-external")==0 && arg+1<argv) external_budget = atoll(argc[++arg]) << 20;
+		else if(strcmp(argc[arg], "-checkpoint")==0 && arg+2<argv)
+		{
+			checkpoint_file = argc[++arg];
+			checkpoint_interval = atof(argc[++arg]);
+		}
+		else if(strcmp(argc[arg], "-history")==0) history_bool = 1;
+		else if(strcmp(argc[arg], "-depth")==0 && arg+1<argv) { history_bool = 1; history_depth = atoi(argc[++arg]); }
+		else if(strcmp(argc[arg], "-separation")==0 && arg+2<argv)
+		{
+			history_bool = 1;
+			separation[0] = atoi(argc[++arg]);
+			separation[1] = atoi(argc[++arg]);
+		}
+		else if(strcmp(argc[arg], "-cache")==0 && arg+1<argv) cache_dir = argc[++arg];
+		else if(strcmp(argc[arg], "-cache-size")==0 && arg+1<argv) cache_budget = atoll(argc[++arg]) << 20;
+		else if(strcmp(argc[arg], "-distributed")==0 && arg+1<argv) nworkers = atoi(argc[++arg]);
+		else if(strcmp(argc[arg], "-transport")==0 && arg+1<argv) transport_name = argc[++arg];
+		else if(IS_NODE_ID(argc[arg])) node = atoi(argc[arg]);
+		else
+		{
+			// Unknown options and options missing their values are not taken as node IDs.
+			printf("ERROR: unknown option or missing value: %s\n", argc[arg]);
+			USAGE();
+			return 1;
+		}
+	}
+	if(checkpoint_file!=NULL && (nthreads>1 || dag_bool==1 || reduce_bool==1 || reorder_mode!=REORDER_NONE))
+	{
+		printf("ERROR: '-checkpoint' runs the serial refinement, without '-t', '-dag', '-reduce' or '-reorder'\n");
+		return 1;
+	}
+	if(external_budget>0 && labels_bool==1)
+	{
+		printf("ERROR: '-external' reads node IDs, without '-labels'\n");
+		return 1;
+	}
+	if(nworkers>0 && labels_bool==1)
+	{
+		printf("ERROR: '-distributed' reads node IDs, without '-labels'\n");
+		return 1;
+	}
+	///////////////////////////////////////////////////////////////////////////////////////
+
+	////////////////////////// OUT-OF-CORE AND DISTRIBUTED REFINEMENT //////////////////////////
+	// The edges stay on disk, next to the edgelist file, and the network is never built.
+	if(external_budget>0)
+	{
+		char external_fibers[100] = "../Data/";
+		strcat(external_fibers, argc[1]);
+		strcat(external_fibers, "nodefiber.dat");
+		EXTGRAPH* external = EXTERNAL_GRAPH(net_edges, "../Data", external_budget);
+		if(external==NULL) return 1;
+		int nsolitaire;
+		int* fibers = (int*)malloc((external->N>0 ? external->N : 1)*sizeof(int));
+		int nfibers = EXTERNAL_REFINEMENT(external, fibers, &nsolitaire);
+		WRITE_NODE_FIBERS(external_fibers, fibers, external->N);
+		printf("%d nodes, %lld edges, %d fibers (%d solitaire)\n", external->N, external->nE, nfibers, nsolitaire);
+		free(fibers);
+		FreeExternalGraph(external);
+		return 0;
+	}
+
+	// The edges are split among 'nworkers' processes, each one reading its own part.
+	if(nworkers>0)
+	{
+		char distributed_fibers[100] = "../Data/";
+		strcat(distributed_fibers, argc[1]);
+		strcat(distributed_fibers, "nodefiber.dat");
+		TRANSPORT* transport = CreateTransport(transport_name, nworkers);
+		if(transport==NULL) { printf("ERROR: unknown transport %s\n", transport_name); return 1; }
+		int* fibers;
+		int nsolitaire;
+		int nfibers = DISTRIBUTED_REFINEMENT(net_edges, transport, &fibers, &N, &nsolitaire);
+		transport->close(transport);
+		if(nfibers<0) return 1;
+		WRITE_NODE_FIBERS(distributed_fibers, fibers, N);
+		printf("%d nodes, %d fibers (%d solitaire) with %d workers\n", N, nfibers, nsolitaire, nworkers);
+		free(fibers);
+		return 0;
+	}
 	///////////////////////////////////////////////////////////////////////////////////////
 
     // Creates the network for N nodes and defines its structure with the given edgelist file.
-	int** edges;
-	int* components = (int*)malloc(N*sizeof(int));
-	Graph* graph = createGraph(N, nodename, nodename_bool);
-	edges = defineNetwork(edges, components, graph, net_edges);
+	int** edges = NULL;
+	int* components;
+	Graph* graph;
+	if(labels_bool==1)
+	{
+		// Node IDs and names are given by the labels of the edgelist.
+		char labels_file[100] = "../Data/";
+		strcat(labels_file, argc[1]);
+		strcat(labels_file, "labels.dat");
+		NODEDICT* dict = CreateDictionary();
+		edges = defineLabeledNetwork(edges, &components, &graph, dict, net_edges, nthreads);
+		if(edges==NULL) { FreeDictionary(dict); return 1; }
+		WRITE_LABELS(dict, labels_file);
+		FreeDictionary(dict);
+		N = graph->size;
+	}
+	else
+	{
+		// From the edgelist get the number of nodes in the network.
+		N = GetNodeNumber(net_edges);
+		components = (int*)malloc(N*sizeof(int));
+		graph = createGraph(N, nodename, nodename_bool);
+		edges = defineNetwork(edges, components, graph, net_edges, nthreads);
+	}
 	///////////////////////////////////////////////////////////////////////////////////////
 
 	/////////////////////// COARSEST REFINEMENT PARTITIONING ALGORITHM ////////////////////////
 	
-	// Define the initial partition as one block containing all operating nodes. 
+	// Define the initial partition and refine it until it is input-tree stable. Since blocks
+	// never cross weak components, each component is refined as an independent problem.
 	PART* partition = NULL;    
 	PART* null_partition = NULL;
-	PART* null_partition2 = NULL;
-	PREPROCESSING(&partition, &null_partition, &null_partition2, components, graph);
-
-	// Initialize the queue of blocks with the initial block above.
-	QBLOCK* qhead = NULL;
-	QBLOCK* qtail = NULL;
-	ENQUEUE_BLOCKS(&partition, &qhead, &qtail);
-	ENQUEUE_BLOCKS(&null_partition, &qhead, &qtail);
-	ENQUEUE_BLOCKS(&null_partition2, &qhead, &qtail);
-	//printAllPartition(null_partition2);
-
-	// Until L is empty, we procedure the splitting process.
-	BLOCK* CurrentSet;	
-	while(qhead)
-	{
-		CurrentSet = dequeue_block(&qhead, &qtail);
-		S_SPLIT(&partition, CurrentSet, graph, &qhead, &qtail);
-	}
-	int size = GetPartitionSize(partition) + GetPartitionSize(null_partition);
-	int nontrivial_fibers = GetFiberNumber1(partition, null_partition);
+	HISTORY* history = NULL;
+	// A network already refined with the same options is read from the cache.
+	unsigned long long cache_key = 0;
+	int cache_hit = 0;
+	char* cached_classes = NULL;
+	if(cache_dir!=NULL && history_bool==0)
+	{
+		cache_key = CACHE_KEY(graph, reorder_mode, dag_bool, reduce_bool);
+		cache_hit = CACHE_LOAD(cache_dir, cache_key, graph, &partition, &null_partition, &cached_classes);
+	}
+	if(history_bool==1)
+	{
+		history = CreateHistory(N);
+		HISTORY_REFINEMENT(&partition, &null_partition, components, graph, history);
+	}
+	else if(cache_hit==1) printf("Partition read from the cache (key %016llx)\n", cache_key);
+	else if(checkpoint_file!=NULL) CHECKPOINTED_REFINEMENT(&partition, &null_partition, components, graph, checkpoint_file, checkpoint_interval);
+	else if(reorder_mode!=REORDER_NONE) REORDERED_REFINEMENT(&partition, &null_partition, components, graph, nthreads, reorder_mode, dag_bool, reduce_bool);
+	else if(reduce_bool==1) REDUCED_REFINEMENT(&partition, &null_partition, components, graph, nthreads, dag_bool);
+	else if(dag_bool==1) DAG_REFINEMENT(&partition, &null_partition, components, graph, nthreads);
+	else if(graph->num_component>1) PARALLEL_REFINEMENT(&partition, &null_partition, components, graph, nthreads);
+	else REFINEMENT(&partition, &null_partition, components, graph);
+
+	// Split tree of the refinement and the queries on it.
+	if(history!=NULL)
+	{
+		char history_file[100] = "../Data/";
+		strcat(history_file, argc[1]);
+		strcat(history_file, "history.dat");
+		WRITE_HISTORY(history, history_file);
+		printf("%d blocks created in %d rounds\n", history->size, history->rounds);
+		if(history_depth>=0)
+		{
+			char depth_file[100] = "../Data/";
+			strcat(depth_file, argc[1]);
+			strcat(depth_file, "depth.dat");
+			int* blocks = (int*)malloc(N*sizeof(int));
+			int nblocks = HISTORY_PARTITION(history, history_depth, blocks);
+			WRITE_NODE_FIBERS(depth_file, blocks, N);
+			printf("%d blocks after round %d\n", nblocks, history_depth);
+			free(blocks);
+		}
+		if(separation[0]>=0 && separation[0]<N && separation[1]>=0 && separation[1]<N)
+		{
+			int round = HISTORY_SEPARATION(history, separation[0], separation[1]);
+			if(round<0) printf("Nodes %d and %d are in the same fiber\n", separation[0], separation[1]);
+			else printf("Nodes %d and %d were separated in round %d\n", separation[0], separation[1], round);
+		}
+		FreeHistory(history);
+	}
+
+	// Stability of the result against all its blocks and, with a reference, its coarseness.
+	if(verify_bool==1)
+	{
+		int nblocks, witness;
+		int* blocks = PARTITION_BLOCKS(partition, null_partition, N, &nblocks);
+		int unstable = VERIFY_STABILITY(graph, blocks, nblocks, &witness);
+		if(unstable==0) printf("The partition is input-tree stable (%d blocks)\n", nblocks);
+		else printf("The partition is NOT input-tree stable: %d unstable blocks (e.g., node %d)\n", unstable, witness);
+		if(reference_file!=NULL)
+		{
+			int nreference;
+			int* reference = READ_NODE_FIBERS(reference_file, N, &nreference);
+			if(reference==NULL) printf("ERROR in file reading");
+			else
+			{
+				int relation = COMPARE_PARTITIONS(blocks, nblocks, reference, nreference, N);
+				if(relation==PARTITION_EQUAL) printf("The partition is equal to the reference\n");
+				else if(relation==PARTITION_FINER) printf("The partition is finer than the reference: it is not the coarsest\n");
+				else if(relation==PARTITION_COARSER) printf("The partition is coarser than the reference\n");
+				else printf("The partition and the reference are not comparable\n");
+				free(reference);
+			}
+		}
+		free(blocks);
+	}
+
+	// Base graph of the fibration, built before 'partition' receives the classification data.
+	if(quotient_bool==1 || ode_steps>0 || boolean_steps>0 || fingerprint_bool==1 || diff_file!=NULL || orbits_bool==1)
+	{
+		QUOTIENT* quotient = BUILD_QUOTIENT(graph, partition, null_partition);
+		if(quotient_bool==1)
+		{
+			char quotient_edges[100] = "../Data/";
+			char quotient_fibers[100] = "../Data/";
+			char quotient_binary[100] = "../Data/";
+			strcat(quotient_edges, argc[1]);
+			strcat(quotient_edges, "quotient.dat");
+			strcat(quotient_fibers, argc[1]);
+			strcat(quotient_fibers, "nodefiber.dat");
+			strcat(quotient_binary, argc[1]);
+			strcat(quotient_binary, "quotient.bin");
+			WRITE_QUOTIENT_TEXT(quotient, quotient_edges, quotient_fibers);
+			WRITE_QUOTIENT_BINARY(quotient, quotient_binary);
+		}
+		if(fingerprint_bool==1 || diff_file!=NULL)
+		{
+			FPRINT* fingerprints = FIBER_FINGERPRINTS(graph, quotient);
+			printf("Partition fingerprint: %016llx\n", fingerprints->partition);
+			if(fingerprint_bool==1)
+			{
+				char fingerprint_file[100] = "../Data/";
+				strcat(fingerprint_file, argc[1]);
+				strcat(fingerprint_file, "fingerprint.dat");
+				WRITE_FINGERPRINTS(fingerprints, graph, fingerprint_file);
+			}
+			if(diff_file!=NULL)
+			{
+				FPRINT* previous = READ_FINGERPRINTS(diff_file);
+				if(previous==NULL) printf("ERROR in file reading");
+				else
+				{
+					int counts[7];
+					char diff_output[100] = "../Data/";
+					strcat(diff_output, argc[1]);
+					strcat(diff_output, "diff.dat");
+					FINGERPRINT_DIFF(previous, fingerprints, diff_output, counts);
+					printf("Fibers unchanged: %d, changed: %d, split: %d, merged: %d, regrouped: %d, removed: %d, added: %d\n",
+						counts[0], counts[1], counts[2], counts[3], counts[4], counts[5], counts[6]);
+					FreeFingerprints(previous);
+				}
+			}
+			FreeFingerprints(fingerprints);
+		}
+		if(orbits_bool==1)
+		{
+			char orbits_file[100] = "../Data/";
+			strcat(orbits_file, argc[1]);
+			strcat(orbits_file, "orbits.dat");
+			double log_size;
+			long long generators;
+			int* orbit = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+			int norbits = AUTOMORPHISM_ORBITS(graph, quotient, orbit, &log_size, &generators);
+			int* orbit_size = (int*)calloc((norbits>0 ? norbits : 1), sizeof(int));
+			int nontrivial_orbits = 0;
+			for(i=0; i<N; i++) if(++orbit_size[orbit[i]]==2) nontrivial_orbits++;
+			WRITE_ORBITS(orbits_file, orbit, N);
+			printf("%d orbits (%d nontrivial), %lld generators, log10 of the group size: %lf\n", norbits, nontrivial_orbits, generators, log_size);
+			free(orbit_size);
+			free(orbit);
+		}
+		// Initial state of the nodes and of the fibers.
+		double* node_state = NULL;
+		if(initial_file!=NULL && (ode_steps>0 || boolean_steps>0))
+		{
+			node_state = READ_NODE_STATE(initial_file, N);
+			if(node_state==NULL) printf("ERROR in file reading");
+			else if(IS_SYNCHRONIZED(quotient, node_state)==0)
+				printf("The initial state is not constant inside the fibers: the fibers start from the average of their nodes\n");
+		}
+		// The network with one fiber per node, to compare with.
+		QUOTIENT* full = NULL;
+		if(compare_bool==1 && (ode_steps>0 || boolean_steps>0)) full = GRAPH_AS_QUOTIENT(graph);
+		if(ode_steps>0)
+		{
+			char ode_file[100] = "../Data/";
+			strcat(ode_file, argc[1]);
+			strcat(ode_file, "ode.dat");
+			int nrecords;
+			double* x0 = (node_state!=NULL) ? PROJECT_STATE(quotient, node_state) : (double*)calloc(quotient->size, sizeof(double));
+			double* trajectory = INTEGRATE_QUOTIENT_ODE(quotient, x0, ode_steps, 1, &params, &nrecords);
+			double* lifted = NULL;
+			if(lift_bool==1 || full!=NULL) lifted = LIFT_TRAJECTORY(quotient, trajectory, nrecords);
+			if(lift_bool==1) WRITE_TRAJECTORY(lifted, nrecords, N, params.dt, ode_file);
+			else WRITE_TRAJECTORY(trajectory, nrecords, quotient->size, params.dt, ode_file);
+			if(full!=NULL)
+			{
+				int nfull;
+				double* y0 = (node_state!=NULL) ? node_state : LIFT_TRAJECTORY(quotient, x0, 1);
+				double* node_trajectory = INTEGRATE_QUOTIENT_ODE(full, y0, ode_steps, 1, &params, &nfull);
+				printf("ODE: largest difference between the lifted and the full trajectories: %e\n", MAX_DIFFERENCE(lifted, node_trajectory, (size_t)nrecords*N));
+				if(node_state==NULL) free(y0);
+				free(node_trajectory);
+			}
+			free(lifted);
+			free(trajectory);
+			free(x0);
+		}
+		if(boolean_steps>0)
+		{
+			char boolean_file[100] = "../Data/";
+			strcat(boolean_file, argc[1]);
+			strcat(boolean_file, "boolean.dat");
+			int* s0 = (int*)malloc((quotient->size)*sizeof(int));
+			int* node_s0 = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+			if(node_state!=NULL)
+			{
+				// A fiber starts from 1 when most of its nodes do.
+				double* active = (double*)malloc((N>0 ? N : 1)*sizeof(double));
+				for(i=0; i<N; i++) { node_s0[i] = (node_state[i]>0.0); active[i] = node_s0[i]; }
+				double* fraction = PROJECT_STATE(quotient, active);
+				for(i=0; i<quotient->size; i++) s0[i] = (fraction[i]>=0.5);
+				free(fraction);
+				free(active);
+			}
+			else
+			{
+				for(i=0; i<quotient->size; i++) s0[i] = 1;
+				for(i=0; i<N; i++) node_s0[i] = 1;
+			}
+			int* states = BOOLEAN_QUOTIENT(quotient, s0, boolean_steps);
+			int* lifted = NULL;
+			if(lift_bool==1 || full!=NULL) lifted = LIFT_BOOLEAN(quotient, states, boolean_steps+1);
+			if(lift_bool==1) WRITE_BOOLEAN(lifted, boolean_steps+1, N, boolean_file);
+			else WRITE_BOOLEAN(states, boolean_steps+1, quotient->size, boolean_file);
+			if(full!=NULL)
+			{
+				long long mismatches = 0;
+				int* node_states = BOOLEAN_QUOTIENT(full, node_s0, boolean_steps);
+				for(k=0; k<(boolean_steps+1)*N; k++) mismatches += (lifted[k]!=node_states[k]);
+				printf("Boolean: %lld node states of the lifted dynamics differ from the full one\n", mismatches);
+				free(node_states);
+			}
+			free(lifted);
+			free(states);
+			free(node_s0);
+			free(s0);
+		}
+		if(full!=NULL) FreeQuotient(full);
+		free(node_state);
+		FreeQuotient(quotient);
+	}
+
 	// 'partition' contains all the fibers, except the solitaire ones.
 
 	/////////////////////////////// FIBER STATISTICS ////////////////////////////////////
-	// Proper block unique indexation and external regulators initialization.
+	// Proper block unique indexation.
 	PART* current_part;
 	int index = 0;					
 	for(current_part=partition; current_part!=NULL; current_part=current_part->next)
-	{
-		current_part->regulators = NULL;	// Initialize the list of external regulators for each block.		
-		current_part->number_regulators = 0;
-		current_part->fundamental_number = 0.0;		
 		current_part->block->index = index++;		
-	}
 
-	// Defines number of external regulators and set list of external regulators for each block.
-	CALCULATE_REGULATORS(&partition, graph);
-	CALCULATE_REGULATORS(&null_partition, graph);
-	// Calculates branch ratio number for each fiber block.
-	CALC_BRANCHING(&partition, graph);
+	/*	The number of external regulators and the branch ratio are only calculated for the
+		fibers that were asked for, the other blocks keep l = 0 and n = 0.	*/
+	CLASSIFIER* classifier = NULL;
+	int cached_fibers = 0;
+	if(classify_bool==1)
+	{
+		char classification_file[100] = "../Data/";
+		strcat(classification_file, argc[1]);
+		strcat(classification_file, "classification.dat");
+		if(filter_nodes!=NULL)
+		{
+			char* token;
+			filter.nodes = (int*)malloc((strlen(filter_nodes)/2+1)*sizeof(int));
+			for(token=strtok(filter_nodes, ","); token!=NULL; token=strtok(NULL, ",")) filter.nodes[filter.nnodes++] = atoi(token);
+		}
+		classifier = CreateClassifier(partition, null_partition, graph);
+		CACHE_MARK_CLASSIFIED(classifier, cached_classes);
+		cached_fibers = CACHE_CLASSIFIED(classifier);
+		int* selected = (int*)malloc((classifier->size>0 ? classifier->size : 1)*sizeof(int));
+		int nselected = CLASSIFY_FIBERS(classifier, &filter, selected);
+		WRITE_CLASSIFICATION(classifier, selected, nselected, classification_file);
+		printf("%d fibers classified\n", nselected);
+		free(selected);
+		free(filter.nodes);
+	}
+	// The new results are added to the cache: the partition on a miss, the fibers classified
+	// by this run on a hit.
+	if(cache_dir!=NULL && history_bool==0 && (cache_hit==0 || (classifier!=NULL && CACHE_CLASSIFIED(classifier)>cached_fibers)))
+		if(CACHE_STORE(cache_dir, cache_key, graph, partition, null_partition, classifier, cache_budget)==0) printf("ERROR in file writing");
+	if(classifier!=NULL) FreeClassifier(classifier);
+	free(cached_classes);
 	//DEF_BRANCH_RATIO(&partition, graph);
 	//////////////////////////////////////////////////////////////////////////////////////////
 	//////////////////////////////////////////////////////////////////////
 	
 	////// 'nodefibers' directly relates nodes with their fiber index ///////
-	int i, j, k;
 	NODELIST* nodelist;	
 	int total_nodes = 0;	// Number of nodes inside non-trivial fibers.
 	int* nodefibers = (int*)malloc(N*sizeof(int));
@@ -141,16 +624,17 @@ void main(int argv, char** argc)
 	/* Fiber blocks and classification info */ //ShowInfo(partition, 0);
 
 	/*	Show the number of non-trivial fibers	*/
-	//printf("%d %d\n", nontrivial_fibers, total_nodes);
+	//printf("%d %d\n", GetFiberNumber1(partition, null_partition), total_nodes);
 	
-	int node = atoi(argc[3]);
-	PrintInNeighbors(graph, node);
-	PrintOutNeighbors(graph, node);
-	int n = GETNin(graph, node);
+	if(node>=0)
+	{
+		PrintInNeighbors(graph, node);
+		PrintOutNeighbors(graph, node);
+	}
 	//printf("%d\n", n);
 	/////////////////////////////////////////////////////////////////////////////
 
 
     ////////////////////////////////////////////////////////////////////////////////////
-
+	return 0;
 }
@@ -0,0 +1,107 @@
+/*	Degree-preserving randomization of a network, used as null model for the fibers.
+	The edges are kept in the order of the outgoing CSR, as (source, target) pairs in one
+	array ready for 'FIBER_LOAD_EDGES', and the swaps are done in place on it: two edges of the same type, s1 -> t1 and s2 -> t2, exchange their targets, becoming
+	s1 -> t2 and s2 -> t1. Since the sources keep their rows of the CSR and the targets
+	are only exchanged, every node keeps its in-degree and out-degree of each type. A swap
+	is rejected when it would create a self-loop or an edge that already exists with the
+	same type, so the randomized network stays simple whenever the original one is. The
+	self-loops (autoregulations) of the original network are never swapped, so every
+	replicate keeps the same autoregulated nodes.
+
+	The model ('NULLMODEL') holds the arrays that do not change with the swaps (rows of
+	the CSR, type of each edge and the edges of each type) and is shared by all the
+	threads; each replicate only needs its own copy of the pairs array.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef NULLMODELF_H
+#define NULLMODELF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "randomnetf.h"
+
+struct NullModel
+{
+	int N;
+	int nE;
+	int* out_start;		// edges of node 'v' are 'out_start[v]' to 'out_start[v+1]-1'.
+	int* out_type;
+	int type_start[5];	// edges of type 't' are 'type_edges[type_start[t+1]]' to 'type_edges[type_start[t+2]-1]'.
+	int* type_edges;
+};
+typedef struct NullModel NULLMODEL;
+
+/*	The model keeps its own copies of 'out_start' and 'out_type'. */
+extern NULLMODEL* CreateNullModel(int N, int nE, int* out_start, int* out_type)
+{
+	int j, t;
+	NULLMODEL* model = (NULLMODEL*)malloc(sizeof(NULLMODEL));
+	model->N = N;
+	model->nE = nE;
+	model->out_start = (int*)malloc((N+1)*sizeof(int));
+	model->out_type = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	model->type_edges = (int*)malloc((nE>0 ? nE : 1)*sizeof(int));
+	memcpy(model->out_start, out_start, (N+1)*sizeof(int));
+	memcpy(model->out_type, out_type, nE*sizeof(int));
+
+	int fill[4];
+	for(t=0; t<5; t++) model->type_start[t] = 0;
+	for(j=0; j<nE; j++) model->type_start[out_type[j]+2]++;
+	for(t=0; t<4; t++) model->type_start[t+1] += model->type_start[t];
+	for(t=0; t<4; t++) fill[t] = model->type_start[t];
+	for(j=0; j<nE; j++) model->type_edges[fill[out_type[j]+1]++] = j;
+	return model;
+}
+
+extern void FreeNullModel(NULLMODEL* model)
+{
+	free(model->out_start);
+	free(model->out_type);
+	free(model->type_edges);
+	free(model);
+}
+
+/*	Checks if 'source' already points to 'target' by an edge of type 'type'. */
+int HAS_TYPED_EDGE(NULLMODEL* model, int* pairs, int source, int target, int type)
+{
+	int j;
+	for(j=model->out_start[source]; j<model->out_start[source+1]; j++)
+		if(pairs[2*j+1]==target && model->out_type[j]==type) return 1;
+	return 0;
+}
+
+/*	Tries 'nswaps' swaps on the edges 'pairs' (target of the edge 'j' in 'pairs[2*j+1]')
+	and returns the number of accepted ones.	*/
+extern long TYPED_EDGE_SWAPS(NULLMODEL* model, int* pairs, long nswaps, RNGSTATE* state)
+{
+	long k;
+	long accepted = 0;
+	int e1, e2, s1, s2, t1, t2, type, ntype;
+	if(model->nE<2) return 0;
+	for(k=0; k<nswaps; k++)
+	{
+		e1 = RANDOM_INT(state, model->nE);
+		type = model->out_type[e1];
+		ntype = model->type_start[type+2] - model->type_start[type+1];
+		e2 = model->type_edges[model->type_start[type+1] + RANDOM_INT(state, ntype)];
+		s1 = pairs[2*e1];
+		s2 = pairs[2*e2];
+		t1 = pairs[2*e1+1];
+		t2 = pairs[2*e2+1];
+		if(e1==e2 || t1==t2 || s1==s2) continue;
+		if(s1==t1 || s2==t2) continue;
+		if(s1==t2 || s2==t1) continue;
+		if(HAS_TYPED_EDGE(model, pairs, s1, t2, type) || HAS_TYPED_EDGE(model, pairs, s2, t1, type)) continue;
+		pairs[2*e1+1] = t2;
+		pairs[2*e2+1] = t1;
+		accepted++;
+	}
+	return accepted;
+}
+
+#endif
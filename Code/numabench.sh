@@ -0,0 +1,85 @@
+#!/bin/sh
+# Throughput of the parallel refinement ('-t K', see 'parallelf.h') on one and on two memory
+# domains. The network of ../Data given as ARG1 is copied COPIES times, each copy with its own
+# node IDs, into ../Data/NUMABENCHedgelist.dat, so the refinement has many weak components to
+# share among the domains. The same copies chained by one edge from each copy to the next one
+# (../Data/NUMABENCHGIANTedgelist.dat) form one giant weak component instead.
+#
+#	Usage:	sh numabench.sh [ARG1] [COPIES] [K] [RUNS]		(ECOLI 50 8 3 by default)
+#
+# Each layout is refined RUNS times with K threads, the process pinned by 'taskset' to the
+# processors of the first domain, then of the first two domains ('/sys/devices/system/node'),
+# and the best wall time is reported with the edges refined per second, in total and per
+# domain. The threads only share the work across weak components, so the giant component is
+# refined by one thread whatever the number of domains, and is expected to gain nothing from
+# the second one. On a machine with one domain only the first line of each layout is given.
+# The generated edgelists and outputs are removed at the end.
+
+cd "$(dirname "$0")" || exit 1
+NET=${1:-ECOLI}
+COPIES=${2:-50}
+THREADS=${3:-8}
+RUNS=${4:-3}
+NODES=/sys/devices/system/node
+
+[ -f "../Data/${NET}edgelist.dat" ] || { echo "ERROR: ../Data/${NET}edgelist.dat not found"; exit 1; }
+command -v taskset > /dev/null || { echo "ERROR: taskset not found"; exit 1; }
+make -s fiber || exit 1
+
+# Copies with node IDs shifted by the largest ID plus one; GIANT=1 also links each copy to the next.
+awk -v copies="$COPIES" 'NF >= 3 { s[n] = $1; t[n] = $2; type[n++] = $3; if($1 > max) max = $1; if($2 > max) max = $2 }
+	END {
+		for(c = 0; c < copies; c++) for(e = 0; e < n; e++) print s[e] + c*(max+1) "\t" t[e] + c*(max+1) "\t" type[e] > "../Data/NUMABENCHedgelist.dat"
+		for(c = 0; c < copies; c++)
+		{
+			for(e = 0; e < n; e++) print s[e] + c*(max+1) "\t" t[e] + c*(max+1) "\t" type[e] > "../Data/NUMABENCHGIANTedgelist.dat"
+			if(c+1 < copies) print s[0] + c*(max+1) "\t" s[0] + (c+1)*(max+1) "\tpositive" > "../Data/NUMABENCHGIANTedgelist.dat"
+		}
+	}' "../Data/${NET}edgelist.dat"
+
+# Processors of the first D domains, separated by commas (every processor without the folder).
+cpus_of()
+{
+	if [ -r "$NODES/online" ]
+	then
+		for node in $(awk -F ',' '{ for(i = 1; i <= NF; i++) { split($i, r, "-"); if(r[2] == "") r[2] = r[1]; for(k = r[1]; k <= r[2]; k++) print k } }' "$NODES/online" | head -n "$1")
+		do
+			cat "$NODES/node$node/cpulist"
+		done | paste -s -d ','
+	else
+		echo "0-$(($(getconf _NPROCESSORS_ONLN)-1))"
+	fi
+}
+
+now()
+{
+	date +%s.%N
+}
+
+DOMAINS=1
+[ -r "$NODES/online" ] && DOMAINS=$(awk -F ',' '{ for(i = 1; i <= NF; i++) { split($i, r, "-"); n += (r[2] == "") ? 1 : r[2]-r[1]+1 } } END { print n }' "$NODES/online")
+[ "$DOMAINS" -gt 2 ] && DOMAINS=2
+
+echo "$NET x $COPIES, $THREADS threads, best of $RUNS runs"
+printf "layout\tdomains\tcpus\tedges\tseconds\tedges/s\tedges/s per domain\n"
+for layout in NUMABENCH NUMABENCHGIANT
+do
+	edges=$(wc -l < "../Data/${layout}edgelist.dat")
+	for domains in $(seq 1 "$DOMAINS")
+	do
+		cpus=$(cpus_of "$domains")
+		best=
+		for run in $(seq 1 "$RUNS")
+		do
+			start=$(now)
+			taskset -c "$cpus" ./fiber "$layout" -n -t "$THREADS" > /dev/null || { echo "ERROR: $layout run failed"; break; }
+			best=$(awk -v a="$start" -v b="$(now)" -v best="$best" 'BEGIN { t = b - a; if(best == "" || t < best) best = t; print best }')
+		done
+		[ -n "$best" ] || continue
+		awk -v l="$layout" -v d="$domains" -v c="$cpus" -v e="$edges" -v t="$best" \
+			'BEGIN { printf "%s\t%d\t%s\t%d\t%.3f\t%.0f\t%.0f\n", (l == "NUMABENCH") ? "components" : "giant", d, c, e, t, e/t, e/t/d }'
+	done
+done
+[ "$DOMAINS" -lt 2 ] && echo "One memory domain: the second domain can not be measured on this machine."
+
+rm -f ../Data/NUMABENCH*
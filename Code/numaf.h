@@ -0,0 +1,161 @@
+/*	Memory domains (NUMA nodes) of the machine and the placement of the threads on them.
+	On a server with several sockets, each socket reaches its own memory faster than the
+	memory of the others, and Linux places a page in the domain of the thread that first
+	writes it. So a thread kept on the processors of one domain works on local memory for
+	everything it allocates and fills itself.
+
+	The domains listed in '/sys/devices/system/node/online' (e.g. "0-1") are read from
+	'/sys/devices/system/node/nodeK/cpulist' (e.g. "0-11,24-35"), keeping only the
+	processors the process may run on (its affinity mask, as set by 'taskset' or the batch
+	system). Domains without such processors are left out. Without that folder, or on other
+	systems, all the processors form one domain and the threads are not pinned. The
+	topology is read once, by the first call of 'NUMA_TOPOLOGY', and shared by all the
+	later ones, so a change of the affinity mask after that call is not seen.
+
+	Only the placement was checked on machines with one domain and on simulated topologies
+	(the fibers do not depend on it); the scaling across real sockets has not been
+	measured here. 'numabench.sh' measures it: the throughput of '-t K' pinned to one and
+	to two domains, on many weak components and on one giant component. The threads only
+	share whole weak components ('parallelf.h'), so a network made of one giant component
+	is refined by one thread in one domain and gets nothing from the other domains.
+
+	The affinity is set through the system calls themselves, since the 'cpu_set_t' macros
+	of the C library would need '_GNU_SOURCE' to be defined before the first include of
+	every program using these modules.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef NUMAF_H
+#define NUMAF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#define NUMA_MAX_CPUS 4096
+#define NUMA_MASK_WORDS (NUMA_MAX_CPUS/(8*sizeof(unsigned long)))
+
+struct NumaTopology
+{
+	int ndomains;
+	int* cpu_start;		// processors of domain 'd' are 'cpus[cpu_start[d]]' to 'cpus[cpu_start[d+1]-1]'.
+	int* cpus;
+	int ncpus;
+};
+typedef struct NumaTopology NUMATOPO;
+
+/*	Affinity mask of the calling thread. Returns zero if it can not be read. */
+int NUMA_GET_MASK(unsigned long* mask)
+{
+	memset(mask, 0, NUMA_MASK_WORDS*sizeof(unsigned long));
+#ifdef __linux__
+	if(syscall(SYS_sched_getaffinity, 0, NUMA_MASK_WORDS*sizeof(unsigned long), mask)>0) return 1;
+#endif
+	return 0;
+}
+
+/*	Keeps the calling thread on the processors of 'domain'. Returns zero on failure. */
+extern int NUMA_PIN(NUMATOPO* topology, int domain)
+{
+#ifdef __linux__
+	int k;
+	unsigned long mask[NUMA_MASK_WORDS];
+	memset(mask, 0, sizeof(mask));
+	for(k=topology->cpu_start[domain]; k<topology->cpu_start[domain+1]; k++)
+		mask[topology->cpus[k]/(8*sizeof(unsigned long))] |= 1UL << (topology->cpus[k]%(8*sizeof(unsigned long)));
+	return syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask)==0;
+#else
+	return 0;
+#endif
+}
+
+/*	Adds to 'cpus' the numbers of a list ("0-3,8,10-11") below NUMA_MAX_CPUS and allowed
+	by 'mask' (all of them if 'mask' is NULL).	*/
+int NUMA_PARSE_CPULIST(char* list, unsigned long* mask, int* cpus, int n)
+{
+	char* token;
+	char* save;
+	int first, last, cpu;
+	for(token=strtok_r(list, ",\n", &save); token!=NULL; token=strtok_r(NULL, ",\n", &save))
+	{
+		if(sscanf(token, "%d-%d", &first, &last)!=2)
+		{
+			if(sscanf(token, "%d", &first)!=1) continue;
+			last = first;
+		}
+		for(cpu=first; cpu<=last && cpu<NUMA_MAX_CPUS; cpu++)
+			if(cpu>=0 && (mask==NULL || (mask[cpu/(8*sizeof(unsigned long))] >> (cpu%(8*sizeof(unsigned long))) & 1UL))) cpus[n++] = cpu;
+	}
+	return n;
+}
+
+/*	Reads the whole file 'filename' into 'list'. Returns zero if it can not be read. */
+int NUMA_READ_LIST(char* filename, char* list, int size)
+{
+	FILE* IN = fopen(filename, "r");
+	if(IN==NULL) return 0;
+	int length = fread(list, 1, size-1, IN);
+	fclose(IN);
+	list[length] = '\0';
+	return 1;
+}
+
+NUMATOPO* NUMA_CACHED_TOPOLOGY = NULL;
+pthread_once_t NUMA_TOPOLOGY_ONCE = PTHREAD_ONCE_INIT;
+
+/*	Reads the domains of the machine into 'NUMA_CACHED_TOPOLOGY'. */
+void NUMA_READ_TOPOLOGY()
+{
+	int k, cpu;
+	char filename[128];
+	char list[4096];
+	unsigned long mask[NUMA_MASK_WORDS];
+	NUMATOPO* topology = (NUMATOPO*)malloc(sizeof(NUMATOPO));
+	int* nodes = (int*)malloc(NUMA_MAX_CPUS*sizeof(int));
+	int nnodes = 0;
+	topology->ndomains = 0;
+	topology->ncpus = 0;
+	topology->cpus = (int*)malloc(NUMA_MAX_CPUS*sizeof(int));
+	int known = NUMA_GET_MASK(mask);
+	if(known && NUMA_READ_LIST("/sys/devices/system/node/online", list, sizeof(list)))
+		nnodes = NUMA_PARSE_CPULIST(list, NULL, nodes, 0);
+	topology->cpu_start = (int*)malloc((nnodes+2)*sizeof(int));
+	topology->cpu_start[0] = 0;
+	for(k=0; k<nnodes; k++)
+	{
+		snprintf(filename, 128, "/sys/devices/system/node/node%d/cpulist", nodes[k]);
+		if(NUMA_READ_LIST(filename, list, sizeof(list))==0) continue;
+		int n = NUMA_PARSE_CPULIST(list, mask, topology->cpus, topology->ncpus);
+		if(n==topology->ncpus) continue;
+		topology->ncpus = n;
+		topology->cpu_start[++topology->ndomains] = n;
+	}
+	free(nodes);
+	// One single domain with every allowed processor.
+	if(topology->ndomains==0)
+	{
+		for(cpu=0; known && cpu<NUMA_MAX_CPUS; cpu++)
+			if(mask[cpu/(8*sizeof(unsigned long))] >> (cpu%(8*sizeof(unsigned long))) & 1UL) topology->cpus[topology->ncpus++] = cpu;
+		topology->ndomains = 1;
+		topology->cpu_start[1] = topology->ncpus;
+	}
+	NUMA_CACHED_TOPOLOGY = topology;
+}
+
+/*	Domains of the machine, restricted to the processors allowed to the process when it
+	was first called. The topology belongs to this module and must not be freed.	*/
+extern NUMATOPO* NUMA_TOPOLOGY()
+{
+	pthread_once(&NUMA_TOPOLOGY_ONCE, NUMA_READ_TOPOLOGY);
+	return NUMA_CACHED_TOPOLOGY;
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*	Brute-force check of the automorphism orbits computed by 'fiber ... -orbits' (see
+	'orbitsf.h'), used by 'make check'. Small random networks (2 to 7 nodes, with edge types
+	and multiple edges) are written to '../Data/ORBITCHECKedgelist.dat', half of them made
+	symmetric under a random permutation so that they have nontrivial orbits. For each one,
+	every permutation of the nodes is tried and the ones keeping the typed edges (with their
+	multiplicities) give the orbits and the size of the group, which are compared with the
+	orbits written by 'fiber' and the group size it prints.
+
+	Usage:	./orbitcheck [COUNT] [SEED]
+
+	with COUNT networks (200 by default) drawn from the seed SEED. Returns 1 if any network
+	gives different orbits or a different group size.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "randomnetf.h"
+
+#define MAX_NODES 7
+#define CHECK_NAME "ORBITCHECK"
+
+char* TYPE_NAMES[3] = {"positive", "negative", "dual"};
+
+/*	Number of edges 'count[a][b][t]' from a to b with type t. */
+typedef int EDGECOUNT[MAX_NODES][MAX_NODES][3];
+
+int FIND(int* parent, int v)
+{
+	while(parent[v]!=v) v = parent[v];
+	return v;
+}
+
+/*	Random network of n nodes; node n-1 always has an edge, so that 'fiber' reads n nodes. */
+void RANDOM_NETWORK(RNGSTATE* state, int n, EDGECOUNT count)
+{
+	int k, a, b, t;
+	memset(count, 0, sizeof(EDGECOUNT));
+	int m = RANDOM_INT(state, 2*n+1);
+	int ntypes = RANDOM_INT(state, 2)==0 ? 1 : 3;
+	for(k=0; k<m; k++)
+		count[RANDOM_INT(state, n)][RANDOM_INT(state, n)][RANDOM_INT(state, ntypes)]++;
+	if(RANDOM_INT(state, 2)==0)
+	{
+		// Symmetric under the cyclic group of a random permutation p: each edge is
+		// replaced by its images under p, p^2, ..., once each.
+		int p[MAX_NODES];
+		EDGECOUNT closed;
+		memset(closed, 0, sizeof(EDGECOUNT));
+		for(k=0; k<n; k++) p[k] = k;
+		for(k=n-1; k>0; k--) { int j = RANDOM_INT(state, k+1); int x = p[k]; p[k] = p[j]; p[j] = x; }
+		for(a=0; a<n; a++) for(b=0; b<n; b++) for(t=0; t<3; t++)
+		{
+			if(count[a][b][t]==0) continue;
+			int x = a, y = b;
+			do { closed[x][y][t] = 1; x = p[x]; y = p[y]; } while(x!=a || y!=b);
+		}
+		memcpy(count, closed, sizeof(EDGECOUNT));
+	}
+	for(a=0; a<n; a++) for(t=0; t<3; t++) if(count[a][n-1][t]>0 || count[n-1][a][t]>0) return;
+	count[n-1][n-1][0] = 1;
+}
+
+/*	Orbits ('orbit[v]' is the root of the orbit of v) and number of automorphisms. */
+long long BRUTE_ORBITS(int n, EDGECOUNT count, int* orbit)
+{
+	int p[MAX_NODES], c[MAX_NODES];
+	int a, b, t, k;
+	long long size = 0;
+	for(k=0; k<n; k++) { p[k] = k; c[k] = 0; orbit[k] = k; }
+	// Heap's algorithm over all the permutations.
+	k = 0;
+	while(1)
+	{
+		int automorphism = 1;
+		for(a=0; a<n && automorphism; a++) for(b=0; b<n && automorphism; b++) for(t=0; t<3; t++)
+			if(count[p[a]][p[b]][t]!=count[a][b][t]) { automorphism = 0; break; }
+		if(automorphism)
+		{
+			size++;
+			for(a=0; a<n; a++)
+			{
+				int x = FIND(orbit, a), y = FIND(orbit, p[a]);
+				if(x!=y) orbit[x] = y;
+			}
+		}
+		while(k<n && c[k]>=k) { c[k] = 0; k++; }
+		if(k>=n) break;
+		int j = (k%2==0) ? 0 : c[k];
+		int x = p[j]; p[j] = p[k]; p[k] = x;
+		c[k]++;
+		k = 0;
+	}
+	for(a=0; a<n; a++) orbit[a] = FIND(orbit, a);
+	return size;
+}
+
+/*	Runs 'fiber' on the network in the edgelist file. Returns zero if it fails. */
+int FIBER_ORBITS(int n, int* orbit, double* log_size)
+{
+	char line[512];
+	int v, o;
+	*log_size = -1.0;
+	FILE* PIPE = popen("./fiber " CHECK_NAME " -n -orbits", "r");
+	if(PIPE==NULL) return 0;
+	while(fgets(line, sizeof(line), PIPE)!=NULL)
+	{
+		char* found = strstr(line, "log10 of the group size: ");
+		if(found!=NULL) sscanf(found + strlen("log10 of the group size: "), "%lf", log_size);
+	}
+	if(pclose(PIPE)!=0 || *log_size<0.0) return 0;
+	for(v=0; v<n; v++) orbit[v] = -1;
+	FILE* IN = fopen("../Data/" CHECK_NAME "orbits.dat", "r");
+	if(IN==NULL) return 0;
+	while(fscanf(IN, "%d\t%d\n", &v, &o)==2) if(v>=0 && v<n) orbit[v] = o;
+	fclose(IN);
+	return 1;
+}
+
+int main(int argc, char** argv)
+{
+	int i, n, a, b, t;
+	int count_networks = (argc>1) ? atoi(argv[1]) : 200;
+	RNGSTATE state = (argc>2) ? strtoull(argv[2], NULL, 10) : DEFAULT_SEED;
+	int brute[MAX_NODES], orbit[MAX_NODES];
+	EDGECOUNT count;
+	int failed = 0;
+	for(i=0; i<count_networks; i++)
+	{
+		n = 2 + RANDOM_INT(&state, MAX_NODES-1);
+		RANDOM_NETWORK(&state, n, count);
+		FILE* OUT = fopen("../Data/" CHECK_NAME "edgelist.dat", "w");
+		if(OUT==NULL) { printf("ERROR in file writing"); return 1; }
+		for(a=0; a<n; a++) for(b=0; b<n; b++) for(t=0; t<3; t++)
+		{
+			int k;
+			for(k=0; k<count[a][b][t]; k++) fprintf(OUT, "%d\t%d\t%s\n", a, b, TYPE_NAMES[t]);
+		}
+		fclose(OUT);
+
+		long long size = BRUTE_ORBITS(n, count, brute);
+		double log_size;
+		int same = FIBER_ORBITS(n, orbit, &log_size);
+		// Same partition: two nodes share an orbit in one if and only if in the other.
+		for(a=0; a<n && same; a++) for(b=0; b<n; b++)
+			if((brute[a]==brute[b])!=(orbit[a]==orbit[b])) { same = 0; break; }
+		if(same && fabs(log_size - log10((double)size))>1e-6) same = 0;
+		if(same==0)
+		{
+			failed++;
+			printf("Network %d (%d nodes): orbits or group size differ from the brute force (%lld automorphisms)\n", i, n, size);
+		}
+	}
+	remove("../Data/" CHECK_NAME "edgelist.dat");
+	remove("../Data/" CHECK_NAME "orbits.dat");
+	printf("Orbits of %d random networks: %d differ from the brute force\n", count_networks, failed);
+	return failed>0;
+}
@@ -0,0 +1,880 @@
+/*	Orbits of the automorphism group of the network, by an individualization-refinement
+	search seeded with the fibers.
+
+	An automorphism maps each node to a node with an isomorphic input-tree, so every orbit
+	lies inside one class of the coarsest input-tree stable partition. The fibers given by
+	the refinement are a finer partition, since the nodes without inputs are kept as
+	solitaire fibers and the blocks never cross weak components. The classes are taken from
+	the base graph of the fibration: its nodes (the fibers) are refined from one single
+	block by the typed inputs, with their multiplicities, which costs O(F+Q) per round
+	instead of O(N+M), and each fiber takes the class of its base node.
+
+	The search is made on a reduced network. Two nodes with the same typed multiset of
+	inputs and the same typed multiset of outputs (twins) are exchanged by an automorphism,
+	so only one node of each twin class is kept, with the size of its class as a color
+	(the sink fans of gene regulatory networks are twin classes). The orbits of the reduced
+	network are expanded back to the twin classes.
+
+	The partition is an ordered partition of the nodes into cells, each cell being a range
+	of 'lab', refined to an equitable partition: all the nodes of a cell have the same
+	number of typed inputs from, and of typed outputs to, every cell. The refinement only
+	depends on the counts, not on the node labels, so it commutes with the automorphisms.
+	The search follows McKay (1981): a first path individualizes one node of the first
+	nontrivial cell and refines, until the partition is discrete (the first leaf).
+	Then, from the deepest level up, every other node of the target cell is individualized
+	in place of the one of the first path, and the subtree below it is searched for a leaf
+	that, matched position by position with the first leaf, gives an automorphism. The
+	subtrees whose partitions differ from the first path (number of cells and a hash of
+	the splits) are pruned, and so are the nodes already known to be in the orbit of the
+	node of the first path, or in the orbit of a node whose subtree had no automorphism.
+
+	Each cell of the partition is undone when the search goes back above the level at
+	which it was created, so the partition takes O(N) memory at any depth. The size of the
+	group is also given, as the product of the orbit sizes of the nodes of the first path
+	(in the stabilizer of the previous ones) and of the factorials of the twin classes.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef ORBITSF_H
+#define ORBITSF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "quotientf.h"
+
+#define ORBIT_TYPES 4		// edge type + 1: unknown, positive, negative, dual.
+
+/*	Directed graph with typed and weighted edges, in both CSR forms. */
+struct OrbitGraph
+{
+	int n;
+	int* in_start;
+	int* in_adj;
+	int* in_type;
+	int* in_weight;
+	int* out_start;
+	int* out_adj;
+	int* out_type;
+	int* out_weight;
+};
+typedef struct OrbitGraph ORBITGRAPH;
+
+/*	Ordered partition and the state of its refinement. The cells are identified by the
+	position where they start.	*/
+struct OrbitPartition
+{
+	int n;
+	int* lab;			// nodes, each cell being a contiguous range.
+	int* pos;			// position of each node in 'lab'.
+	int* cell;			// start of the cell of each position.
+	int* end;			// end of the cell starting at each position.
+	int* level;			// level at which the cell starting at each position was created.
+	int ncells;
+	int* trail;			// cells in the order of creation, undone in reverse order.
+	int ntrail;
+	int* queue;			// circular queue of splitter cells.
+	char* in_queue;
+	int qhead;
+	int qsize;
+	int nkeys;			// ORBIT_TYPES counts of inputs, and as many of outputs if 2*ORBIT_TYPES.
+	int* count;			// 'nkeys' counts for each node.
+	int* touched;
+	int ntouched;
+	char* is_touched;
+	int* marked;		// touched nodes of each cell (kept at its end).
+	int* split;
+	int nsplit;
+	unsigned long long hash;	// invariant of the last refinement.
+};
+typedef struct OrbitPartition ORBITPART;
+
+/////////////////////////////////////////////////////////////////////////
+//////////////////////////// ORBIT GRAPHS ///////////////////////////////
+
+/*	Builds the graph of the 'm' edges source[j] -> target[j] (types in 0..3). 'weight'
+	may be NULL for unit weights.	*/
+ORBITGRAPH* CreateOrbitGraph(int n, int m, int* source, int* target, int* type, int* weight)
+{
+	int j, v;
+	ORBITGRAPH* g = (ORBITGRAPH*)malloc(sizeof(ORBITGRAPH));
+	g->n = n;
+	g->in_start = (int*)calloc(n+1, sizeof(int));
+	g->out_start = (int*)calloc(n+1, sizeof(int));
+	g->in_adj = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	g->in_type = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	g->in_weight = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	g->out_adj = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	g->out_type = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	g->out_weight = (int*)malloc((m>0 ? m : 1)*sizeof(int));
+	for(j=0; j<m; j++) { g->in_start[target[j]+1]++; g->out_start[source[j]+1]++; }
+	for(v=0; v<n; v++) { g->in_start[v+1] += g->in_start[v]; g->out_start[v+1] += g->out_start[v]; }
+	int* in_fill = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	int* out_fill = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	memcpy(in_fill, g->in_start, n*sizeof(int));
+	memcpy(out_fill, g->out_start, n*sizeof(int));
+	for(j=0; j<m; j++)
+	{
+		int w = (weight!=NULL) ? weight[j] : 1;
+		int k = in_fill[target[j]]++;
+		g->in_adj[k] = source[j];
+		g->in_type[k] = type[j];
+		g->in_weight[k] = w;
+		k = out_fill[source[j]]++;
+		g->out_adj[k] = target[j];
+		g->out_type[k] = type[j];
+		g->out_weight[k] = w;
+	}
+	free(in_fill);
+	free(out_fill);
+	return g;
+}
+
+void FreeOrbitGraph(ORBITGRAPH* g)
+{
+	free(g->in_start);
+	free(g->in_adj);
+	free(g->in_type);
+	free(g->in_weight);
+	free(g->out_start);
+	free(g->out_adj);
+	free(g->out_type);
+	free(g->out_weight);
+	free(g);
+}
+
+/////////////////////////////////////////////////////////////////////////
+/////////////////////////// ORDERED PARTITION ///////////////////////////
+
+ORBITPART* CreateOrbitPartition(int n, int nkeys)
+{
+	int size = (n>0) ? n : 1;
+	ORBITPART* P = (ORBITPART*)malloc(sizeof(ORBITPART));
+	P->n = n;
+	P->lab = (int*)malloc(size*sizeof(int));
+	P->pos = (int*)malloc(size*sizeof(int));
+	P->cell = (int*)malloc(size*sizeof(int));
+	P->end = (int*)malloc(size*sizeof(int));
+	P->level = (int*)malloc(size*sizeof(int));
+	P->trail = (int*)malloc(size*sizeof(int));
+	P->queue = (int*)malloc(size*sizeof(int));
+	P->in_queue = (char*)calloc(size, sizeof(char));
+	P->nkeys = nkeys;
+	P->count = (int*)calloc((size_t)size*nkeys, sizeof(int));
+	P->touched = (int*)malloc(size*sizeof(int));
+	P->is_touched = (char*)calloc(size, sizeof(char));
+	P->marked = (int*)calloc(size, sizeof(int));
+	P->split = (int*)malloc(size*sizeof(int));
+	P->ncells = 0;
+	P->ntrail = 0;
+	P->qhead = 0;
+	P->qsize = 0;
+	P->ntouched = 0;
+	P->hash = 0;
+	return P;
+}
+
+void FreeOrbitPartition(ORBITPART* P)
+{
+	free(P->lab);
+	free(P->pos);
+	free(P->cell);
+	free(P->end);
+	free(P->level);
+	free(P->trail);
+	free(P->queue);
+	free(P->in_queue);
+	free(P->count);
+	free(P->touched);
+	free(P->is_touched);
+	free(P->marked);
+	free(P->split);
+	free(P);
+}
+
+void ORBIT_ENQUEUE(ORBITPART* P, int c)
+{
+	if(P->in_queue[c]) return;
+	P->queue[(P->qhead + P->qsize)%P->n] = c;
+	P->qsize++;
+	P->in_queue[c] = 1;
+}
+
+int ORBIT_DEQUEUE(ORBITPART* P)
+{
+	int c = P->queue[P->qhead];
+	P->qhead = (P->qhead + 1)%P->n;
+	P->qsize--;
+	P->in_queue[c] = 0;
+	return c;
+}
+
+/*	Initial partition: one cell for each color, in increasing order of color, all of them
+	in the queue.	*/
+void ORBIT_COLORING(ORBITPART* P, int* color)
+{
+	int v, p, c;
+	int n = P->n;
+	int ncolors = 0;
+	for(v=0; v<n; v++) if(color[v]+1>ncolors) ncolors = color[v]+1;
+	int* start = (int*)calloc(ncolors+1, sizeof(int));
+	for(v=0; v<n; v++) start[color[v]+1]++;
+	for(c=0; c<ncolors; c++) start[c+1] += start[c];
+	for(v=0; v<n; v++) { P->lab[start[color[v]]] = v; P->pos[v] = start[color[v]]++; }
+	free(start);
+	P->ncells = 0;
+	P->ntrail = 0;
+	for(p=0; p<n; p++)
+	{
+		if(p==0 || color[P->lab[p]]!=color[P->lab[p-1]])
+		{
+			c = p;
+			P->level[c] = 0;
+			P->ncells++;
+			ORBIT_ENQUEUE(P, c);
+		}
+		P->cell[p] = c;
+		P->end[c] = p+1;
+	}
+}
+
+/*	Compares two nodes by their counts, with the partition as context. */
+int cmp_orbit(int a, int b, void* context)
+{
+	ORBITPART* P = (ORBITPART*)context;
+	int* x = &P->count[(size_t)a*P->nkeys];
+	int* y = &P->count[(size_t)b*P->nkeys];
+	int k;
+	for(k=0; k<P->nkeys; k++) if(x[k]!=y[k]) return (x[k]<y[k]) ? -1 : 1;
+	return 0;
+}
+
+int cmp_start(const void* a, const void* b)
+{
+	return *(int*)a - *(int*)b;
+}
+
+void ORBIT_TOUCH(ORBITPART* P, int v, int key, int weight)
+{
+	if(P->is_touched[v]==0) { P->is_touched[v] = 1; P->touched[P->ntouched++] = v; }
+	P->count[(size_t)v*P->nkeys + key] += weight;
+}
+
+/*	New cell starting at position 'q', created at 'level'. */
+void ORBIT_NEW_CELL(ORBITPART* P, int q, int last, int level)
+{
+	int p;
+	P->end[q] = last;
+	P->level[q] = level;
+	for(p=q; p<last; p++) P->cell[p] = q;
+	P->trail[P->ntrail++] = q;
+	P->ncells++;
+}
+
+/*	Refines the partition until it is equitable, splitting the cells by the counts of
+	edges from (and, with 2*ORBIT_TYPES keys, to) each splitter cell of the queue. The
+	hash of the splits is kept in 'P->hash'.	*/
+void ORBIT_REFINE(ORBITPART* P, ORBITGRAPH* g, int level)
+{
+	int k, p, j, c, i;
+	while(P->qsize>0)
+	{
+		int s = ORBIT_DEQUEUE(P);
+		int s_end = P->end[s];
+		for(p=s; p<s_end; p++)
+		{
+			int u = P->lab[p];
+			for(j=g->out_start[u]; j<g->out_start[u+1]; j++) ORBIT_TOUCH(P, g->out_adj[j], g->out_type[j], g->out_weight[j]);
+			if(P->nkeys>ORBIT_TYPES)
+				for(j=g->in_start[u]; j<g->in_start[u+1]; j++) ORBIT_TOUCH(P, g->in_adj[j], ORBIT_TYPES + g->in_type[j], g->in_weight[j]);
+		}
+
+		// The touched nodes are moved to the end of their cells.
+		P->nsplit = 0;
+		for(k=0; k<P->ntouched; k++)
+		{
+			int v = P->touched[k];
+			c = P->cell[P->pos[v]];
+			if(P->marked[c]==0) P->split[P->nsplit++] = c;
+			int dest = P->end[c] - 1 - P->marked[c];
+			int from = P->pos[v];
+			int u = P->lab[dest];
+			P->lab[dest] = v;
+			P->lab[from] = u;
+			P->pos[u] = from;
+			P->pos[v] = dest;
+			P->marked[c]++;
+		}
+		// The cells are split in the order of their positions, so the result does not
+		// depend on the labels of the nodes.
+		qsort(P->split, P->nsplit, sizeof(int), cmp_start);
+		for(k=0; k<P->nsplit; k++)
+		{
+			c = P->split[k];
+			int last = P->end[c];
+			int nmarked = P->marked[c];
+			int begin = last - nmarked;
+			P->marked[c] = 0;
+			if(nmarked==1 && begin==c) continue;
+			SORT_INDICES(P->lab + begin, nmarked, cmp_orbit, P);
+			for(i=begin; i<last; i++) P->pos[P->lab[i]] = i;
+			if(begin==c && cmp_orbit(P->lab[c], P->lab[last-1], P)==0) continue;
+
+			// Pieces: the untouched nodes (if any), then each group of equal counts.
+			int was_queued = P->in_queue[c];
+			int largest = c;
+			int piece = begin;
+			if(begin==c) while(piece<last && cmp_orbit(P->lab[piece], P->lab[begin], P)==0) piece++;
+			int largest_size = piece - c;
+			P->end[c] = piece;
+			P->hash = MIX64(P->hash ^ ((unsigned long long)c << 32 | (unsigned long long)(piece - c)));
+			while(piece<last)
+			{
+				int next = piece + 1;
+				while(next<last && cmp_orbit(P->lab[next], P->lab[piece], P)==0) next++;
+				ORBIT_NEW_CELL(P, piece, next, level);
+				P->hash = MIX64(P->hash ^ ((unsigned long long)piece << 32 | (unsigned long long)(next - piece)));
+				for(i=0; i<P->nkeys; i++) P->hash = MIX64(P->hash ^ (unsigned long long)P->count[(size_t)P->lab[piece]*P->nkeys + i]);
+				if(was_queued) ORBIT_ENQUEUE(P, piece);
+				else if(next - piece>largest_size)
+				{
+					ORBIT_ENQUEUE(P, largest);
+					largest = piece;
+					largest_size = next - piece;
+				}
+				else ORBIT_ENQUEUE(P, piece);
+				piece = next;
+			}
+		}
+		for(k=0; k<P->ntouched; k++)
+		{
+			int v = P->touched[k];
+			P->is_touched[v] = 0;
+			memset(&(P->count[(size_t)v*P->nkeys]), 0, P->nkeys*sizeof(int));
+		}
+		P->ntouched = 0;
+	}
+}
+
+/*	Individualizes node 'v': it becomes a cell by itself, created at 'level', and enters
+	the queue.	*/
+void ORBIT_INDIVIDUALIZE(ORBITPART* P, int v, int level)
+{
+	int c = P->cell[P->pos[v]];
+	int last = P->end[c];
+	if(last - c==1) return;
+	int u = P->lab[c];
+	P->lab[P->pos[v]] = u;
+	P->pos[u] = P->pos[v];
+	P->lab[c] = v;
+	P->pos[v] = c;
+	ORBIT_NEW_CELL(P, c+1, last, level);
+	P->end[c] = c+1;
+	P->hash = MIX64(P->hash ^ (unsigned long long)c);
+	ORBIT_ENQUEUE(P, c);
+}
+
+/*	Undoes the cells created above 'level'. */
+void ORBIT_BACKTRACK(ORBITPART* P, int level)
+{
+	int p;
+	while(P->ntrail>0 && P->level[P->trail[P->ntrail-1]]>level)
+	{
+		int q = P->trail[--P->ntrail];
+		int previous = P->cell[q-1];
+		P->end[previous] = P->end[q];
+		for(p=q; p<P->end[q]; p++) P->cell[p] = previous;
+		P->ncells--;
+	}
+}
+
+/*	First cell larger than one (-1 if the partition is discrete), from the cell starting at
+	'from'. Below a node of the search tree the cells before its target are singletons, so
+	the scan starts there and costs O(N) along a whole path.	*/
+int ORBIT_TARGET(ORBITPART* P, int from)
+{
+	int c;
+	for(c=from; c<P->n; c=P->end[c]) if(P->end[c] - c>1) return c;
+	return -1;
+}
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////// SEED AND TWIN CLASSES /////////////////////////
+
+/*	Class of each fiber of 'quotient' in the coarsest input-tree stable partition of the
+	base graph, refined from a single block. Returns the number of classes.	*/
+int BASE_CLASSES(QUOTIENT* quotient, int* class_of)
+{
+	int f, j, m = 0;
+	int F = quotient->size;
+	if(F==0) return 0;
+	int* source = (int*)malloc((quotient->num_edges>0 ? quotient->num_edges : 1)*sizeof(int));
+	int* target = (int*)malloc((quotient->num_edges>0 ? quotient->num_edges : 1)*sizeof(int));
+	int* type = (int*)malloc((quotient->num_edges>0 ? quotient->num_edges : 1)*sizeof(int));
+	int* weight = (int*)malloc((quotient->num_edges>0 ? quotient->num_edges : 1)*sizeof(int));
+	// As in the refinement, the edges of unknown type are not considered.
+	for(f=0; f<F; f++)
+		for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+			if(quotient->in_type[j]>=0)
+			{
+				source[m] = quotient->in_adj[j];
+				target[m] = f;
+				type[m] = quotient->in_type[j] + 1;
+				weight[m++] = quotient->in_mult[j];
+			}
+	ORBITGRAPH* base = CreateOrbitGraph(F, m, source, target, type, weight);
+	free(source);
+	free(target);
+	free(type);
+	free(weight);
+
+	ORBITPART* P = CreateOrbitPartition(F, ORBIT_TYPES);
+	int* color = (int*)calloc(F, sizeof(int));
+	ORBIT_COLORING(P, color);
+	ORBIT_REFINE(P, base, 0);
+	int nclasses = 0;
+	int c;
+	for(c=0; c<F; c=P->end[c], nclasses++)
+		for(j=c; j<P->end[c]; j++) class_of[P->lab[j]] = nclasses;
+	free(color);
+	FreeOrbitPartition(P);
+	FreeOrbitGraph(base);
+	return nclasses;
+}
+
+int cmp_key64(const void* a, const void* b)
+{
+	long long x = *(long long*)a;
+	long long y = *(long long*)b;
+	return (x<y) ? -1 : (x>y);
+}
+
+/*	Orders two nodes by the hash of their neighbor keys (the context), then by ID. */
+int cmp_twin(int u, int v, void* context)
+{
+	unsigned long long* hash = (unsigned long long*)context;
+	if(hash[u]!=hash[v]) return (hash[u]<hash[v]) ? -1 : 1;
+	return u - v;
+}
+
+/*	Twin classes of 'graph': 'twin[v]' is the smallest node with the same typed multisets
+	of inputs and of outputs as 'v'. Returns the number of classes.	*/
+int TWIN_CLASSES(Graph* graph, int* twin)
+{
+	int N = graph->size;
+	int v, j, k;
+	long long M = graph->num_edges;
+	// Node 'v' has its input keys and then its output keys at 'keys[start[v]..start[v+1]-1]'.
+	int* start = (int*)malloc((N+1)*sizeof(int));
+	long long* keys = (long long*)malloc((2*M>0 ? 2*M : 1)*sizeof(long long));
+	unsigned long long* hash = (unsigned long long*)malloc((N>0 ? N : 1)*sizeof(unsigned long long));
+	start[0] = 0;
+	for(v=0; v<N; v++)
+	{
+		int s = start[v];
+		int nin = graph->in_start[v+1] - graph->in_start[v];
+		int nout = graph->out_start[v+1] - graph->out_start[v];
+		for(j=0; j<nin; j++) keys[s+j] = 4LL*graph->in_adj[graph->in_start[v]+j] + graph->in_type[graph->in_start[v]+j] + 1;
+		for(j=0; j<nout; j++) keys[s+nin+j] = 4LL*graph->out_adj[graph->out_start[v]+j] + graph->out_type[graph->out_start[v]+j] + 1;
+		qsort(keys+s, nin, sizeof(long long), cmp_key64);
+		qsort(keys+s+nin, nout, sizeof(long long), cmp_key64);
+		start[v+1] = s + nin + nout;
+		hash[v] = MIX64((unsigned long long)nin);
+		for(j=s; j<start[v+1]; j++) hash[v] = MIX64(hash[v] ^ (unsigned long long)keys[j]);
+	}
+	int* order = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	for(v=0; v<N; v++) order[v] = v;
+	SORT_INDICES(order, N, cmp_twin, hash);
+
+	int nclasses = 0;
+	int leader = -1;
+	for(k=0; k<N; k++)
+	{
+		v = order[k];
+		// A hash collision only starts a new class, so no twin is wrongly merged.
+		int same = (leader>=0 && hash[v]==hash[leader] && start[v+1]-start[v]==start[leader+1]-start[leader]
+			&& graph->in_start[v+1]-graph->in_start[v]==graph->in_start[leader+1]-graph->in_start[leader]
+			&& memcmp(keys+start[v], keys+start[leader], (start[v+1]-start[v])*sizeof(long long))==0);
+		if(same==0) { leader = v; nclasses++; }
+		twin[v] = leader;
+	}
+	free(order);
+	free(start);
+	free(keys);
+	free(hash);
+	return nclasses;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//////////////////////////////// SEARCH /////////////////////////////////
+
+int ORBIT_FIND(int* parent, int v)
+{
+	while(parent[v]!=v) { parent[v] = parent[parent[v]]; v = parent[v]; }
+	return v;
+}
+
+void ORBIT_UNION(int* parent, int* size, int u, int v)
+{
+	u = ORBIT_FIND(parent, u);
+	v = ORBIT_FIND(parent, v);
+	if(u==v) return;
+	if(size[u]<size[v]) { int t = u; u = v; v = t; }
+	parent[v] = u;
+	size[u] += size[v];
+}
+
+struct OrbitSearch
+{
+	ORBITGRAPH* g;
+	ORBITPART* P;
+	int depth;				// number of levels of the first path.
+	int* path;				// node individualized at each level of the first path.
+	int* target;			// start of the target cell at each level of the first path.
+	int* path_cells;		// number of cells after each level.
+	unsigned long long* path_hash;
+	int* leaf;				// 'lab' of the first leaf.
+	int* image;				// candidate automorphism (the identity outside 'support').
+	int* support;
+	int nsupport;
+	int divergence;			// target cell of the level where the search left the first path.
+	int* stamp;				// 'ORBIT_TYPES' keys per node, to compare the edges.
+	int* multiplicity;
+	int* parent;			// orbits found so far (union-find).
+	int* orbit_size;
+	int* candidates;		// candidates of each level of the subtree search.
+	int ncandidates;
+	int capacity;
+	long long generators;
+	long long nodes;		// nodes of the search tree visited.
+};
+typedef struct OrbitSearch ORBITSEARCH;
+
+void ORBIT_RESET_IMAGE(ORBITSEARCH* S)
+{
+	int k;
+	for(k=0; k<S->nsupport; k++) S->image[S->support[k]] = S->support[k];
+	S->nsupport = 0;
+}
+
+/*	Whether the typed edges of 'u' (outputs if 'out', else inputs) are mapped by 'S->image'
+	to the edges of its image.	*/
+int ORBIT_TEST_EDGES(ORBITSEARCH* S, int u, int out)
+{
+	int j, key;
+	ORBITGRAPH* g = S->g;
+	int* start = out ? g->out_start : g->in_start;
+	int* adj = out ? g->out_adj : g->in_adj;
+	int* type = out ? g->out_type : g->in_type;
+	int* weight = out ? g->out_weight : g->in_weight;
+	int w = S->image[u];
+	int owner = 2*u + out;
+	if(start[u+1]-start[u]!=start[w+1]-start[w]) return 0;
+	for(j=start[w]; j<start[w+1]; j++)
+	{
+		key = ORBIT_TYPES*adj[j] + type[j];
+		if(S->stamp[key]!=owner) { S->stamp[key] = owner; S->multiplicity[key] = 0; }
+		S->multiplicity[key] += weight[j];
+	}
+	for(j=start[u]; j<start[u+1]; j++)
+	{
+		key = ORBIT_TYPES*S->image[adj[j]] + type[j];
+		if(S->stamp[key]!=owner || S->multiplicity[key]<weight[j]) return 0;
+		S->multiplicity[key] -= weight[j];
+	}
+	return 1;
+}
+
+/*	Whether the leaf in 'P->lab' gives an automorphism when matched with the first leaf.
+	Both leaves descend from the node of the first path whose target cell starts at 'from',
+	so they agree before it, and only the edges of the nodes moved by the map are checked. On success the
+	map is left in 'S->image' and 'S->support', otherwise 'S->image' is the identity.	*/
+int ORBIT_TEST_LEAF(ORBITSEARCH* S, int from)
+{
+	int p, k;
+	int automorphism = 1;
+	S->nsupport = 0;
+	for(p=from; p<S->g->n; p++)
+		if(S->leaf[p]!=S->P->lab[p])
+		{
+			S->image[S->leaf[p]] = S->P->lab[p];
+			S->support[S->nsupport++] = S->leaf[p];
+		}
+	for(k=0; k<S->nsupport && automorphism; k++)
+		automorphism = ORBIT_TEST_EDGES(S, S->support[k], 1) && ORBIT_TEST_EDGES(S, S->support[k], 0);
+	if(automorphism==0) ORBIT_RESET_IMAGE(S);
+	return automorphism;
+}
+
+/*	Individualizes 'v' at 'level' and refines. Returns whether the partition matches the
+	one of the first path at that level.	*/
+int ORBIT_STEP(ORBITSEARCH* S, int v, int level)
+{
+	S->P->hash = 0;
+	ORBIT_INDIVIDUALIZE(S->P, v, level);
+	ORBIT_REFINE(S->P, S->g, level);
+	S->nodes++;
+	return S->P->ncells==S->path_cells[level] && S->P->hash==S->path_hash[level];
+}
+
+/*	Searches the subtree below 'level' (whose partition matches the first path) for a
+	leaf giving an automorphism, left in 'S->image'. 'from' is the start of the target
+	cell of the level above.	*/
+int ORBIT_SUBTREE(ORBITSEARCH* S, int level, int from)
+{
+	int k;
+	if(level==S->depth) return ORBIT_TEST_LEAF(S, S->divergence);
+	int c = ORBIT_TARGET(S->P, from);
+	int size = S->P->end[c] - c;
+	if(S->ncandidates + size>S->capacity)
+	{
+		S->capacity = 2*(S->ncandidates + size);
+		S->candidates = (int*)realloc(S->candidates, S->capacity*sizeof(int));
+	}
+	int first = S->ncandidates;
+	memcpy(S->candidates + first, S->P->lab + c, size*sizeof(int));
+	S->ncandidates += size;
+	int found = 0;
+	for(k=0; k<size && found==0; k++)
+	{
+		if(ORBIT_STEP(S, S->candidates[first+k], level+1)) found = ORBIT_SUBTREE(S, level+1, c);
+		ORBIT_BACKTRACK(S->P, level);
+	}
+	S->ncandidates = first;
+	return found;
+}
+
+/*	Orbits of 'g' with the initial coloring 'color': 'orbit[v]' is a node of the orbit of
+	'v' (the root of the union-find). Returns log10 of the size of the group.	*/
+double ORBIT_SEARCH(ORBITGRAPH* g, int* color, int* orbit, long long* generators, long long* nodes)
+{
+	int n = g->n;
+	int v, l, k, p;
+	double log_size = 0.0;
+	ORBITSEARCH search;
+	ORBITSEARCH* S = &search;
+	S->g = g;
+	S->P = CreateOrbitPartition(n, 2*ORBIT_TYPES);
+	S->path = (int*)malloc((n+1)*sizeof(int));
+	S->target = (int*)malloc((n+1)*sizeof(int));
+	S->path_cells = (int*)malloc((n+1)*sizeof(int));
+	S->path_hash = (unsigned long long*)malloc((n+1)*sizeof(unsigned long long));
+	S->leaf = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	S->image = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	S->support = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	S->nsupport = 0;
+	S->stamp = (int*)malloc(((size_t)ORBIT_TYPES*n>0 ? (size_t)ORBIT_TYPES*n : 1)*sizeof(int));
+	S->multiplicity = (int*)malloc(((size_t)ORBIT_TYPES*n>0 ? (size_t)ORBIT_TYPES*n : 1)*sizeof(int));
+	S->parent = orbit;
+	S->orbit_size = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	S->capacity = (n>0) ? n : 1;
+	S->candidates = (int*)malloc(S->capacity*sizeof(int));
+	S->ncandidates = 0;
+	S->generators = 0;
+	S->nodes = 1;
+	for(v=0; v<(int)(ORBIT_TYPES*n); v++) S->stamp[v] = -1;
+	for(v=0; v<n; v++) { orbit[v] = v; S->orbit_size[v] = 1; S->image[v] = v; }
+	if(n>0)
+	{
+		// First path.
+		ORBIT_COLORING(S->P, color);
+		S->P->hash = 0;
+		ORBIT_REFINE(S->P, g, 0);
+		S->path_cells[0] = S->P->ncells;
+		S->path_hash[0] = S->P->hash;
+		int c = 0;
+		for(l=0; (c = ORBIT_TARGET(S->P, c))>=0; l++)
+		{
+			S->target[l] = c;
+			S->path[l] = S->P->lab[c];
+			S->P->hash = 0;
+			ORBIT_INDIVIDUALIZE(S->P, S->path[l], l+1);
+			ORBIT_REFINE(S->P, g, l+1);
+			S->path_cells[l+1] = S->P->ncells;
+			S->path_hash[l+1] = S->P->hash;
+			S->nodes++;
+		}
+		S->depth = l;
+		memcpy(S->leaf, S->P->lab, n*sizeof(int));
+
+		// From the deepest level up, the other nodes of each target cell.
+		int* tested = (int*)malloc(n*sizeof(int));
+		for(v=0; v<n; v++) tested[v] = -1;
+		for(l=S->depth-1; l>=0; l--)
+		{
+			ORBIT_BACKTRACK(S->P, l);
+			c = S->target[l];
+			int size = S->P->end[c] - c;
+			int* cell = (int*)malloc(size*sizeof(int));
+			memcpy(cell, S->P->lab + c, size*sizeof(int));
+			for(k=0; k<size; k++)
+			{
+				int w = cell[k];
+				int root = ORBIT_FIND(orbit, w);
+				if(root==ORBIT_FIND(orbit, S->path[l]) || tested[root]==l) continue;
+				int found = 0;
+				S->divergence = c;
+				if(ORBIT_STEP(S, w, l+1)) found = ORBIT_SUBTREE(S, l+1, c);
+				ORBIT_BACKTRACK(S->P, l);
+				if(found)
+				{
+					S->generators++;
+					for(p=0; p<S->nsupport; p++) ORBIT_UNION(orbit, S->orbit_size, S->support[p], S->image[S->support[p]]);
+					ORBIT_RESET_IMAGE(S);
+				}
+				else tested[ORBIT_FIND(orbit, w)] = l;
+			}
+			// Orbit of the node of the first path in the stabilizer of the previous ones.
+			int root = ORBIT_FIND(orbit, S->path[l]);
+			int norbit = 0;
+			for(k=0; k<size; k++) if(ORBIT_FIND(orbit, cell[k])==root) norbit++;
+			log_size += log10((double)norbit);
+			free(cell);
+		}
+		free(tested);
+	}
+	for(v=0; v<n; v++) orbit[v] = ORBIT_FIND(orbit, v);
+	*generators = S->generators;
+	*nodes = S->nodes;
+	FreeOrbitPartition(S->P);
+	free(S->path);
+	free(S->target);
+	free(S->path_cells);
+	free(S->path_hash);
+	free(S->leaf);
+	free(S->image);
+	free(S->support);
+	free(S->stamp);
+	free(S->multiplicity);
+	free(S->orbit_size);
+	free(S->candidates);
+	return log_size;
+}
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////////// ORBITS OF THE NETWORK /////////////////////
+
+/*	Orbits of the automorphism group of 'graph', whose fibers are given by 'quotient'.
+	The orbits are numbered by their smallest node and the number of orbits is returned.
+	'log_size' receives log10 of the size of the group and 'generators' the number of
+	automorphisms found by the search.	*/
+extern int AUTOMORPHISM_ORBITS(Graph* graph, QUOTIENT* quotient, int* orbit, double* log_size, long long* generators)
+{
+	int N = graph->size;
+	int v, j, m, r;
+	long long nodes;
+
+	// Seed: the input-tree class of each node.
+	int* class_of = (int*)malloc((quotient->size>0 ? quotient->size : 1)*sizeof(int));
+	int nclasses = BASE_CLASSES(quotient, class_of);
+
+	// Reduced network: one node for each twin class.
+	int* twin = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	int ntwins = TWIN_CLASSES(graph, twin);
+	int* reduced = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	int* twin_size = (int*)calloc((N>0 ? N : 1), sizeof(int));
+	int n = 0;
+	for(v=0; v<N; v++)
+	{
+		if(twin[v]==v) reduced[v] = n++;
+		twin_size[twin[v]]++;
+	}
+	*log_size = 0.0;
+	for(v=0; v<N; v++) if(twin[v]==v) *log_size += lgamma(twin_size[v] + 1.0)/log(10.0);
+
+	int* source = (int*)malloc((graph->num_edges>0 ? graph->num_edges : 1)*sizeof(int));
+	int* target = (int*)malloc((graph->num_edges>0 ? graph->num_edges : 1)*sizeof(int));
+	int* type = (int*)malloc((graph->num_edges>0 ? graph->num_edges : 1)*sizeof(int));
+	m = 0;
+	for(v=0; v<N; v++)
+	{
+		if(twin[v]!=v) continue;
+		for(j=graph->out_start[v]; j<graph->out_start[v+1]; j++)
+			if(twin[graph->out_adj[j]]==graph->out_adj[j])
+			{
+				source[m] = reduced[v];
+				target[m] = reduced[graph->out_adj[j]];
+				type[m++] = graph->out_type[j] + 1;
+			}
+	}
+	ORBITGRAPH* g = CreateOrbitGraph(n, m, source, target, type, NULL);
+	free(source);
+	free(target);
+	free(type);
+
+	// Color of each twin class: its input-tree class and its size.
+	int* color = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	int* rep = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	for(v=0; v<N; v++) if(twin[v]==v) rep[reduced[v]] = v;
+	int* key = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	for(r=0; r<n; r++) key[r] = r;
+	// Colors numbered by (class, size), with a counting sort over each field.
+	int max_size = 0;
+	for(r=0; r<n; r++) if(twin_size[rep[r]]>max_size) max_size = twin_size[rep[r]];
+	int* bucket = (int*)calloc((max_size+2>nclasses+1 ? max_size+2 : nclasses+1), sizeof(int));
+	int* order = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	for(r=0; r<n; r++) bucket[twin_size[rep[r]]+1]++;
+	for(j=0; j<=max_size; j++) bucket[j+1] += bucket[j];
+	for(r=0; r<n; r++) order[bucket[twin_size[rep[r]]]++] = r;
+	memset(bucket, 0, (max_size+2>nclasses+1 ? max_size+2 : nclasses+1)*sizeof(int));
+	for(r=0; r<n; r++) bucket[class_of[quotient->fiber[rep[r]]]+1]++;
+	for(j=0; j<nclasses; j++) bucket[j+1] += bucket[j];
+	for(j=0; j<n; j++) { r = order[j]; key[bucket[class_of[quotient->fiber[rep[r]]]]++] = r; }
+	int ncolors = 0;
+	for(j=0; j<n; j++)
+	{
+		int a = key[j];
+		if(j>0)
+		{
+			int b = key[j-1];
+			if(class_of[quotient->fiber[rep[a]]]!=class_of[quotient->fiber[rep[b]]] || twin_size[rep[a]]!=twin_size[rep[b]]) ncolors++;
+		}
+		color[a] = ncolors;
+	}
+	free(bucket);
+	free(order);
+	free(key);
+
+	int* reduced_orbit = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	*log_size += ORBIT_SEARCH(g, color, reduced_orbit, generators, &nodes);
+	*generators += N - ntwins;
+
+	// Orbits expanded to the twin classes and numbered by their smallest node.
+	int* number = (int*)malloc((n>0 ? n : 1)*sizeof(int));
+	for(r=0; r<n; r++) number[r] = -1;
+	int norbits = 0;
+	for(v=0; v<N; v++)
+	{
+		r = reduced_orbit[reduced[twin[v]]];
+		if(number[r]<0) number[r] = norbits++;
+		orbit[v] = number[r];
+	}
+	free(number);
+	free(reduced_orbit);
+	free(color);
+	free(rep);
+	FreeOrbitGraph(g);
+	free(twin);
+	free(twin_size);
+	free(reduced);
+	free(class_of);
+	return norbits;
+}
+
+/*	Writes the orbit of each node ("%d\t%d\n" -> Node ID/ Orbit). */
+extern void WRITE_ORBITS(char* filename, int* orbit, int N)
+{
+	int v;
+	FILE* OUT = fopen(filename, "w");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	for(v=0; v<N; v++) fprintf(OUT, "%d\t%d\n", v, orbit[v]);
+	fclose(OUT);
+}
+
+#endif
@@ -0,0 +1,274 @@
+/*	Parallel coarsest refinement over the weakly connected components of the network.
+	The initial partition built by 'PREPROCESSING' never puts nodes of different weak
+	components in the same block, and the splitting of a block only depends on edges
+	coming from its own component. Therefore, each component is an independent problem:
+	here it is extracted as a subgraph, refined by 'REFINEMENT' with scratch arrays sized
+	to the component, and the resulting blocks are mapped back to the original nodes.
+
+	The components are processed from the largest to the smallest one by a pool of
+	threads that take the next component from a shared counter, so the largest problems
+	start first and the small ones fill the remaining time.
+
+	On machines with several memory domains (sockets, see 'numaf.h') the threads are
+	spread over the domains and pinned to the processors of their own one, and the
+	components are shared among the domains by size (nodes and edges), the largest
+	first, each one going to the domain with the least work per thread. Each domain has
+	its own counter: its threads take its components first and only then help the other
+	domains. A component is copied into its subgraph, and refined with its scratch
+	arrays, by the thread that takes it, so these pages are placed in the domain of that
+	thread and the refinement only reads local memory, the original graph being read
+	once for the copy.
+
+	The parallelism is only across components: a component is refined by one thread, so
+	the time is at least the one of the largest component, and a network with one giant
+	weak component gets no speedup from the threads nor from the domains. 'numabench.sh'
+	measures both cases.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef PARALLELF_H
+#define PARALLELF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "fibrationf.h"
+#include "numaf.h"
+
+struct ComponentTask
+{
+	Graph* graph;
+	int ncomp;
+	int* comp_start;	// nodes of component 'c' are in 'comp_nodes[comp_start[c]]' to 'comp_nodes[comp_start[c+1]-1]'.
+	int* comp_nodes;
+	PART** comp_partition;
+	PART** comp_null;
+	NUMATOPO* topology;
+	int ndomains;		// domains with threads.
+	int* domain_start;	// components of domain 'd' are 'domain_comps[domain_start[d]]' to 'domain_comps[domain_start[d+1]-1]'.
+	int* domain_comps;
+	int* domain_next;	// next component of each domain (shared counters).
+};
+typedef struct ComponentTask COMPTASK;
+
+struct ComponentWorker
+{
+	COMPTASK* task;
+	int domain;
+	int pin;
+};
+typedef struct ComponentWorker COMPWORKER;
+
+/*	Replaces the node labels of all blocks of 'part' by 'nodes[label]'. */
+void LIFT_PARTITION(PART* part, int* nodes)
+{
+	PART* current_part;
+	NODELIST* nodelist;
+	for(current_part=part; current_part!=NULL; current_part=current_part->next)
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
+			nodelist->data = nodes[nodelist->data];
+}
+
+/*	Moves all blocks of 'source' to the beginning of 'dest'. */
+void SPLICE_PARTITION(PART** dest, PART* source)
+{
+	PART* tail = source;
+	if(source==NULL) return;
+	while(tail->next) tail = tail->next;
+	tail->next = *dest;
+	if((*dest)!=NULL) (*dest)->prev = tail;
+	*dest = source;
+}
+
+/*	Refines component 'c', with 'local' (-1 for all the nodes) as scratch map. */
+void REFINE_COMPONENT(COMPTASK* task, int c, int* local)
+{
+	int k;
+	int n = task->comp_start[c+1] - task->comp_start[c];
+	int* nodes = &(task->comp_nodes[task->comp_start[c]]);
+	for(k=0; k<n; k++) local[nodes[k]] = k;
+	Graph* sub = BUILD_SUBGRAPH(task->graph, nodes, n, n, local);
+
+	// The subgraph is one single component rooted at its first node.
+	int* subcomp = (int*)malloc(n*sizeof(int));
+	subcomp[0] = -n;
+	for(k=1; k<n; k++) subcomp[k] = 0;
+	sub->num_component = 1;
+
+	PART* part = NULL;
+	PART* nullpart = NULL;
+	REFINEMENT(&part, &nullpart, subcomp, sub);
+	LIFT_PARTITION(part, nodes);
+	LIFT_PARTITION(nullpart, nodes);
+	task->comp_partition[c] = part;
+	task->comp_null[c] = nullpart;
+
+	for(k=0; k<n; k++) local[nodes[k]] = -1;
+	free(subcomp);
+	FreeGraph(sub);
+}
+
+void* COMPONENT_WORKER(void* arg)
+{
+	int i, k, d;
+	COMPWORKER* worker = (COMPWORKER*)arg;
+	COMPTASK* task = worker->task;
+	if(worker->pin) NUMA_PIN(task->topology, worker->domain);
+
+	// Allocated after the pinning, so it is placed in the domain of the thread.
+	int* local = (int*)malloc((task->graph->size)*sizeof(int));
+	for(k=0; k<(task->graph->size); k++) local[k] = -1;
+
+	// The components of its own domain first, then the ones left in the other domains.
+	for(k=0; k<task->ndomains; k++)
+	{
+		d = (worker->domain + k)%(task->ndomains);
+		int size = task->domain_start[d+1] - task->domain_start[d];
+		while((i = __atomic_fetch_add(&(task->domain_next[d]), 1, __ATOMIC_RELAXED)) < size)
+			REFINE_COMPONENT(task, task->domain_comps[task->domain_start[d]+i], local);
+	}
+	free(local);
+	return NULL;
+}
+
+/*	Shares the components among the 'ndomains' domains, with 'workers[d]' threads in domain
+	'd': in decreasing order of size, each one goes to the domain with the least work per
+	thread, the work of a component being its number of nodes and of edges.	*/
+void ASSIGN_COMPONENTS(COMPTASK* task, int* workers)
+{
+	int c, d, k;
+	int* domain_of = (int*)malloc((task->ncomp>0 ? task->ncomp : 1)*sizeof(int));
+	double* load = (double*)calloc(task->ndomains, sizeof(double));
+	task->domain_start = (int*)calloc(task->ndomains+1, sizeof(int));
+	task->domain_comps = (int*)malloc((task->ncomp>0 ? task->ncomp : 1)*sizeof(int));
+	task->domain_next = (int*)calloc(task->ndomains, sizeof(int));
+	for(c=0; c<task->ncomp; c++)
+	{
+		double work = 0.0;
+		for(k=task->comp_start[c]; k<task->comp_start[c+1]; k++)
+		{
+			int v = task->comp_nodes[k];
+			work += 1.0 + task->graph->in_start[v+1] - task->graph->in_start[v];
+		}
+		int best = 0;
+		for(d=1; d<task->ndomains; d++) if(load[d]/workers[d]<load[best]/workers[best]) best = d;
+		load[best] += work;
+		domain_of[c] = best;
+		task->domain_start[best+1]++;
+	}
+	for(d=0; d<task->ndomains; d++) task->domain_start[d+1] += task->domain_start[d];
+	int* fill = (int*)malloc(task->ndomains*sizeof(int));
+	memcpy(fill, task->domain_start, task->ndomains*sizeof(int));
+	// Each domain keeps the decreasing order of size.
+	for(c=0; c<task->ncomp; c++) task->domain_comps[fill[domain_of[c]]++] = c;
+	free(fill);
+	free(load);
+	free(domain_of);
+}
+
+/*	Groups the nodes by weak component, with the components sorted by decreasing size. */
+int GROUP_COMPONENTS(int* components, Graph* graph, int** comp_start, int** comp_nodes)
+{
+	int i, c, root;
+	int N = graph->size;
+	int ncomp = 0;
+	int* roots = (int*)malloc(N*sizeof(int));
+	int* comp_of_root = (int*)malloc(N*sizeof(int));
+	for(i=0; i<N; i++)
+	{
+		roots[i] = findroot(i, components);
+		comp_of_root[i] = -1;
+	}
+	// Components as (size, root) pairs, sorted by decreasing size.
+	STORETYPE* comp_size = (STORETYPE*)malloc(N*sizeof(STORETYPE));
+	for(i=0; i<N; i++)
+	{
+		if(roots[i]!=i) continue;
+		comp_size[ncomp].node = -components[i];
+		comp_size[ncomp].type = i;
+		ncomp++;
+	}
+	qsort(comp_size, ncomp, sizeof(STORETYPE), cmp);
+
+	*comp_start = (int*)malloc((ncomp+1)*sizeof(int));
+	*comp_nodes = (int*)malloc(N*sizeof(int));
+	(*comp_start)[0] = 0;
+	for(c=0; c<ncomp; c++)
+	{
+		comp_of_root[comp_size[c].type] = c;
+		(*comp_start)[c+1] = (*comp_start)[c] + comp_size[c].node;
+	}
+	int* fill = (int*)malloc(ncomp*sizeof(int));
+	for(c=0; c<ncomp; c++) fill[c] = (*comp_start)[c];
+	for(i=0; i<N; i++)
+	{
+		root = comp_of_root[roots[i]];
+		(*comp_nodes)[fill[root]++] = i;
+	}
+	free(fill);
+	free(comp_size);
+	free(comp_of_root);
+	free(roots);
+	return ncomp;
+}
+
+/*	Same result of 'REFINEMENT', but each weakly connected component is refined
+	independently by one of the 'nthreads' threads, placed on the memory domains of the
+	machine.	*/
+extern void PARALLEL_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, int nthreads)
+{
+	int c, t;
+	COMPTASK task;
+	task.graph = graph;
+	task.ncomp = GROUP_COMPONENTS(components, graph, &(task.comp_start), &(task.comp_nodes));
+	task.comp_partition = (PART**)malloc((task.ncomp)*sizeof(PART*));
+	task.comp_null = (PART**)malloc((task.ncomp)*sizeof(PART*));
+
+	if(nthreads>task.ncomp) nthreads = task.ncomp;
+	if(nthreads<1) nthreads = 1;
+	// Thread 't' runs in domain 't % ndomains'; with one single domain nothing is pinned.
+	task.topology = NUMA_TOPOLOGY();
+	task.ndomains = (task.topology->ndomains<nthreads) ? task.topology->ndomains : nthreads;
+	int* workers = (int*)calloc(task.ndomains, sizeof(int));
+	for(t=0; t<nthreads; t++) workers[t%(task.ndomains)]++;
+	ASSIGN_COMPONENTS(&task, workers);
+	COMPWORKER* worker = (COMPWORKER*)malloc(nthreads*sizeof(COMPWORKER));
+	for(t=0; t<nthreads; t++)
+	{
+		worker[t].task = &task;
+		worker[t].domain = t%(task.ndomains);
+		worker[t].pin = (task.ndomains>1);
+	}
+	if(nthreads==1) COMPONENT_WORKER(&worker[0]);
+	else
+	{
+		pthread_t* threads = (pthread_t*)malloc(nthreads*sizeof(pthread_t));
+		for(t=0; t<nthreads; t++) pthread_create(&threads[t], NULL, COMPONENT_WORKER, &worker[t]);
+		for(t=0; t<nthreads; t++) pthread_join(threads[t], NULL);
+		free(threads);
+	}
+	free(worker);
+	free(workers);
+	free(task.domain_start);
+	free(task.domain_comps);
+	free(task.domain_next);
+
+	// The largest components stay at the beginning of the partitions.
+	for(c=(task.ncomp)-1; c>=0; c--)
+	{
+		SPLICE_PARTITION(partition, task.comp_partition[c]);
+		SPLICE_PARTITION(null_partition, task.comp_null[c]);
+	}
+	free(task.comp_partition);
+	free(task.comp_null);
+	free(task.comp_start);
+	free(task.comp_nodes);
+}
+
+#endif
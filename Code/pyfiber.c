@@ -0,0 +1,298 @@
+/*	Python extension module 'fiberc' exposing the refinement and the classification of
+	this code to Python. The edges are given as a C-contiguous int32 buffer of shape (M, 2)
+	(source, target) and the types as an int32 buffer of length M (0 positive, 1 negative,
+	2 dual and -1 unknown, or None when all edges have the same type), e.g. NumPy arrays.
+	Both are read in place through the buffer protocol: the rows of 'edges' are used
+	directly as the edge pairs given to 'addEdges'.
+
+	The results are returned as 'fiberc.Array' objects, which own the memory filled by the
+	C code and export it through the buffer protocol, so 'numpy.asarray' wraps them with
+	no copy (see 'PyCode/fiberc_numpy.py'). The returned dictionary contains:
+
+		'membership'	int32 (N,)		fiber of each node.
+		'fiber_size'	int32 (F,)		number of nodes of each fiber.
+		'fiber_n'		float64 (F,)	fundamental number n (branch ratio) of each fiber.
+		'fiber_l'		int32 (F,)		number of external regulators l of each fiber.
+		'solitaire'		int32 (F,)		one for the fibers of nodes without inputs.
+		'quotient'		int32 (Q, 4)	base graph edges as (source fiber, target fiber, type,
+										multiplicity), see 'quotientf.h'.
+
+	The fibers are numbered as in 'BUILD_QUOTIENT'. The GIL is released while the network
+	is refined, so several networks can be analysed by different Python threads.
+
+	Build with 'python3 setup.py build_ext --inplace' from this folder.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fibrationf.h"
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "parallelf.h"
+#include "dagf.h"
+#include "reductionf.h"
+#include "quotientf.h"
+
+////////////////////////// BUFFER EXPORTING ARRAY TYPE //////////////////////////
+typedef struct
+{
+	PyObject_HEAD
+	void* data;
+	int ndim;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+	Py_ssize_t itemsize;
+	char* format;
+	int exports;
+} FiberArray;
+
+static void FiberArray_dealloc(FiberArray* self)
+{
+	free(self->data);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int FiberArray_getbuffer(FiberArray* self, Py_buffer* view, int flags)
+{
+	view->obj = (PyObject*)self;
+	Py_INCREF(self);
+	view->buf = self->data;
+	view->len = self->shape[0]*(self->ndim==2 ? self->shape[1] : 1)*self->itemsize;
+	view->readonly = 0;
+	view->itemsize = self->itemsize;
+	view->format = (flags & PyBUF_FORMAT) ? self->format : NULL;
+	view->ndim = self->ndim;
+	view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+	view->strides = ((flags & PyBUF_STRIDES)==PyBUF_STRIDES) ? self->strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	self->exports++;
+	return 0;
+}
+
+static void FiberArray_releasebuffer(FiberArray* self, Py_buffer* view)
+{
+	self->exports--;
+}
+
+static Py_ssize_t FiberArray_length(FiberArray* self)
+{
+	return self->shape[0];
+}
+
+static PyBufferProcs FiberArray_as_buffer = {
+	(getbufferproc)FiberArray_getbuffer,
+	(releasebufferproc)FiberArray_releasebuffer,
+};
+
+static PySequenceMethods FiberArray_as_sequence = {
+	(lenfunc)FiberArray_length,
+};
+
+static PyTypeObject FiberArrayType = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	.tp_name = "fiberc.Array",
+	.tp_basicsize = sizeof(FiberArray),
+	.tp_dealloc = (destructor)FiberArray_dealloc,
+	.tp_as_sequence = &FiberArray_as_sequence,
+	.tp_as_buffer = &FiberArray_as_buffer,
+	.tp_flags = Py_TPFLAGS_DEFAULT,
+	.tp_doc = "Array owned by the fiber engine, exported through the buffer protocol.",
+};
+
+/*	Wraps 'data' (allocated with malloc) without copying. With 'cols' equal to zero the
+	array has one dimension. 'data' is freed if the object can not be created.	*/
+static PyObject* WRAP_ARRAY(void* data, Py_ssize_t rows, Py_ssize_t cols, Py_ssize_t itemsize, char* format)
+{
+	FiberArray* array = PyObject_New(FiberArray, &FiberArrayType);
+	if(array==NULL) { free(data); return NULL; }
+	// malloc(0) may return NULL, which is not a valid buffer address.
+	array->data = (data!=NULL) ? data : malloc(1);
+	array->ndim = (cols>0) ? 2 : 1;
+	array->shape[0] = rows;
+	array->shape[1] = cols;
+	array->itemsize = itemsize;
+	array->strides[0] = (cols>0) ? cols*itemsize : itemsize;
+	array->strides[1] = itemsize;
+	array->format = format;
+	array->exports = 0;
+	return (PyObject*)array;
+}
+/////////////////////////////////////////////////////////////////////////////////
+
+/*	Checks that 'view' holds 4-byte integers in C order. */
+static int IS_INT32_BUFFER(Py_buffer* view)
+{
+	if(view->itemsize!=4 || view->format==NULL) return 0;
+	char* f = view->format;
+	if(*f=='<' || *f=='>' || *f=='=' || *f=='@' || *f=='!') f++;
+	return (strcmp(f, "i")==0 || strcmp(f, "l")==0);
+}
+
+static PyObject* fiberc_analyse(PyObject* self, PyObject* args, PyObject* kwds)
+{
+	static char* kwlist[] = {"edges", "types", "num_nodes", "threads", "dag", "reduce", "classify", NULL};
+	PyObject* edges_obj;
+	PyObject* types_obj = Py_None;
+	int N = 0;
+	int nthreads = 1;
+	int dag_bool = 0;
+	int reduce_bool = 0;
+	int classify_bool = 1;
+	if(!PyArg_ParseTupleAndKeywords(args, kwds, "O|Oiippp", kwlist, &edges_obj, &types_obj, &N, &nthreads, &dag_bool, &reduce_bool, &classify_bool))
+		return NULL;
+
+	Py_buffer edges_view;
+	Py_buffer types_view;
+	if(PyObject_GetBuffer(edges_obj, &edges_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)!=0) return NULL;
+	if(!IS_INT32_BUFFER(&edges_view) || (edges_view.ndim==2 && edges_view.shape[1]!=2) || (edges_view.len/4)%2!=0)
+	{
+		PyBuffer_Release(&edges_view);
+		PyErr_SetString(PyExc_ValueError, "'edges' must be a C-contiguous int32 buffer of shape (M, 2)");
+		return NULL;
+	}
+	int nE = (int)(edges_view.len/8);
+	int* pairs = (int*)edges_view.buf;
+	int* regulator = NULL;
+	int types_bool = (types_obj!=Py_None);
+	if(types_bool)
+	{
+		if(PyObject_GetBuffer(types_obj, &types_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT)!=0) { PyBuffer_Release(&edges_view); return NULL; }
+		if(!IS_INT32_BUFFER(&types_view) || types_view.len/4!=nE)
+		{
+			PyBuffer_Release(&edges_view);
+			PyBuffer_Release(&types_view);
+			PyErr_SetString(PyExc_ValueError, "'types' must be a C-contiguous int32 buffer with one value per edge");
+			return NULL;
+		}
+		regulator = (int*)types_view.buf;
+	}
+
+	int j, f;
+	for(j=0; j<2*nE; j++) if(pairs[j]+1>N) N = pairs[j]+1;
+	for(j=0; j<2*nE; j++) if(pairs[j]<0) break;
+	if(j<2*nE) PyErr_SetString(PyExc_ValueError, "node IDs must be non-negative");
+	for(j=0; types_bool && j<nE && !PyErr_Occurred(); j++)
+		if(regulator[j]<-1 || regulator[j]>2) PyErr_SetString(PyExc_ValueError, "edge types must be -1, 0, 1 or 2");
+	if(PyErr_Occurred() || N==0)
+	{
+		PyBuffer_Release(&edges_view);
+		if(types_bool) PyBuffer_Release(&types_view);
+		if(!PyErr_Occurred()) PyErr_SetString(PyExc_ValueError, "empty network");
+		return NULL;
+	}
+
+	QUOTIENT* quotient;
+	PART* partition = NULL;
+	PART* null_partition = NULL;
+	Py_BEGIN_ALLOW_THREADS
+	// The edge pairs are read in place from the buffer.
+	int** edges = (int**)malloc(nE*sizeof(int*));
+	for(j=0; j<nE; j++) edges[j] = &pairs[2*j];
+	if(!types_bool)
+	{
+		regulator = (int*)malloc(nE*sizeof(int));
+		for(j=0; j<nE; j++) regulator[j] = 0;
+	}
+	int* components = (int*)malloc(N*sizeof(int));
+	Graph* graph = createGraph(N, NULL, 0);
+	addEdges(edges, components, graph, regulator, nE, nthreads);
+	free(edges);
+	if(!types_bool) free(regulator);
+
+	if(reduce_bool==1) REDUCED_REFINEMENT(&partition, &null_partition, components, graph, nthreads, dag_bool);
+	else if(dag_bool==1) DAG_REFINEMENT(&partition, &null_partition, components, graph, nthreads);
+	else if(graph->num_component>1) PARALLEL_REFINEMENT(&partition, &null_partition, components, graph, nthreads);
+	else REFINEMENT(&partition, &null_partition, components, graph);
+	quotient = BUILD_QUOTIENT(graph, partition, null_partition);
+	if(classify_bool==1)
+	{
+		CALCULATE_REGULATORS(&partition, graph);
+		CALCULATE_REGULATORS(&null_partition, graph);
+		CALC_BRANCHING(&partition, graph);
+	}
+	FreeGraph(graph);
+	free(components);
+	Py_END_ALLOW_THREADS
+	PyBuffer_Release(&edges_view);
+	if(types_bool) PyBuffer_Release(&types_view);
+
+	// Fiber table, in the numbering of 'BUILD_QUOTIENT'.
+	int F = quotient->size;
+	double* fiber_n = (double*)malloc(F*sizeof(double));
+	int* fiber_l = (int*)malloc(F*sizeof(int));
+	int* solitaire = (int*)malloc(F*sizeof(int));
+	PART* current_part;
+	f = 0;
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next, f++)
+		{ fiber_n[f] = current_part->fundamental_number; fiber_l[f] = current_part->number_regulators; solitaire[f] = 0; }
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next, f++)
+		{ fiber_n[f] = current_part->fundamental_number; fiber_l[f] = current_part->number_regulators; solitaire[f] = 1; }
+	FreePartition(&partition);
+	FreePartition(&null_partition);
+
+	int Q = quotient->num_edges;
+	int* base = (int*)malloc(4*(size_t)Q*sizeof(int));
+	for(f=0; f<F; f++)
+		for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+		{
+			base[4*j] = quotient->in_adj[j];
+			base[4*j+1] = f;
+			base[4*j+2] = quotient->in_type[j];
+			base[4*j+3] = quotient->in_mult[j];
+		}
+
+	// 'fiber' and 'fiber_size' are handed over to the arrays.
+	PyObject* membership = WRAP_ARRAY(quotient->fiber, N, 0, sizeof(int), "i");
+	PyObject* fiber_size = WRAP_ARRAY(quotient->fiber_size, F, 0, sizeof(int), "i");
+	quotient->fiber = NULL;
+	quotient->fiber_size = NULL;
+	FreeQuotient(quotient);
+
+	PyObject* result = Py_BuildValue("{s:N,s:N,s:N,s:N,s:N,s:N}",
+		"membership", membership,
+		"fiber_size", fiber_size,
+		"fiber_n", WRAP_ARRAY(fiber_n, F, 0, sizeof(double), "d"),
+		"fiber_l", WRAP_ARRAY(fiber_l, F, 0, sizeof(int), "i"),
+		"solitaire", WRAP_ARRAY(solitaire, F, 0, sizeof(int), "i"),
+		"quotient", WRAP_ARRAY(base, Q, 4, sizeof(int), "i"));
+	return result;
+}
+
+static PyMethodDef fiberc_methods[] = {
+	{"analyse", (PyCFunction)(void(*)(void))fiberc_analyse, METH_VARARGS | METH_KEYWORDS,
+	 "analyse(edges, types=None, num_nodes=0, threads=1, dag=False, reduce=False, classify=True)\n\n"
+	 "Refines the network given by the int32 (M, 2) 'edges' and (M,) 'types' buffers and returns\n"
+	 "a dictionary with the membership, fiber table and quotient graph arrays."},
+	{NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef fibercmodule = {
+	PyModuleDef_HEAD_INIT,
+	"fiberc",
+	"Native fibration refinement and classification.",
+	-1,
+	fiberc_methods
+};
+
+PyMODINIT_FUNC PyInit_fiberc(void)
+{
+	if(PyType_Ready(&FiberArrayType)<0) return NULL;
+	PyObject* module = PyModule_Create(&fibercmodule);
+	if(module==NULL) return NULL;
+	Py_INCREF(&FiberArrayType);
+	if(PyModule_AddObject(module, "Array", (PyObject*)&FiberArrayType)<0)
+	{
+		Py_DECREF(&FiberArrayType);
+		Py_DECREF(module);
+		return NULL;
+	}
+	return module;
+}
@@ -0,0 +1,165 @@
+/*	Construction and export of the base graph of the fibration (the quotient graph). Each
+	fiber becomes one node, and since all nodes of a fiber receive the same typed multiset
+	of inputs from each fiber, the inputs of a fiber are taken from any one of its nodes
+	and grouped by (source fiber, type), with the number of edges as the multiplicity.
+	The construction is done in one pass over the nodes and edges, O(N+M).
+
+	The fibers are numbered following the blocks of 'partition' and then the blocks of
+	'null_partition', so the fibers of 'partition' receive the same index used in 'main.c'.
+
+	Two output formats are given. The text format writes one line per base edge as
+	"%d\t%d\t%s\t%d\n" -> Source fiber/ Target fiber/ Type of regulation/ Multiplicity,
+	and the fiber of each node in a second file as "%d\t%d\n" -> Node/ Fiber. The binary
+	format (native byte order) is the magic "FQG1", followed by the integers 'num_nodes',
+	'size' and 'num_edges', and the arrays 'fiber', 'fiber_size', 'in_start', 'in_adj',
+	'in_type' and 'in_mult', in this order.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef QUOTIENTF_H
+#define QUOTIENTF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+#define QUOTIENT_MAGIC "FQG1"
+
+QUOTIENT* AllocQuotient(int N, int nfibers, int nedges)
+{
+	QUOTIENT* quotient = (QUOTIENT*)malloc(sizeof(QUOTIENT));
+	quotient->num_nodes = N;
+	quotient->size = nfibers;
+	quotient->num_edges = nedges;
+	quotient->fiber = (int*)malloc(N*sizeof(int));
+	quotient->fiber_size = (int*)calloc(nfibers, sizeof(int));
+	quotient->in_start = (int*)malloc((nfibers+1)*sizeof(int));
+	quotient->in_adj = (int*)malloc(nedges*sizeof(int));
+	quotient->in_type = (int*)malloc(nedges*sizeof(int));
+	quotient->in_mult = (int*)malloc(nedges*sizeof(int));
+	return quotient;
+}
+
+extern void FreeQuotient(QUOTIENT* quotient)
+{
+	free(quotient->fiber);
+	free(quotient->fiber_size);
+	free(quotient->in_start);
+	free(quotient->in_adj);
+	free(quotient->in_type);
+	free(quotient->in_mult);
+	free(quotient);
+}
+
+extern QUOTIENT* BUILD_QUOTIENT(Graph* graph, PART* partition, PART* null_partition)
+{
+	int N = graph->size;
+	int f, j, v, key, first;
+	PART* current_part;
+	NODELIST* nodelist;
+
+	int nfibers = GetPartitionSize(partition) + GetPartitionSize(null_partition);
+	QUOTIENT* quotient = AllocQuotient(N, nfibers, graph->num_edges);
+	int* rep = (int*)malloc(nfibers*sizeof(int));
+
+	f = 0;
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next, f++)
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
+			{ quotient->fiber[nodelist->data] = f; rep[f] = nodelist->data; quotient->fiber_size[f]++; }
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next, f++)
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
+			{ quotient->fiber[nodelist->data] = f; rep[f] = nodelist->data; quotient->fiber_size[f]++; }
+
+	/*	'position[4*source fiber + type + 1]' keeps where the edge was stored. Positions
+		stored for previous fibers are smaller than 'first', so no reset is needed.	*/
+	int* position = (int*)malloc(4*nfibers*sizeof(int));
+	for(j=0; j<4*nfibers; j++) position[j] = -1;
+	int nedges = 0;
+	for(f=0; f<nfibers; f++)
+	{
+		v = rep[f];
+		first = nedges;
+		quotient->in_start[f] = first;
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+		{
+			key = 4*quotient->fiber[graph->in_adj[j]] + graph->in_type[j] + 1;
+			if(position[key]>=first) quotient->in_mult[position[key]]++;
+			else
+			{
+				position[key] = nedges;
+				quotient->in_adj[nedges] = quotient->fiber[graph->in_adj[j]];
+				quotient->in_type[nedges] = graph->in_type[j];
+				quotient->in_mult[nedges++] = 1;
+			}
+		}
+	}
+	quotient->in_start[nfibers] = nedges;
+	quotient->num_edges = nedges;
+	free(position);
+	free(rep);
+	return quotient;
+}
+
+extern void WRITE_QUOTIENT_TEXT(QUOTIENT* quotient, char* edgefile, char* fiberfile)
+{
+	int f, j;
+	FILE* EDGES = fopen(edgefile, "w");
+	if(EDGES==NULL) { printf("ERROR in file writing"); return; }
+	for(f=0; f<quotient->size; f++)
+		for(j=quotient->in_start[f]; j<quotient->in_start[f+1]; j++)
+			fprintf(EDGES, "%d\t%d\t%s\t%d\n", quotient->in_adj[j], f, REGULATION_NAME(quotient->in_type[j]), quotient->in_mult[j]);
+	fclose(EDGES);
+
+	FILE* FIBERS = fopen(fiberfile, "w");
+	if(FIBERS==NULL) { printf("ERROR in file writing"); return; }
+	for(j=0; j<quotient->num_nodes; j++) fprintf(FIBERS, "%d\t%d\n", j, quotient->fiber[j]);
+	fclose(FIBERS);
+}
+
+extern void WRITE_QUOTIENT_BINARY(QUOTIENT* quotient, char* filename)
+{
+	FILE* OUT = fopen(filename, "wb");
+	if(OUT==NULL) { printf("ERROR in file writing"); return; }
+	fwrite(QUOTIENT_MAGIC, 1, 4, OUT);
+	fwrite(&(quotient->num_nodes), sizeof(int), 1, OUT);
+	fwrite(&(quotient->size), sizeof(int), 1, OUT);
+	fwrite(&(quotient->num_edges), sizeof(int), 1, OUT);
+	fwrite(quotient->fiber, sizeof(int), quotient->num_nodes, OUT);
+	fwrite(quotient->fiber_size, sizeof(int), quotient->size, OUT);
+	fwrite(quotient->in_start, sizeof(int), quotient->size+1, OUT);
+	fwrite(quotient->in_adj, sizeof(int), quotient->num_edges, OUT);
+	fwrite(quotient->in_type, sizeof(int), quotient->num_edges, OUT);
+	fwrite(quotient->in_mult, sizeof(int), quotient->num_edges, OUT);
+	fclose(OUT);
+}
+
+/*	Returns NULL if the file can not be read or is not a quotient graph file. */
+extern QUOTIENT* READ_QUOTIENT_BINARY(char* filename)
+{
+	char magic[4];
+	int N, nfibers, nedges;
+	size_t r = 0;
+	FILE* IN = fopen(filename, "rb");
+	if(IN==NULL) return NULL;
+	if(fread(magic, 1, 4, IN)!=4 || memcmp(magic, QUOTIENT_MAGIC, 4)!=0) { fclose(IN); return NULL; }
+	if(fread(&N, sizeof(int), 1, IN)!=1 || fread(&nfibers, sizeof(int), 1, IN)!=1 || fread(&nedges, sizeof(int), 1, IN)!=1)
+		{ fclose(IN); return NULL; }
+
+	QUOTIENT* quotient = AllocQuotient(N, nfibers, nedges);
+	r += fread(quotient->fiber, sizeof(int), N, IN);
+	r += fread(quotient->fiber_size, sizeof(int), nfibers, IN);
+	r += fread(quotient->in_start, sizeof(int), nfibers+1, IN);
+	r += fread(quotient->in_adj, sizeof(int), nedges, IN);
+	r += fread(quotient->in_type, sizeof(int), nedges, IN);
+	r += fread(quotient->in_mult, sizeof(int), nedges, IN);
+	fclose(IN);
+	if(r!=(size_t)(N + 2*nfibers + 1 + 3*nedges)) { FreeQuotient(quotient); return NULL; }
+	return quotient;
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*	Random numbers and random networks. The generator is a splitmix64 sequence whose state
+	is kept by the caller, so each thread (or each sample) uses its own state and the
+	results only depend on the seed, not on how the work is split among the threads.
+
+	'ERDOS_RENYI_EDGES' generates a directed Erdos-Renyi network G(N, p) without
+	self-loops, with p = c/(N-1) for the mean degree c, as 'fast_gnp_erdos' in
+	'PyCode/utils.py': instead of testing the N(N-1) ordered pairs, it jumps between the
+	chosen pairs with geometric distributed gaps, which costs O(N + M). Each edge receives
+	a type drawn uniformly among the 'ntypes' first ones.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef RANDOMNETF_H
+#define RANDOMNETF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+typedef unsigned long long RNGSTATE;
+
+#define DEFAULT_SEED 12345ULL	// seed of the tools when no -seed is given.
+
+unsigned long long RANDOM_UINT64(RNGSTATE* state)
+{
+	unsigned long long z = (*state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*	Uniform in [0, 1). */
+double RANDOM_DOUBLE(RNGSTATE* state)
+{
+	return (RANDOM_UINT64(state) >> 11) * (1.0/9007199254740992.0);
+}
+
+/*	Uniform in [0, bound). */
+int RANDOM_INT(RNGSTATE* state, int bound)
+{
+	return (int)(((RANDOM_UINT64(state) >> 32) * (unsigned long long)bound) >> 32);
+}
+
+/*	Writes the edges as (source, target) pairs in '*pairs' and their types in '*types',
+	growing both arrays when they are shorter than needed ('*capacity' edges). Returns
+	the number of edges.	*/
+extern int ERDOS_RENYI_EDGES(int N, double c, int ntypes, RNGSTATE* state, int** pairs, int** types, int* capacity)
+{
+	int nE = 0;
+	if(N<2) return 0;
+	double p = c/(N-1);
+	long long npairs = (long long)N*(N-1);
+	long long index = -1;
+	double logq = (p<1.0) ? log(1.0 - p) : 0.0;
+	if(ntypes<1) ntypes = 1;
+	while(1)
+	{
+		if(p>=1.0) index++;
+		else if(p<=0.0) break;
+		else index += 1 + (long long)floor(log(1.0 - RANDOM_DOUBLE(state))/logq);
+		if(index>=npairs) break;
+		if(nE==*capacity)
+		{
+			*capacity = (*capacity>0) ? 2*(*capacity) : 1024;
+			*pairs = (int*)realloc(*pairs, 2*(size_t)(*capacity)*sizeof(int));
+			*types = (int*)realloc(*types, (size_t)(*capacity)*sizeof(int));
+		}
+		int source = (int)(index/(N-1));
+		int target = (int)(index%(N-1));
+		if(target>=source) target++;
+		(*pairs)[2*nE] = source;
+		(*pairs)[2*nE+1] = target;
+		(*types)[nE] = RANDOM_INT(state, ntypes);
+		nE++;
+	}
+	return nE;
+}
+
+#endif
@@ -0,0 +1,202 @@
+/*	Graph reduction applied before the refinement. Two nodes of the same weak component
+	that receive exactly the same typed multiset of inputs are always in the same fiber,
+	so they can be collapsed into one representative node: its inputs are the inputs of
+	any of them and its outputs are the outputs of all of them (kept as parallel edges).
+	Sink fans (many targets of the same regulators) collapse at once, and repeating the
+	rule over the reduced graph collapses the parallel in-degree-one chains leaving them,
+	one level per round.
+
+	Only nodes outside cycles are collapsed, i.e., nodes that form a trivial strongly
+	connected component without self-loop and that have at least one input. Nodes without
+	inputs and nodes in cycles keep their own representative, so the reduced graph gives
+	to 'PREPROCESSING' exactly the same initial blocks and splitters of the original one.
+	After the reduced graph is refined, each representative is expanded back to its nodes.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef REDUCTIONF_H
+#define REDUCTIONF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "fibrationf.h"
+#include "parallelf.h"
+#include "dagf.h"
+
+#define REDUCTION_ROUNDS 32
+
+/*	Defines in 'group' the representative of each node after the reduction rounds
+	and returns the number of representatives.	*/
+extern int REDUCE_GRAPH(Graph* graph, int* components, int* group)
+{
+	int N = graph->size;
+	int i, j, v, g, len, slot, round;
+	int ngroup = N;
+	int nnew;
+	unsigned long long h;
+
+	// Only nodes outside cycles and with inputs may be collapsed.
+	int* scc = (int*)malloc(N*sizeof(int));
+	int* order = (int*)malloc(N*sizeof(int));
+	int* mergeable = (int*)malloc(N*sizeof(int));
+	int nscc = STRONG_COMPONENTS(graph, scc, order);
+	int* scc_size = (int*)calloc(nscc, sizeof(int));
+	for(v=0; v<N; v++) scc_size[scc[v]]++;
+	for(v=0; v<N; v++)
+	{
+		mergeable[v] = (scc_size[scc[v]]==1 && graph->in_start[v]<graph->in_start[v+1]);
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			if(graph->in_adj[j]==v) mergeable[v] = 0;
+	}
+	free(scc_size);
+	free(order);
+	free(scc);
+
+	int capacity = 1;
+	while(capacity<2*N) capacity <<= 1;
+	int* table = (int*)malloc(capacity*sizeof(int));
+	int* repr = (int*)malloc(N*sizeof(int));		// one node of each group.
+	int* newgroup = (int*)malloc(N*sizeof(int));
+	int* sig_start = (int*)malloc(N*sizeof(int));
+	int* sig_len = (int*)malloc(N*sizeof(int));
+	long long* pool = (long long*)malloc((graph->num_edges+N)*sizeof(long long));
+	for(v=0; v<N; v++) { group[v] = v; repr[v] = v; }
+
+	for(round=0; round<REDUCTION_ROUNDS; round++)
+	{
+		int pool_size = 0;
+		nnew = 0;
+		for(i=0; i<capacity; i++) table[i] = -1;
+		for(g=0; g<ngroup; g++)
+		{
+			v = repr[g];
+			if(mergeable[v]==0) { newgroup[g] = nnew++; continue; }
+
+			// Signature: weak component root and sorted (group, type) pairs of the inputs.
+			long long* sig = &pool[pool_size];
+			len = 0;
+			sig[len++] = findroot(v, components);
+			for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+				sig[len++] = 4*(long long)group[graph->in_adj[j]] + (graph->in_type[j]+1);
+			qsort(sig+1, len-1, sizeof(long long), cmp_signature);
+
+			h = HASH_SIGNATURE(sig, len);
+			slot = (int)(h & (capacity-1));
+			while(table[slot]>=0)
+			{
+				int f = table[slot];
+				if(sig_len[f]==len && memcmp(&pool[sig_start[f]], sig, len*sizeof(long long))==0) break;
+				slot = (slot+1) & (capacity-1);
+			}
+			if(table[slot]>=0) newgroup[g] = table[slot];
+			else
+			{
+				newgroup[g] = nnew;
+				table[slot] = nnew;
+				sig_start[nnew] = pool_size;
+				sig_len[nnew] = len;
+				pool_size += len;
+				nnew++;
+			}
+		}
+		if(nnew==ngroup) break;
+
+		for(g=0; g<ngroup; g++) repr[newgroup[g]] = repr[g];
+		for(v=0; v<N; v++) group[v] = newgroup[group[v]];
+		ngroup = nnew;
+	}
+	free(table);
+	free(repr);
+	free(newgroup);
+	free(sig_start);
+	free(sig_len);
+	free(pool);
+	free(mergeable);
+	return ngroup;
+}
+
+/*	Replaces each representative in the blocks of 'part' by all the nodes it stands for. */
+void EXPAND_PARTITION(PART* part, int* group_start, int* group_nodes)
+{
+	int k, g;
+	PART* current_part;
+	NODELIST* nodelist;
+	NODELIST* expanded;
+	for(current_part=part; current_part!=NULL; current_part=current_part->next)
+	{
+		expanded = NULL;
+		current_part->block->size = 0;
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
+		{
+			g = nodelist->data;
+			for(k=group_start[g]; k<group_start[g+1]; k++)
+			{
+				push_doublylist(&expanded, group_nodes[k]);
+				current_part->block->size++;
+			}
+		}
+		deleteList(&(current_part->block->head));
+		current_part->block->head = expanded;
+	}
+}
+
+/*	Same result of 'REFINEMENT', obtained by refining the reduced graph. With 'dag_bool'
+	equal to one, the reduced graph is refined by 'DAG_REFINEMENT'.	*/
+extern void REDUCED_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, int nthreads, int dag_bool)
+{
+	int N = graph->size;
+	int i, g, r;
+	int* group = (int*)malloc(N*sizeof(int));
+	int ngroup = REDUCE_GRAPH(graph, components, group);
+
+	// Nodes of each group, with the first one used as its representative.
+	int* group_start = (int*)calloc(ngroup+1, sizeof(int));
+	int* group_nodes = (int*)malloc(N*sizeof(int));
+	int* nodes = (int*)malloc(ngroup*sizeof(int));
+	for(i=0; i<N; i++) group_start[group[i]+1]++;
+	for(g=0; g<ngroup; g++) group_start[g+1] += group_start[g];
+	int* fill = (int*)malloc(ngroup*sizeof(int));
+	memcpy(fill, group_start, ngroup*sizeof(int));
+	for(i=0; i<N; i++) group_nodes[fill[group[i]]++] = i;
+	for(g=0; g<ngroup; g++) nodes[g] = group_nodes[group_start[g]];
+	free(fill);
+
+	Graph* reduced = BUILD_SUBGRAPH(graph, nodes, ngroup, ngroup, group);
+	int* redcomp = (int*)malloc(ngroup*sizeof(int));
+	int* first = (int*)malloc(N*sizeof(int));
+	for(i=0; i<N; i++) first[i] = -1;
+	reduced->num_component = 0;
+	for(g=0; g<ngroup; g++)
+	{
+		r = findroot(nodes[g], components);
+		if(first[r]<0) { first[r] = g; redcomp[g] = -1; reduced->num_component++; }
+		else { redcomp[g] = first[r]; redcomp[first[r]]--; }
+	}
+
+	PART* redpart = NULL;
+	PART* rednull = NULL;
+	if(dag_bool==1) DAG_REFINEMENT(&redpart, &rednull, redcomp, reduced, nthreads);
+	else if(reduced->num_component>1) PARALLEL_REFINEMENT(&redpart, &rednull, redcomp, reduced, nthreads);
+	else REFINEMENT(&redpart, &rednull, redcomp, reduced);
+
+	EXPAND_PARTITION(redpart, group_start, group_nodes);
+	EXPAND_PARTITION(rednull, group_start, group_nodes);
+	SPLICE_PARTITION(partition, redpart);
+	SPLICE_PARTITION(null_partition, rednull);
+
+	FreeGraph(reduced);
+	free(redcomp);
+	free(first);
+	free(group);
+	free(group_start);
+	free(group_nodes);
+	free(nodes);
+}
+
+#endif
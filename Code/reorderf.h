@@ -0,0 +1,195 @@
+/*	Node reordering applied before the refinement. The node IDs come from the input files,
+	so the neighbors of a node and the nodes of the same block are usually far apart in
+	the adjacency arrays and in the scratch arrays indexed by node. Here the graph is
+	relabeled by a permutation that places related nodes close to each other, refined
+	with the new labels and the resulting blocks are mapped back to the original nodes,
+	so the partition (and everything computed from it) is given in the original IDs.
+
+	Three orderings are given:
+
+	degree:		nodes sorted by decreasing total degree, so the hubs, which appear in most of
+				the splitter scans, share the first cache lines.
+	rcm:		reverse Cuthill-McKee over the undirected version of the graph. Each weak
+				component is visited in breadth-first order starting from a node of minimum
+				degree, with the neighbors taken by increasing degree, and the final order is
+				reversed. Neighbors receive close labels, reducing the bandwidth of the CSR.
+	component:	nodes of the same weak component (from the union-find of 'addEdges') are
+				made contiguous, from the largest to the smallest component.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef REORDERF_H
+#define REORDERF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+#include "fibrationf.h"
+#include "parallelf.h"
+#include "dagf.h"
+#include "reductionf.h"
+
+#define REORDER_NONE 0
+#define REORDER_DEGREE 1
+#define REORDER_RCM 2
+#define REORDER_COMPONENT 3
+
+/*	Ordering given by its name ('none', 'degree', 'rcm' or 'component'), or -1 for an
+	unknown name.	*/
+extern int REORDER_MODE(char* name)
+{
+	if(strcmp(name, "none")==0) return REORDER_NONE;
+	else if(strcmp(name, "degree")==0) return REORDER_DEGREE;
+	else if(strcmp(name, "rcm")==0) return REORDER_RCM;
+	else if(strcmp(name, "component")==0) return REORDER_COMPONENT;
+	return -1;
+}
+
+int TOTAL_DEGREE(Graph* graph, int node)
+{
+	return (graph->in_start[node+1] - graph->in_start[node]) + (graph->out_start[node+1] - graph->out_start[node]);
+}
+
+/*	Counting sort of the nodes by total degree, increasing or decreasing. Nodes with the
+	same degree keep their relative order.	*/
+void SORT_BY_DEGREE(Graph* graph, int* order, int decreasing)
+{
+	int N = graph->size;
+	int i, d;
+	int maxdeg = 0;
+	for(i=0; i<N; i++) if(TOTAL_DEGREE(graph, i)>maxdeg) maxdeg = TOTAL_DEGREE(graph, i);
+	int* count = (int*)calloc(maxdeg+2, sizeof(int));
+	for(i=0; i<N; i++)
+	{
+		d = TOTAL_DEGREE(graph, i);
+		count[(decreasing==1 ? maxdeg-d : d)+1]++;
+	}
+	for(d=0; d<=maxdeg; d++) count[d+1] += count[d];
+	for(i=0; i<N; i++)
+	{
+		d = TOTAL_DEGREE(graph, i);
+		order[count[decreasing==1 ? maxdeg-d : d]++] = i;
+	}
+	free(count);
+}
+
+void RCM_ORDER(Graph* graph, int* order)
+{
+	int N = graph->size;
+	int i, j, k, v, u, n, head, tail;
+	int* start = (int*)malloc(N*sizeof(int));
+	int* visited = (int*)calloc(N, sizeof(int));
+	SORT_BY_DEGREE(graph, start, 0);
+
+	// Neighbors of the current node as (degree, node) pairs, sorted by degree.
+	int maxdeg = 0;
+	for(i=0; i<N; i++) if(TOTAL_DEGREE(graph, i)>maxdeg) maxdeg = TOTAL_DEGREE(graph, i);
+	long long* neigh = (long long*)malloc((maxdeg+1)*sizeof(long long));
+
+	tail = 0;
+	for(i=0; i<N; i++)
+	{
+		if(visited[start[i]]==1) continue;
+		head = tail;
+		order[tail++] = start[i];
+		visited[start[i]] = 1;
+		while(head<tail)
+		{
+			v = order[head++];
+			n = 0;
+			for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			{
+				u = graph->in_adj[j];
+				if(visited[u]==0) { visited[u] = 1; neigh[n++] = ((long long)TOTAL_DEGREE(graph, u)<<32) | u; }
+			}
+			for(j=graph->out_start[v]; j<graph->out_start[v+1]; j++)
+			{
+				u = graph->out_adj[j];
+				if(visited[u]==0) { visited[u] = 1; neigh[n++] = ((long long)TOTAL_DEGREE(graph, u)<<32) | u; }
+			}
+			qsort(neigh, n, sizeof(long long), cmp_signature);
+			for(k=0; k<n; k++) order[tail++] = (int)(neigh[k] & 0xffffffffLL);
+		}
+	}
+	// Reversed order.
+	for(i=0; i<N/2; i++) { v = order[i]; order[i] = order[N-1-i]; order[N-1-i] = v; }
+	free(neigh);
+	free(visited);
+	free(start);
+}
+
+/*	Defines in 'order' the node placed at each new label. Returns zero if 'mode' is not
+	a valid ordering.	*/
+extern int NODE_ORDER(Graph* graph, int* components, int mode, int* order)
+{
+	int* comp_start;
+	int* comp_nodes;
+	switch(mode)
+	{
+		case REORDER_DEGREE:
+			SORT_BY_DEGREE(graph, order, 1);
+			return 1;
+		case REORDER_RCM:
+			RCM_ORDER(graph, order);
+			return 1;
+		case REORDER_COMPONENT:
+			GROUP_COMPONENTS(components, graph, &comp_start, &comp_nodes);
+			memcpy(order, comp_nodes, (graph->size)*sizeof(int));
+			free(comp_start);
+			free(comp_nodes);
+			return 1;
+	}
+	return 0;
+}
+
+/*	Same result of the refinement selected by 'dag_bool' and 'reduce_bool' (as in 'main.c'),
+	computed over the graph relabeled by the ordering 'mode'.	*/
+extern void REORDERED_REFINEMENT(PART** partition, PART** null_partition, int* components, Graph* graph, int nthreads, int mode, int dag_bool, int reduce_bool)
+{
+	int N = graph->size;
+	int i, r;
+	int* order = (int*)malloc(N*sizeof(int));
+	if(NODE_ORDER(graph, components, mode, order)==0)
+	{
+		for(i=0; i<N; i++) order[i] = i;
+	}
+	int* label = (int*)malloc(N*sizeof(int));
+	for(i=0; i<N; i++) label[order[i]] = i;
+
+	Graph* permuted = BUILD_SUBGRAPH(graph, order, N, N, label);
+	int* permcomp = (int*)malloc(N*sizeof(int));
+	int* first = (int*)malloc(N*sizeof(int));
+	for(i=0; i<N; i++) first[i] = -1;
+	permuted->num_component = 0;
+	for(i=0; i<N; i++)
+	{
+		r = findroot(order[i], components);
+		if(first[r]<0) { first[r] = i; permcomp[i] = -1; permuted->num_component++; }
+		else { permcomp[i] = first[r]; permcomp[first[r]]--; }
+	}
+
+	PART* permpart = NULL;
+	PART* permnull = NULL;
+	if(reduce_bool==1) REDUCED_REFINEMENT(&permpart, &permnull, permcomp, permuted, nthreads, dag_bool);
+	else if(dag_bool==1) DAG_REFINEMENT(&permpart, &permnull, permcomp, permuted, nthreads);
+	else if(permuted->num_component>1) PARALLEL_REFINEMENT(&permpart, &permnull, permcomp, permuted, nthreads);
+	else REFINEMENT(&permpart, &permnull, permcomp, permuted);
+
+	LIFT_PARTITION(permpart, order);
+	LIFT_PARTITION(permnull, order);
+	SPLICE_PARTITION(partition, permpart);
+	SPLICE_PARTITION(null_partition, permnull);
+
+	FreeGraph(permuted);
+	free(permcomp);
+	free(first);
+	free(label);
+	free(order);
+}
+
+#endif
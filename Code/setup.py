@@ -0,0 +1,11 @@
+from setuptools import setup, Extension
+
+''' Builds the 'fiberc' extension module (see 'pyfiber.c') with
+        python3 setup.py build_ext --inplace
+'''
+fiberc = Extension('fiberc',
+                   sources=['pyfiber.c'],
+                   extra_compile_args=['-O2', '-Wall'],
+                   libraries=['m', 'pthread'])
+
+setup(name='fiberc', version='0.1', ext_modules=[fiberc])
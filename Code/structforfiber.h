@@ -3,6 +3,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "utilsforfiber.h"
 
 /////////////////////////////////////////////////////////////////////
@@ -15,12 +16,21 @@ struct Graph
 	int size;
 	int num_component;
 	struct adjList* array;
+	// Same edges in compressed sparse row form (see 'BUILD_CSR').
+	int num_edges;
+	int* in_start;
+	int* in_adj;
+	int* in_type;
+	int* out_start;
+	int* out_adj;
+	int* out_type;
+	// Node names and other metadata, kept apart from the adjacency data.
+	struct NodeMetadata* meta;
 };
 typedef struct Graph Graph;
 
 struct adjList
 {
-	char gene_name[60];	
 	struct NodeAdj* head_in;
     struct NodeAdj* head_out;
 };
@@ -37,6 +47,89 @@ typedef struct NodeAdj NodeAdj;
 //////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////
 
+/////////////////////// NODE METADATA STORE ///////////////////////
+/*	Node names are stored by column: all of them one after the other in the 'names'
+	string blob, with the name of node 'v' starting at 'names[name_offset[v]]'. When the
+	names come from a 'nameID' file, the file is only read on the first name request, so
+	runs that never print names never touch them.	*/
+struct NodeMetadata
+{
+	int size;
+	int loaded;				// one if the names are already in memory.
+	char* name_file;		// 'nameID' file read on the first request (NULL if none).
+	long* name_offset;		// -1 for the nodes without name.
+	char* names;
+	long names_size;
+	long names_capacity;
+};
+typedef struct NodeMetadata NODEMETA;
+
+NODEMETA* CreateMetadata(int N, char* name_file)
+{
+	int j;
+	NODEMETA* meta = (NODEMETA*)malloc(sizeof(NODEMETA));
+	meta->size = N;
+	meta->loaded = 0;
+	meta->name_file = NULL;
+	if(name_file!=NULL)
+	{
+		meta->name_file = (char*)malloc(strlen(name_file)+1);
+		strcpy(meta->name_file, name_file);
+	}
+	meta->name_offset = (long*)malloc(N*sizeof(long));
+	for(j=0; j<N; j++) meta->name_offset[j] = -1;
+	meta->names_size = 0;
+	meta->names_capacity = 1024;
+	meta->names = (char*)malloc(meta->names_capacity);
+	return meta;
+}
+
+void FreeMetadata(NODEMETA* meta)
+{
+	free(meta->name_file);
+	free(meta->name_offset);
+	free(meta->names);
+	free(meta);
+}
+
+void SET_NODE_NAME(NODEMETA* meta, int node, const char* name)
+{
+	long length = strlen(name) + 1;
+	if(node<0 || node>=meta->size) return;
+	while(meta->names_size+length>meta->names_capacity)
+	{
+		meta->names_capacity *= 2;
+		meta->names = (char*)realloc(meta->names, meta->names_capacity);
+	}
+	memcpy(&(meta->names[meta->names_size]), name, length);
+	meta->name_offset[node] = meta->names_size;
+	meta->names_size += length;
+}
+
+/*	Reads the 'nameID' file ("%s\t%d\n" -> Gene name/ Gene ID number). */
+void LOAD_NODE_NAMES(NODEMETA* meta)
+{
+	int nodeID;
+	char tempname[1024];
+	meta->loaded = 1;
+	if(meta->name_file==NULL) return;
+	FILE* NAMES = fopen(meta->name_file, "r");
+	if(NAMES==NULL) { printf("ERROR in file reading"); return; }
+	while(fscanf(NAMES, "%1023s\t%d\n", tempname, &nodeID)==2) SET_NODE_NAME(meta, nodeID, tempname);
+	fclose(NAMES);
+}
+
+/*	Name of 'node', or an empty string if the graph has no names. */
+char* NODE_NAME(Graph* graph, int node)
+{
+	NODEMETA* meta = graph->meta;
+	if(meta==NULL) return "";
+	if(meta->loaded==0) LOAD_NODE_NAMES(meta);
+	if(meta->name_offset[node]<0) return "";
+	return &(meta->names[meta->name_offset[node]]);
+}
+/////////////////////////////////////////////////////////////////////
+
 ////////////////////// STACK DATA STRUCTURE ///////////////////////
 struct stack
 {
@@ -86,6 +179,39 @@ struct storetype
 typedef struct storetype STORETYPE;
 /////////////////////////////////////////////////////////////////////////
 
+/*	Base graph of the fibration: one node per fiber, and the inputs of each fiber are
+	the inputs of any of its nodes grouped by (source fiber, type) with multiplicities. */
+struct QuotientGraph
+{
+	int size;			// number of fibers.
+	int num_nodes;		// number of nodes of the original graph.
+	int num_edges;		// number of distinct (source fiber, target fiber, type) edges.
+	int* fiber;			// fiber of each original node.
+	int* fiber_size;
+	int* in_start;		// incoming edges of fiber 'f' from 'in_start[f]' to 'in_start[f+1]-1'.
+	int* in_adj;		// source fiber.
+	int* in_type;
+	int* in_mult;		// multiplicity.
+};
+typedef struct QuotientGraph QUOTIENT;
+/////////////////////////////////////////////////////////////////////////
+
+/*	Split tree of the refinement (see 'historyf.h'): block 0 holds all the nodes and each
+	other block was split from block 'parent[b]' in refinement round 'round[b]'. */
+struct SplitHistory
+{
+	int num_nodes;
+	int size;			// number of blocks in the tree.
+	int capacity;
+	int rounds;			// last round with a split.
+	int current;		// round of the splits being recorded.
+	int* parent;
+	int* round;
+	int* leaf;			// current block of each node (the final one after the refinement).
+};
+typedef struct SplitHistory HISTORY;
+/////////////////////////////////////////////////////////////////////////
+
 struct QueueOfBlocks
 {
     BLOCK* block;
@@ -167,6 +293,9 @@ extern void printGraph(Graph* graph)
 	}
 }
 
+// Defined in 'utilsforfiber.h'.
+extern int GETNin(Graph* graph, int node);
+
 extern void printGraphInFibers(Graph* graph, PART* partition, int* nodefiber)
 {
 	int i, n;
@@ -192,7 +321,6 @@ extern void printGraphInFibers(Graph* graph, PART* partition, int* nodefiber)
 extern void printGeneGraphInFibers(Graph* graph, PART* partition, int* nodefiber)
 {
 	int i, n;
-	NodeAdj* Node;
 	STORETYPE* temp;
 	PART* current_part;
 	NODELIST* nodelist;
@@ -202,16 +330,16 @@ extern void printGeneGraphInFibers(Graph* graph, PART* partition, int* nodefiber
 		printf("FIBER %d WITH SIZE %d -> | %.4lf, %d >:\n", current_part->block->index, current_part->block->size, current_part->fundamental_number, current_part->number_regulators);
 		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next)
 		{
-			printf("NODE %s receives from fiber(node,type): ", graph->array[nodelist->data].gene_name);
+			printf("NODE %s receives from fiber(node,type): ", NODE_NAME(graph, nodelist->data));
 			n = GETNin(graph, nodelist->data);
 			temp = GETIN_ADJTYPE(graph, nodelist->data);
 			for(i=0; i<n; i++)
 			{
 				if(temp[i].type==0)
-					printf("%d(%s,positive) ", nodefiber[temp[i].node], graph->array[temp[i].node].gene_name);
+					printf("%d(%s,positive) ", nodefiber[temp[i].node], NODE_NAME(graph, temp[i].node));
 				else if(temp[i].type==1)
-					printf("%d(%s,negative) ", nodefiber[temp[i].node], graph->array[temp[i].node].gene_name);
-				else printf("%d(%s,dual) ", nodefiber[temp[i].node], graph->array[temp[i].node].gene_name);
+					printf("%d(%s,negative) ", nodefiber[temp[i].node], NODE_NAME(graph, temp[i].node));
+				else printf("%d(%s,dual) ", nodefiber[temp[i].node], NODE_NAME(graph, temp[i].node));
 			}
 			printf("\n");
 		}
@@ -231,7 +359,7 @@ void printBlockGene(BLOCK* P, Graph* graph)
 {
     NODELIST* List;
 	for(List=P->head; List!=NULL; List=List->next)
-		printf("%s, ", graph->array[List->data].gene_name);
+		printf("%s, ", NODE_NAME(graph, List->data));
 	printf("\n");
 }
 
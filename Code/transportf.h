@@ -0,0 +1,422 @@
+/*	Message transport between one coordinator process and K worker processes, used by
+	the distributed refinement ('distributedf.h'). The transport is created before the
+	workers are forked, and each process calls 'attach' with its rank (-1 for the
+	coordinator, 0 to K-1 for the workers). The messages are arrays of ints and follow
+	a fixed pattern of synchronized rounds: the coordinator broadcasts one message to all
+	the workers and then collects one reply from each of them.
+
+		coordinator:	broadcast(message), collect(0), ..., collect(K-1)
+		worker k:		fetch(), reply(answer)
+
+	The buffers returned by 'collect' and 'fetch' belong to the transport and stay valid
+	until the next call for the same worker (or the next 'fetch'). Two transports are
+	given for runs on one host:
+
+		socket		one Unix socket pair for each worker, the messages being written with
+					their length in front.
+		shared		shared memory: one broadcast buffer and one reply buffer for each worker,
+					in unlinked files mapped by all the processes and grown on demand, with
+					process-shared semaphores signaling the requests and the replies. The
+					broadcast is written only once, whatever the number of workers.
+
+	Other transports (e.g. over the network) only need to fill the same functions.
+
+	A worker that dies makes 'collect' return NULL instead of blocking the coordinator:
+	the sockets see the end of the stream and are written with MSG_NOSIGNAL, so writing
+	to a closed socket fails instead of raising SIGPIPE, and the shared memory waits for
+	the replies in slices of SHARED_POLL_MS milliseconds, checking between them with
+	'waitpid' (WNOHANG) whether the worker in 'workers' is still running. In the same way,
+	a worker waiting for a request stops when the coordinator is gone.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef TRANSPORTF_H
+#define TRANSPORTF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/socket.h>
+
+typedef struct Transport TRANSPORT;
+struct Transport
+{
+	int nworkers;
+	int rank;			// -1 for the coordinator.
+	pid_t* workers;		// process of each worker, set by the coordinator after the fork (NULL if unknown).
+	void* data;			// state of each implementation.
+	void (*attach)(TRANSPORT* transport, int rank);
+	int (*broadcast)(TRANSPORT* transport, int* message, long long n);
+	int* (*collect)(TRANSPORT* transport, int worker, long long* n);
+	int* (*fetch)(TRANSPORT* transport, long long* n);
+	int (*reply)(TRANSPORT* transport, int* message, long long n);
+	void (*close)(TRANSPORT* transport);
+};
+
+//////////////////////////////////////////////////////////////////////
+/////////////////////////// SOCKET PAIRS /////////////////////////////
+
+struct SocketTransport
+{
+	int* fds;			// 'fds[2k]' coordinator side and 'fds[2k+1]' worker side of worker k.
+	int** buffer;		// receiving buffer of each worker (one more for the worker itself).
+	long long* capacity;
+};
+typedef struct SocketTransport SOCKETTRANSPORT;
+
+int WRITE_ALL(int fd, void* data, long long bytes)
+{
+	char* p = (char*)data;
+	while(bytes>0)
+	{
+		ssize_t w = send(fd, p, bytes, MSG_NOSIGNAL);
+		if(w<0 && errno==EINTR) continue;
+		if(w<=0) return 0;
+		p += w;
+		bytes -= w;
+	}
+	return 1;
+}
+
+int READ_ALL(int fd, void* data, long long bytes)
+{
+	char* p = (char*)data;
+	while(bytes>0)
+	{
+		ssize_t r = read(fd, p, bytes);
+		if(r<0 && errno==EINTR) continue;
+		if(r<=0) return 0;
+		p += r;
+		bytes -= r;
+	}
+	return 1;
+}
+
+int SOCKET_SEND(int fd, int* message, long long n)
+{
+	if(WRITE_ALL(fd, &n, sizeof(long long))==0) return 0;
+	return WRITE_ALL(fd, message, n*sizeof(int));
+}
+
+int* SOCKET_RECEIVE(int fd, int** buffer, long long* capacity, long long* n)
+{
+	if(READ_ALL(fd, n, sizeof(long long))==0) return NULL;
+	if(*n>*capacity)
+	{
+		*capacity = *n;
+		*buffer = (int*)realloc(*buffer, (*capacity)*sizeof(int));
+	}
+	if(READ_ALL(fd, *buffer, (*n)*sizeof(int))==0) return NULL;
+	return *buffer;
+}
+
+void SOCKET_ATTACH(TRANSPORT* transport, int rank)
+{
+	int k;
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	transport->rank = rank;
+	for(k=0; k<transport->nworkers; k++)
+	{
+		if(rank!=-1) { close(st->fds[2*k]); st->fds[2*k] = -1; }
+		if(rank!=k) { close(st->fds[2*k+1]); st->fds[2*k+1] = -1; }
+	}
+}
+
+int SOCKET_BROADCAST(TRANSPORT* transport, int* message, long long n)
+{
+	int k;
+	int status = 1;
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	// Sent to all the workers even if one fails, so the others still receive the stop.
+	for(k=0; k<transport->nworkers; k++)
+		if(SOCKET_SEND(st->fds[2*k], message, n)==0) status = 0;
+	return status;
+}
+
+int* SOCKET_COLLECT(TRANSPORT* transport, int worker, long long* n)
+{
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	return SOCKET_RECEIVE(st->fds[2*worker], &(st->buffer[worker]), &(st->capacity[worker]), n);
+}
+
+int* SOCKET_FETCH(TRANSPORT* transport, long long* n)
+{
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	int K = transport->nworkers;
+	return SOCKET_RECEIVE(st->fds[2*transport->rank+1], &(st->buffer[K]), &(st->capacity[K]), n);
+}
+
+int SOCKET_REPLY(TRANSPORT* transport, int* message, long long n)
+{
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	return SOCKET_SEND(st->fds[2*transport->rank+1], message, n);
+}
+
+void SOCKET_CLOSE(TRANSPORT* transport)
+{
+	int k;
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)transport->data;
+	for(k=0; k<2*transport->nworkers; k++) if(st->fds[k]>=0) close(st->fds[k]);
+	for(k=0; k<=transport->nworkers; k++) free(st->buffer[k]);
+	free(st->fds);
+	free(st->buffer);
+	free(st->capacity);
+	free(st);
+	free(transport);
+}
+
+extern TRANSPORT* CreateSocketTransport(int nworkers)
+{
+	int k;
+	TRANSPORT* transport = (TRANSPORT*)malloc(sizeof(TRANSPORT));
+	SOCKETTRANSPORT* st = (SOCKETTRANSPORT*)malloc(sizeof(SOCKETTRANSPORT));
+	st->fds = (int*)malloc(2*nworkers*sizeof(int));
+	st->buffer = (int**)calloc(nworkers+1, sizeof(int*));
+	st->capacity = (long long*)calloc(nworkers+1, sizeof(long long));
+	for(k=0; k<nworkers; k++)
+	{
+		if(socketpair(AF_UNIX, SOCK_STREAM, 0, &(st->fds[2*k]))!=0)
+		{
+			printf("ERROR in socket creation");
+			for(k=k-1; k>=0; k--) { close(st->fds[2*k]); close(st->fds[2*k+1]); }
+			free(st->fds); free(st->buffer); free(st->capacity); free(st); free(transport);
+			return NULL;
+		}
+	}
+	transport->nworkers = nworkers;
+	transport->rank = -1;
+	transport->workers = NULL;
+	transport->data = st;
+	transport->attach = SOCKET_ATTACH;
+	transport->broadcast = SOCKET_BROADCAST;
+	transport->collect = SOCKET_COLLECT;
+	transport->fetch = SOCKET_FETCH;
+	transport->reply = SOCKET_REPLY;
+	transport->close = SOCKET_CLOSE;
+	return transport;
+}
+
+//////////////////////////////////////////////////////////////////////
+////////////////////////// SHARED MEMORY /////////////////////////////
+
+#define SHARED_MIN_CAPACITY 4096
+#define SHARED_POLL_MS 100
+
+/*	Control block, mapped by all the processes. Channel 0 is the broadcast and channel
+	k+1 the reply of worker k.	*/
+struct SharedControl
+{
+	long long length;		// ints in the channel.
+	long long capacity;		// bytes of the channel file.
+	sem_t ready;			// request (channel 0: unused) or reply posted.
+};
+typedef struct SharedControl SHAREDCONTROL;
+
+struct SharedTransport
+{
+	SHAREDCONTROL* control;	// nworkers+1 channels.
+	sem_t* request;			// inside the mapping of 'control', one per worker.
+	int* fds;				// channel files.
+	int** map;				// local mapping of each channel.
+	long long* mapped;		// bytes mapped by this process.
+	pid_t coordinator;		// process that created the transport.
+};
+typedef struct SharedTransport SHAREDTRANSPORT;
+
+/*	Unlinked file for one channel, in '/dev/shm' when available. */
+int SHARED_FILE(long long size)
+{
+	char name[64];
+	strcpy(name, "/dev/shm/fiberXXXXXX");
+	int fd = mkstemp(name);
+	if(fd<0)
+	{
+		strcpy(name, "/tmp/fiberXXXXXX");
+		fd = mkstemp(name);
+	}
+	if(fd<0) return -1;
+	unlink(name);
+	if(ftruncate(fd, size)!=0) { close(fd); return -1; }
+	return fd;
+}
+
+/*	Maps the current capacity of channel 'c', if this process maps less than that. */
+int SHARED_REMAP(SHAREDTRANSPORT* sh, int c)
+{
+	long long capacity = sh->control[c].capacity;
+	if(sh->mapped[c]==capacity) return 1;
+	if(sh->map[c]!=NULL) munmap(sh->map[c], sh->mapped[c]);
+	void* map = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, sh->fds[c], 0);
+	if(map==MAP_FAILED) { sh->map[c] = NULL; sh->mapped[c] = 0; return 0; }
+	sh->map[c] = (int*)map;
+	sh->mapped[c] = capacity;
+	return 1;
+}
+
+int SHARED_WRITE(SHAREDTRANSPORT* sh, int c, int* message, long long n)
+{
+	long long bytes = n*sizeof(int);
+	if(bytes>sh->control[c].capacity)
+	{
+		long long capacity = 2*sh->control[c].capacity;
+		if(capacity<bytes) capacity = bytes;
+		if(ftruncate(sh->fds[c], capacity)!=0) return 0;
+		sh->control[c].capacity = capacity;
+	}
+	if(SHARED_REMAP(sh, c)==0) return 0;
+	memcpy(sh->map[c], message, bytes);
+	sh->control[c].length = n;
+	return 1;
+}
+
+int* SHARED_READ(SHAREDTRANSPORT* sh, int c, long long* n)
+{
+	if(SHARED_REMAP(sh, c)==0) return NULL;
+	*n = sh->control[c].length;
+	return sh->map[c];
+}
+
+/*	Waits for the semaphore 'sem' while the process 'pid' is running: the worker 'pid'
+	for the coordinator, or the coordinator, as the parent, for a worker (pid = -1).
+	Returns zero when that process is gone.	*/
+int SHARED_WAIT(SHAREDTRANSPORT* sh, sem_t* sem, pid_t pid)
+{
+	struct timespec deadline;
+	while(1)
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += SHARED_POLL_MS*1000000L;
+		deadline.tv_sec += deadline.tv_nsec/1000000000L;
+		deadline.tv_nsec = deadline.tv_nsec%1000000000L;
+		if(sem_timedwait(sem, &deadline)==0) return 1;
+		if(errno==EINTR) continue;
+		if(errno!=ETIMEDOUT) return 0;
+		if(pid>0 && waitpid(pid, NULL, WNOHANG)!=0) return 0;
+		if(pid<0 && getppid()!=sh->coordinator) return 0;
+	}
+}
+
+void SHARED_ATTACH(TRANSPORT* transport, int rank)
+{
+	transport->rank = rank;
+}
+
+int SHARED_BROADCAST(TRANSPORT* transport, int* message, long long n)
+{
+	int k;
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)transport->data;
+	if(SHARED_WRITE(sh, 0, message, n)==0) return 0;
+	for(k=0; k<transport->nworkers; k++) sem_post(&(sh->request[k]));
+	return 1;
+}
+
+int* SHARED_COLLECT(TRANSPORT* transport, int worker, long long* n)
+{
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)transport->data;
+	pid_t pid = (transport->workers!=NULL) ? transport->workers[worker] : 0;
+	if(SHARED_WAIT(sh, &(sh->control[worker+1].ready), pid)==0) return NULL;
+	return SHARED_READ(sh, worker+1, n);
+}
+
+int* SHARED_FETCH(TRANSPORT* transport, long long* n)
+{
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)transport->data;
+	if(SHARED_WAIT(sh, &(sh->request[transport->rank]), -1)==0) return NULL;
+	return SHARED_READ(sh, 0, n);
+}
+
+int SHARED_REPLY(TRANSPORT* transport, int* message, long long n)
+{
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)transport->data;
+	int c = transport->rank + 1;
+	int status = SHARED_WRITE(sh, c, message, n);
+	if(status==0) sh->control[c].length = -1;	// the coordinator is still released.
+	sem_post(&(sh->control[c].ready));
+	return status;
+}
+
+void SHARED_CLOSE(TRANSPORT* transport)
+{
+	int c;
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)transport->data;
+	int K = transport->nworkers;
+	for(c=0; c<=K; c++)
+	{
+		if(sh->map[c]!=NULL) munmap(sh->map[c], sh->mapped[c]);
+		if(sh->fds[c]>=0) close(sh->fds[c]);
+	}
+	munmap(sh->control, (K+1)*sizeof(SHAREDCONTROL) + K*sizeof(sem_t));
+	free(sh->fds);
+	free(sh->map);
+	free(sh->mapped);
+	free(sh);
+	free(transport);
+}
+
+extern TRANSPORT* CreateSharedTransport(int nworkers)
+{
+	int c, k;
+	int K = nworkers;
+	size_t control_size = (K+1)*sizeof(SHAREDCONTROL) + K*sizeof(sem_t);
+	void* control = mmap(NULL, control_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(control==MAP_FAILED) { printf("ERROR in shared memory creation"); return NULL; }
+
+	SHAREDTRANSPORT* sh = (SHAREDTRANSPORT*)malloc(sizeof(SHAREDTRANSPORT));
+	sh->control = (SHAREDCONTROL*)control;
+	sh->request = (sem_t*)(sh->control + K + 1);
+	sh->fds = (int*)malloc((K+1)*sizeof(int));
+	sh->map = (int**)calloc(K+1, sizeof(int*));
+	sh->mapped = (long long*)calloc(K+1, sizeof(long long));
+	sh->coordinator = getpid();
+	int status = 1;
+	for(c=0; c<=K; c++)
+	{
+		sh->control[c].length = 0;
+		sh->control[c].capacity = SHARED_MIN_CAPACITY;
+		sem_init(&(sh->control[c].ready), 1, 0);
+		sh->fds[c] = SHARED_FILE(SHARED_MIN_CAPACITY);
+		if(sh->fds[c]<0) status = 0;
+	}
+	for(k=0; k<K; k++) sem_init(&(sh->request[k]), 1, 0);
+
+	TRANSPORT* transport = (TRANSPORT*)malloc(sizeof(TRANSPORT));
+	transport->nworkers = K;
+	transport->rank = -1;
+	transport->workers = NULL;
+	transport->data = sh;
+	transport->attach = SHARED_ATTACH;
+	transport->broadcast = SHARED_BROADCAST;
+	transport->collect = SHARED_COLLECT;
+	transport->fetch = SHARED_FETCH;
+	transport->reply = SHARED_REPLY;
+	transport->close = SHARED_CLOSE;
+	if(status==0)
+	{
+		printf("ERROR in shared memory creation");
+		SHARED_CLOSE(transport);
+		return NULL;
+	}
+	return transport;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+/*	Transport by name ('socket' or 'shared'), NULL for unknown names. */
+extern TRANSPORT* CreateTransport(char* name, int nworkers)
+{
+	if(strcmp(name, "socket")==0) return CreateSocketTransport(nworkers);
+	if(strcmp(name, "shared")==0) return CreateSharedTransport(nworkers);
+	return NULL;
+}
+
+#endif
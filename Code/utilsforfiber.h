@@ -15,7 +15,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "structforfiber.h"
+#include "componentsf.h"
 
 ////////////////////////////////////////////////////////////////////
 ////// Implementation to define a directed, unweighted graph ///////
@@ -43,69 +46,119 @@ extern Graph* createGraph(int N, char* nodenames, int name_bool)
 		graph->array[j].head_in = NULL; 
 		graph->array[j].head_out = NULL; 
 	}
-
-	int nodeID;
-	char tempname[60];
-	/*	if 'name_bool' is one, then we read the file containing
-		the names of each node to assign it to each node in our 
-		constructed network.	*/
-	if(name_bool==1)
-	{
-		FILE* NAMES = fopen(nodenames, "r");
-		for(j=0; j<N; j++)
-		{			
-			fscanf(NAMES, "%s\t%d\n", &tempname, &nodeID);
-			strcpy(graph->array[nodeID].gene_name, tempname);
-		}
-		fclose(NAMES);
-	}
+	graph->num_edges = 0;
+	graph->in_start = NULL;
+	graph->in_adj = NULL;
+	graph->in_type = NULL;
+	graph->out_start = NULL;
+	graph->out_adj = NULL;
+	graph->out_type = NULL;
+
+	/*	if 'name_bool' is one, the file containing the names of each node
+		is assigned to the network, and it is only read when a name is
+		requested (see 'NODE_NAME').	*/
+	if(name_bool==1) graph->meta = CreateMetadata(N, nodenames);
+	else graph->meta = NULL;
 	return graph;
 }
 
-/////////////////////////////////////////////////////////////////
-int findroot(int node, int* psite)
+/*	Returns the number of threads to be used when 'requested' is not positive. */
+extern int NUMBER_OF_THREADS(int requested)
 {
-	int root = node;
-	int cont = 0;
-	int path[100];                                  
-	while(psite[root]>=0)                     
-	{
-		path[cont++] = root;
-		root = psite[root];
-	}
-	if(psite[node]>=0) psite[node] = root;
-	while(cont) psite[path[--cont]] = root;
-	return root;
+	if(requested>0) return requested;
+	long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+	if(ncores<1) return 1;
+	return (int)ncores;
 }
 
-void merge(int node1, int root1, int node2, int root2, int* psite)
+/*	Returns one if 'word' is a non-negative integer, as the node IDs. */
+extern int IS_NODE_ID(char* word)
 {
-	if(psite[root1] <= psite[root2])
-	{
-		psite[root1] += psite[root2];
-		psite[root2] = root1;
-		psite[node2] = root1;
-	}
-	else
+	if(word==NULL || word[0]=='\0') return 0;
+	for(; *word!='\0'; word++) if(*word<'0' || *word>'9') return 0;
+	return 1;
+}
+
+////////////////////////////////////////////////////////////////////
+/////////////////////////// Hash helpers ///////////////////////////
+////////////////////////////////////////////////////////////////////
+#define FNV_OFFSET 1469598103934665603ULL
+#define FNV_PRIME 1099511628211ULL
+
+/*	Mixing function of 'splitmix64'. */
+unsigned long long MIX64(unsigned long long x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/*	FNV-1a hash of the 'size' bytes of 'data', continuing from 'hash' (FNV_OFFSET to start). */
+unsigned long long FNV_BYTES(unsigned long long hash, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	size_t b;
+	for(b=0; b<size; b++) { hash ^= bytes[b]; hash *= FNV_PRIME; }
+	return hash;
+}
+
+/*	Builds the compressed sparse row (CSR) arrays of the graph. For node 'v', its
+	incoming neighbors are 'in_adj[in_start[v]]' to 'in_adj[in_start[v+1]-1]', with
+	the respective edge types in 'in_type'. The same holds for the outgoing arrays.	*/
+void BUILD_CSR(int** edges, Graph* graph, int* regulator, int nE)
+{
+	int j, node1, node2;
+	int N = graph->size;
+	graph->num_edges = nE;
+	graph->in_start = (int*)calloc(N+1, sizeof(int));
+	graph->out_start = (int*)calloc(N+1, sizeof(int));
+	graph->in_adj = (int*)malloc(nE*sizeof(int));
+	graph->in_type = (int*)malloc(nE*sizeof(int));
+	graph->out_adj = (int*)malloc(nE*sizeof(int));
+	graph->out_type = (int*)malloc(nE*sizeof(int));
+
+	for(j=0; j<nE; j++) { graph->out_start[edges[j][0]+1]++; graph->in_start[edges[j][1]+1]++; }
+	for(j=0; j<N; j++) { graph->out_start[j+1] += graph->out_start[j]; graph->in_start[j+1] += graph->in_start[j]; }
+
+	int* in_fill = (int*)malloc(N*sizeof(int));
+	int* out_fill = (int*)malloc(N*sizeof(int));
+	memcpy(in_fill, graph->in_start, N*sizeof(int));
+	memcpy(out_fill, graph->out_start, N*sizeof(int));
+	for(j=0; j<nE; j++)
 	{
-		psite[root2] += psite[root1];
-		psite[root1] = root2;
-		psite[node1] = root2;
+		node1 = edges[j][0];
+		node2 = edges[j][1];
+		graph->out_adj[out_fill[node1]] = node2;
+		graph->out_type[out_fill[node1]++] = regulator[j];
+		graph->in_adj[in_fill[node2]] = node1;
+		graph->in_type[in_fill[node2]++] = regulator[j];
 	}
+	free(in_fill);
+	free(out_fill);
 }
-//////////////////////////////////////////////////////////////////
 
 /*	Here I not just add the proper edges to the network but I
 	dynamically defines its weakly connected components through
-	a percolation-like process using disjoint sets operations.	*/
-void addEdges(int** edges, int* components, Graph* graph, int* regulator, int nE)
+	a percolation-like process using disjoint sets operations.
+	With 'nthreads' larger than one, the union-find operations are
+	done by lock-free workers while this thread builds the adjacency
+	lists and the CSR arrays.	*/
+void addEdges(int** edges, int* components, Graph* graph, int* regulator, int nE, int nthreads)
 {
-	int i, j;
+	int j;
 	int root1, root2;
 	int num_component = graph->size;
-	for(j=0; j<(graph->size); j++) components[j] = -1;
+	UFTASK* uftasks = NULL;
+	pthread_t* ufthreads = NULL;
+	if(nthreads>1)
+	{
+		ufthreads = (pthread_t*)malloc(nthreads*sizeof(pthread_t));
+		uftasks = START_UNIONFIND(edges, nE, graph->size, nthreads, ufthreads);
+	}
+	else for(j=0; j<(graph->size); j++) components[j] = -1;
 	
-	int index, node1, node2, reg;
+	int node1, node2, reg;
 	for(j=0; j<nE; j++)
 	{
 		// 'node1' -> 'node2' directed link.
@@ -114,9 +167,12 @@ void addEdges(int** edges, int* components, Graph* graph, int* regulator, int nE
 		reg = regulator[j];
 
 		///// UNION-FIND OPERATIONS //////
-		root1 = findroot(node1, components);
-		root2 = findroot(node2, components);
-		if(root1!=root2) { merge(node1, root1, node2, root2, components); num_component--; } 
+		if(nthreads<=1)
+		{
+			root1 = findroot(node1, components);
+			root2 = findroot(node2, components);
+			if(root1!=root2) { merge(root1, root2, components); num_component--; } 
+		}
 		///////////////////////////////////////////////////
 
 		NodeAdj* newnode1 = createNode(node1, reg);
@@ -127,13 +183,40 @@ void addEdges(int** edges, int* components, Graph* graph, int* regulator, int nE
 		graph->array[node1].head_out = newnode2;
 		graph->array[node2].head_in = newnode1;
 	}
+	BUILD_CSR(edges, graph, regulator, nE);
+
+	if(nthreads>1)
+	{
+		num_component = JOIN_UNIONFIND(uftasks, graph->size, nthreads, ufthreads, components);
+		free(ufthreads);
+	}
 	graph->num_component = num_component;
 }
 
-extern int** defineNetwork(int** edges, int* components, Graph* graph, char* filename)
+/*	Conversion between the regulation names of the edgelist files and the edge types. */
+extern int REGULATION_TYPE(char* name)
+{
+	if(strcmp("positive", name)==0) return 0;
+	else if(strcmp("negative", name)==0) return 1;
+	else if(strcmp("dual", name)==0) return 2;
+	return -1;
+}
+
+extern char* REGULATION_NAME(int type)
+{
+	switch(type)
+	{
+		case 0: return "positive";
+		case 1: return "negative";
+		case 2: return "dual";
+	}
+	return "unknown";
+}
+
+extern int** defineNetwork(int** edges, int* components, Graph* graph, char* filename, int nthreads)
 {
 	FILE *EDGE_FILE = fopen(filename, "r");
-	if(EDGE_FILE==NULL) printf("ERROR in file reading");
+	if(EDGE_FILE==NULL) { printf("ERROR in file reading"); return NULL; }
 
 	int i, j;
 	char type[20];
@@ -141,8 +224,8 @@ extern int** defineNetwork(int** edges, int* components, Graph* graph, char* fil
 	int nlink = 0; // number of links.
 	while(r) // Calculates the number of lines in the file
 	{
-		r = fscanf(EDGE_FILE, "%d\t%d\t%s\n", &i, &j, &type);
-		if(r==EOF) break;
+		r = fscanf(EDGE_FILE, "%d\t%d\t%19s\n", &i, &j, type);
+		if(r==EOF || r<2) break;	// the end of the file or a line without two node IDs.
 		nlink++;
 	}
 	rewind(EDGE_FILE);
@@ -152,36 +235,34 @@ extern int** defineNetwork(int** edges, int* components, Graph* graph, char* fil
 	for(j=0; j<nlink; j++)
 	{
 		edges[j] = (int*)malloc(2*sizeof(int));
-		r = fscanf(EDGE_FILE, "%d\t%d\t%s\n", &edges[j][0], &edges[j][1], &type);
-        if(strcmp("positive", type)==0) regulator[j] = 0;
-        else if(strcmp("negative", type)==0) regulator[j] = 1;
-        else if(strcmp("dual", type)==0) regulator[j] = 2;
-        else regulator[j] = -1;
+		r = fscanf(EDGE_FILE, "%d\t%d\t%19s\n", &edges[j][0], &edges[j][1], type);
+        regulator[j] = REGULATION_TYPE(type);
 	}
 	fclose(EDGE_FILE);
 	
     // Defines the network structure and its weakly connected components.
-	addEdges(edges, components, graph, regulator, nlink);
+	addEdges(edges, components, graph, regulator, nlink, nthreads);
+	free(regulator);
     return edges;
 }
 
 extern int GetNodeNumber(char* edgefile)
 {
 	FILE *EDGE_FILE = fopen(edgefile, "r");
-	if(EDGE_FILE==NULL) printf("ERROR in file reading");
+	if(EDGE_FILE==NULL) { printf("ERROR in file reading"); return 0; }
 
 	int max = -1;
 	int i, j;
 	char type[20];
 	int r = 1;
-	int nlink = 0; // number of links.
 	while(r) // Calculates the number of lines in the file
 	{
-		r = fscanf(EDGE_FILE, "%d\t%d\t%s\n", &i, &j, &type);
-		if(r==EOF) break;
-		if(i>max && i>j) max = i;
-		else if(j>max && j>i) max = j;
+		r = fscanf(EDGE_FILE, "%d\t%d\t%19s\n", &i, &j, type);
+		if(r==EOF || r<2) break;	// the end of the file or a line without two node IDs.
+		if(i>max) max = i;
+		if(j>max) max = j;
 	}
+	fclose(EDGE_FILE);
 	return (max+1);
 }
 ///////////////////////////////////////////////////////////////////////////////
@@ -192,6 +273,46 @@ int cmpfunc (const void * a, const void * b) {
    return ( *(int*)a - *(int*)b );
 }
 
+/*	Sorts the 'n' integers of 'a' (node IDs, positions...) by 'compare', which receives two
+	of them and 'context' (the tables they are compared by), so no comparison needs global
+	state. Heapsort, in place and unstable as 'qsort', with insertion sort for short arrays. */
+void SIFT_INDEX(int* a, int root, int n, int (*compare)(int, int, void*), void* context)
+{
+	int child;
+	int x = a[root];
+	while((child = 2*root + 1)<n)
+	{
+		if(child+1<n && compare(a[child], a[child+1], context)<0) child++;
+		if(compare(x, a[child], context)>=0) break;
+		a[root] = a[child];
+		root = child;
+	}
+	a[root] = x;
+}
+
+extern void SORT_INDICES(int* a, int n, int (*compare)(int, int, void*), void* context)
+{
+	int i, j, x;
+	if(n<=16)
+	{
+		for(i=1; i<n; i++)
+		{
+			x = a[i];
+			for(j=i; j>0 && compare(a[j-1], x, context)>0; j--) a[j] = a[j-1];
+			a[j] = x;
+		}
+		return;
+	}
+	for(i=n/2-1; i>=0; i--) SIFT_INDEX(a, i, n, compare, context);
+	for(i=n-1; i>0; i--)
+	{
+		x = a[0];
+		a[0] = a[i];
+		a[i] = x;
+		SIFT_INDEX(a, 0, i, compare, context);
+	}
+}
+
 extern int* GET_INNEIGH(Graph* graph, int node)
 {
 	int n_in = 0;	
@@ -278,6 +399,72 @@ extern int IDENTIFY_SOLITAIRE(Graph* graph, int node)
 	else return 0; // do not receive information not even from itself.
 }
 
+/*	Builds the subgraph formed by the 'n' nodes in 'nodes', where the subgraph node
+	'k' corresponds to the node 'nodes[k]' of 'graph' and 'local' gives the inverse
+	map ('local[v] = -1' if 'v' is not in the subgraph). Only the first 'n_targets'
+	nodes receive their incoming edges, the remaining ones act as pure sources. More
+	than one node of 'graph' may be mapped to the same source, in which case their
+	edges are kept as parallel edges. The CSR arrays of 'graph' must be defined.	*/
+extern Graph* BUILD_SUBGRAPH(Graph* graph, int* nodes, int n, int n_targets, int* local)
+{
+	int j, k, v, u, nE;
+	Graph* sub = createGraph(n, NULL, 0);
+
+	nE = 0;
+	for(k=0; k<n_targets; k++)
+	{
+		v = nodes[k];
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			if(local[graph->in_adj[j]]>=0) nE++;
+	}
+	int** edges = (int**)malloc(nE*sizeof(int*));
+	int* regulator = (int*)malloc(nE*sizeof(int));
+	nE = 0;
+	for(k=0; k<n_targets; k++)
+	{
+		v = nodes[k];
+		for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+		{
+			u = local[graph->in_adj[j]];
+			if(u<0) continue;
+			edges[nE] = (int*)malloc(2*sizeof(int));
+			edges[nE][0] = u;
+			edges[nE][1] = k;
+			regulator[nE++] = graph->in_type[j];
+		}
+	}
+	// The weakly connected components of the subgraph are not needed by the callers.
+	int* components = (int*)malloc(n*sizeof(int));
+	addEdges(edges, components, sub, regulator, nE, 1);
+	free(components);
+	for(j=0; j<nE; j++) free(edges[j]);
+	free(edges);
+	free(regulator);
+	return sub;
+}
+
+/*	Frees the adjacency lists, the CSR arrays and the graph itself. */
+extern void FreeGraph(Graph* graph)
+{
+	int j;
+	NodeAdj* Node;
+	NodeAdj* next;
+	for(j=0; j<graph->size; j++)
+	{
+		for(Node=graph->array[j].head_in; Node!=NULL; Node=next) { next = Node->next; free(Node); }
+		for(Node=graph->array[j].head_out; Node!=NULL; Node=next) { next = Node->next; free(Node); }
+	}
+	free(graph->array);
+	free(graph->in_start);
+	free(graph->in_adj);
+	free(graph->in_type);
+	free(graph->out_start);
+	free(graph->out_adj);
+	free(graph->out_type);
+	if(graph->meta!=NULL) FreeMetadata(graph->meta);
+	free(graph);
+}
+
 ////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////
 
@@ -304,7 +491,7 @@ extern void push(STACK** top, int node)
 // To delete an element in the STACK.
 extern int pop(STACK** top)
 {
-	int v;
+	int v = -1;
 	STACK *ptr;
 	ptr = *top;
 	if((*top)!=NULL)
@@ -581,6 +768,9 @@ extern void push_block(PART** head, BLOCK* insertion)
     new_node->block = insertion;
     new_node->next = (*head);
     new_node->prev = NULL;
+    new_node->number_regulators = 0;
+    new_node->fundamental_number = 0.0;
+    new_node->regulators = NULL;
     if((*head)!=NULL) (*head)->prev = new_node;
     (*head) = new_node;
 }
@@ -599,6 +789,23 @@ extern void DeleteBlockInPartition(PART** part, BLOCK* P)
 	if(current_part!=NULL) DeletePart(part, current_part);
 }
 
+/*	Frees every block of the partition, their node lists and regulators. */
+extern void FreePartition(PART** head)
+{
+	PART* current = *head;
+	PART* next;
+	while(current)
+	{
+		next = current->next;
+		deleteList(&(current->block->head));
+		deleteList(&(current->regulators));
+		free(current->block);
+		free(current);
+		current = next;
+	}
+	*head = NULL;
+}
+
 int GetPartitionSize(PART* part)
 {
 	int i = 0;
@@ -0,0 +1,89 @@
+/*	Vectorized kernels of the stability tests. The kernel 'UNIFORM_RANGE(a, n)' tells
+	whether the n integers of 'a' are all equal, which is the stability test of one block
+	against one splitter when the counts of its nodes are stored contiguously. The
+	out-of-core refinement ('externalf.h') keeps its counts by position, so it tests the
+	ranges in place. The default refinement ('GET_NONSTABLE_BLOCKS1' in 'fibrationf.h')
+	keeps the nodes of a block in a linked list, so it first gathers their counts, one
+	array for each edge type, into short buffers, and tests those. The distributed
+	refinement splits by the signatures of the workers and does not use it.
+
+	Three versions are given: AVX2 (8 integers per compare), SSE2 (4 integers) and a
+	scalar one. The version is chosen once, at run time, by 'SELECT_VECTOR_KERNELS' from
+	the instructions supported by the processor, so the program is compiled for the
+	generic x86-64 target and still uses AVX2 when available. Other architectures use
+	the scalar version.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef VECTORF_H
+#define VECTORF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_X86 1
+#endif
+
+int UNIFORM_SCALAR(const int* a, int n)
+{
+	int i;
+	for(i=1; i<n; i++) if(a[i]!=a[0]) return 0;
+	return 1;
+}
+
+#ifdef VECTOR_X86
+__attribute__((target("sse2"))) int UNIFORM_SSE2(const int* a, int n)
+{
+	int i = 0;
+	if(n<2) return 1;
+	__m128i first = _mm_set1_epi32(a[0]);
+	__m128i differ = _mm_setzero_si128();
+	for(; i+4<=n; i+=4) differ = _mm_or_si128(differ, _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a+i)), first));
+	if(_mm_movemask_epi8(_mm_cmpeq_epi32(differ, _mm_setzero_si128()))!=0xFFFF) return 0;
+	for(; i<n; i++) if(a[i]!=a[0]) return 0;
+	return 1;
+}
+
+__attribute__((target("avx2"))) int UNIFORM_AVX2(const int* a, int n)
+{
+	int i = 0;
+	if(n<2) return 1;
+	__m256i first = _mm256_set1_epi32(a[0]);
+	__m256i differ = _mm256_setzero_si256();
+	for(; i+8<=n; i+=8) differ = _mm256_or_si256(differ, _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a+i)), first));
+	if(!_mm256_testz_si256(differ, differ)) return 0;
+	for(; i<n; i++) if(a[i]!=a[0]) return 0;
+	return 1;
+}
+#endif
+
+int (*UNIFORM_RANGE)(const int* a, int n) = UNIFORM_SCALAR;
+const char* VECTOR_KERNEL_NAME = "scalar";
+
+/*	Selects the widest version supported by the processor. */
+extern void SELECT_VECTOR_KERNELS()
+{
+#ifdef VECTOR_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2")) { UNIFORM_RANGE = UNIFORM_AVX2; VECTOR_KERNEL_NAME = "avx2"; return; }
+	if(__builtin_cpu_supports("sse2")) { UNIFORM_RANGE = UNIFORM_SSE2; VECTOR_KERNEL_NAME = "sse2"; return; }
+#endif
+	UNIFORM_RANGE = UNIFORM_SCALAR;
+	VECTOR_KERNEL_NAME = "scalar";
+}
+
+pthread_once_t VECTOR_KERNELS_SELECTED = PTHREAD_ONCE_INIT;
+
+/*	Same, only the first time, for the refinements that may run in several threads. */
+extern void SELECT_VECTOR_KERNELS_ONCE()
+{
+	pthread_once(&VECTOR_KERNELS_SELECTED, SELECT_VECTOR_KERNELS);
+}
+
+#endif
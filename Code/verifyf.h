@@ -0,0 +1,173 @@
+/*	Verification of a whole partition in one pass, O(N+M). 'STABILITYCHECKER' (in
+	'fibrationf.h') checks the stability with respect to one set, here the partition is
+	checked against all its blocks at once: a partition is input-tree stable when all the
+	nodes of each block receive the same typed multiset of inputs from each block.
+
+	For each block, the inputs of its first node are counted by (source block, type) and
+	the inputs of every other node are counted in the same way and compared with them.
+	The counters are indexed by 3*block + type and are not reset between nodes: each entry
+	carries the node (or block) that wrote it, so the counting costs O(N+M) overall. As
+	in the refinement, the edges of unknown type (-1) are not considered.
+
+	The partition may also be compared with a reference one, e.g. the fibers of another
+	run read from a 'nodefiber.dat' file ("%d\t%d\n" -> Node ID/ Fiber). Since the coarsest
+	stable refinement is unique, a stable partition finer than the reference is not the
+	coarsest, and a stable partition coarser than the reference means the reference is not.
+
+	Author: Higor da S. Monteiro - Universidade Federal do Ceará
+	Email: higor.monteiro@fisica.ufc.br
+	Complex System Lab - Departament of Physics/Universidade Federal do Ceará (UFC)
+*/
+
+#ifndef VERIFYF_H
+#define VERIFYF_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utilsforfiber.h"
+#include "structforfiber.h"
+
+// Relations returned by 'COMPARE_PARTITIONS'.
+#define PARTITION_EQUAL 0
+#define PARTITION_FINER 1
+#define PARTITION_COARSER 2
+#define PARTITION_INCOMPARABLE 3
+
+/*	Block of each node, the blocks of 'partition' followed by the ones of 'null_partition'
+	(the numbering of 'BUILD_QUOTIENT').	*/
+extern int* PARTITION_BLOCKS(PART* partition, PART* null_partition, int N, int* nblocks)
+{
+	int b = 0;
+	PART* current_part;
+	NODELIST* nodelist;
+	int* block = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	for(current_part=partition; current_part!=NULL; current_part=current_part->next, b++)
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) block[nodelist->data] = b;
+	for(current_part=null_partition; current_part!=NULL; current_part=current_part->next, b++)
+		for(nodelist=current_part->block->head; nodelist!=NULL; nodelist=nodelist->next) block[nodelist->data] = b;
+	*nblocks = b;
+	return block;
+}
+
+/*	Checks the input-tree stability of the partition given by 'block'. Returns the number
+	of unstable blocks; for the first one found, 'witness' receives a node whose inputs
+	differ from the ones of the first node of its block (-1 if the partition is stable).	*/
+extern int VERIFY_STABILITY(Graph* graph, int* block, int nblocks, int* witness)
+{
+	int N = graph->size;
+	int b, k, v, j, key, indegree, stable;
+	int unstable = 0;
+	*witness = -1;
+
+	// Nodes grouped by block with a counting sort.
+	int* start = (int*)calloc(nblocks+1, sizeof(int));
+	int* nodes = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	for(v=0; v<N; v++) start[block[v]+1]++;
+	for(b=0; b<nblocks; b++) start[b+1] += start[b];
+	int* fill = (int*)malloc((nblocks>0 ? nblocks : 1)*sizeof(int));
+	memcpy(fill, start, nblocks*sizeof(int));
+	for(v=0; v<N; v++) nodes[fill[block[v]]++] = v;
+	free(fill);
+
+	int* first_count = (int*)malloc((3*nblocks>0 ? 3*nblocks : 1)*sizeof(int));
+	int* first_owner = (int*)malloc((3*nblocks>0 ? 3*nblocks : 1)*sizeof(int));
+	int* count = (int*)malloc((3*nblocks>0 ? 3*nblocks : 1)*sizeof(int));
+	int* owner = (int*)malloc((3*nblocks>0 ? 3*nblocks : 1)*sizeof(int));
+	for(key=0; key<3*nblocks; key++) { first_owner[key] = -1; owner[key] = -1; }
+
+	for(b=0; b<nblocks; b++)
+	{
+		if(start[b+1]-start[b]<2) continue;
+		int first = nodes[start[b]];
+		int first_degree = 0;
+		for(j=graph->in_start[first]; j<graph->in_start[first+1]; j++)
+		{
+			if(graph->in_type[j]<0) continue;
+			key = 3*block[graph->in_adj[j]] + graph->in_type[j];
+			if(first_owner[key]!=b) { first_owner[key] = b; first_count[key] = 0; }
+			first_count[key]++;
+			first_degree++;
+		}
+		stable = 1;
+		for(k=start[b]+1; stable && k<start[b+1]; k++)
+		{
+			v = nodes[k];
+			indegree = 0;
+			for(j=graph->in_start[v]; j<graph->in_start[v+1]; j++)
+			{
+				if(graph->in_type[j]<0) continue;
+				key = 3*block[graph->in_adj[j]] + graph->in_type[j];
+				if(owner[key]!=v) { owner[key] = v; count[key] = 0; }
+				count[key]++;
+				indegree++;
+			}
+			// Same number of inputs and no key counted more times than for 'first'.
+			if(indegree!=first_degree) stable = 0;
+			for(j=graph->in_start[v]; stable && j<graph->in_start[v+1]; j++)
+			{
+				if(graph->in_type[j]<0) continue;
+				key = 3*block[graph->in_adj[j]] + graph->in_type[j];
+				if(first_owner[key]!=b || count[key]!=first_count[key]) stable = 0;
+			}
+			if(stable==0 && unstable==0) *witness = v;
+		}
+		if(stable==0) unstable++;
+	}
+	free(start);
+	free(nodes);
+	free(first_count);
+	free(first_owner);
+	free(count);
+	free(owner);
+	return unstable;
+}
+
+/*	Relation of the partition 'block' to the partition 'reference', both over N nodes. */
+extern int COMPARE_PARTITIONS(int* block, int nblocks, int* reference, int nreference, int N)
+{
+	int v, b;
+	int finer = 1, coarser = 1;
+	// 'image[b]' is the block of the other partition where the nodes of 'b' were found.
+	int* image = (int*)malloc((nblocks>0 ? nblocks : 1)*sizeof(int));
+	int* reference_image = (int*)malloc((nreference>0 ? nreference : 1)*sizeof(int));
+	for(b=0; b<nblocks; b++) image[b] = -1;
+	for(b=0; b<nreference; b++) reference_image[b] = -1;
+	for(v=0; v<N; v++)
+	{
+		if(image[block[v]]==-1) image[block[v]] = reference[v];
+		else if(image[block[v]]!=reference[v]) finer = 0;
+		if(reference_image[reference[v]]==-1) reference_image[reference[v]] = block[v];
+		else if(reference_image[reference[v]]!=block[v]) coarser = 0;
+	}
+	free(image);
+	free(reference_image);
+	if(finer==1 && coarser==1) return PARTITION_EQUAL;
+	if(finer==1) return PARTITION_FINER;
+	if(coarser==1) return PARTITION_COARSER;
+	return PARTITION_INCOMPARABLE;
+}
+
+/*	Reads a 'nodefiber.dat' file for N nodes. Returns NULL if the file can not be read or
+	does not give the fiber of every node.	*/
+extern int* READ_NODE_FIBERS(char* filename, int N, int* nfibers)
+{
+	int v, f, n = 0;
+	FILE* IN = fopen(filename, "r");
+	if(IN==NULL) return NULL;
+	int* fiber = (int*)malloc((N>0 ? N : 1)*sizeof(int));
+	for(v=0; v<N; v++) fiber[v] = -1;
+	*nfibers = 0;
+	while(fscanf(IN, "%d\t%d\n", &v, &f)==2)
+	{
+		if(v<0 || v>=N || f<0 || fiber[v]!=-1) { n = -1; break; }
+		fiber[v] = f;
+		if(f>=*nfibers) *nfibers = f+1;
+		n++;
+	}
+	fclose(IN);
+	if(n!=N) { free(fiber); return NULL; }
+	return fiber;
+}
+
+#endif
@@ -0,0 +1,24 @@
+import sys
+import numpy as np
+sys.path.append('../Code')
+import fiberc
+
+def native_fibers(edges, types=None, num_nodes=0, threads=1, dag=False, reduce=False, classify=True):
+    '''
+        Refines the network with the C engine of 'Code/' (module 'fiberc').
+
+        'edges' is an (M, 2) array of (source, target) node IDs and 'types'
+        an array with the type of each edge (0 positive, 1 negative, 2 dual).
+        Arrays already given as C-contiguous int32 are read in place.
+
+        Returns a dictionary of NumPy arrays viewing the memory filled
+        by the C code (no copies): 'membership', 'fiber_size', 'fiber_n',
+        'fiber_l', 'solitaire' and 'quotient' (rows: source fiber, target
+        fiber, type, multiplicity).
+    '''
+    edges = np.ascontiguousarray(edges, dtype=np.int32)
+    if types is not None:
+        types = np.ascontiguousarray(types, dtype=np.int32)
+    result = fiberc.analyse(edges, types, num_nodes=num_nodes, threads=threads,
+                            dag=dag, reduce=reduce, classify=classify)
+    return {key: np.asarray(value) for key, value in result.items()}